@@ -0,0 +1,140 @@
+# Harness of the benchmark suite run by bench/run.rb.
+#
+# Each file in bench/suite registers a suite with Bench.suite.  A suite
+# measures one or more results, each of which is a number with a unit and
+# a direction, so that a later run can be compared with a saved baseline.
+#
+#     Bench.suite 'ndarray' do |s|
+#       a = MXNet::NDArray.ones([10])
+#       s.rate('add', unit: 'ops/s') { a + 1 }
+#     end
+
+require 'json'
+require 'rbconfig'
+require 'time'
+
+module Bench
+  Result = Struct.new(:name, :value, :unit, :higher_is_better)
+
+  @suites = {}
+
+  class << self
+    attr_reader :suites
+
+    # Registers a suite named +name+.  The block is called with a Suite
+    # when the suite is run.
+    def suite(name, &block)
+      @suites[name] = block
+    end
+
+    def clock
+      Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+  end
+
+  class Suite
+    def initialize(name, min_time:)
+      @name = name
+      @min_time = min_time
+      @results = []
+    end
+
+    attr_reader :name, :results
+
+    # Calls the block repeatedly for at least the minimum time and records
+    # the number of calls per second, multiplied by +per_call+.  The value
+    # of the last call is passed to +sync+, if any, so that the time
+    # includes the asynchronous work.
+    #
+    # @param label [String] The name of the result in the suite.
+    # @param unit [String] The unit of the result.
+    # @param per_call [Numeric] The amount of work done by one call.
+    # @param sync [Proc] Waits for the work of the block.
+    def rate(label, unit: 'ops/s', per_call: 1, warmup: 3, sync: nil)
+      warmup.times { sync ? sync.(yield) : yield }
+      calls = 0
+      last = nil
+      start = Bench.clock
+      batch = 1
+      loop do
+        batch.times { last = yield }
+        calls += batch
+        elapsed = Bench.clock - start
+        break if elapsed >= @min_time
+        batch *= 2 if elapsed < @min_time / 10
+      end
+      sync&.(last)
+      record(label, calls * per_call / (Bench.clock - start), unit: unit)
+    end
+
+    # Calls the block repeatedly for at least the minimum time and records
+    # the median of the durations of the calls in microseconds.
+    def latency(label, warmup: 3)
+      warmup.times { yield }
+      samples = []
+      start = Bench.clock
+      while samples.length < 5 || Bench.clock - start < @min_time
+        t = Bench.clock
+        yield
+        samples << Bench.clock - t
+      end
+      samples.sort!
+      record(label, samples[samples.length / 2] * 1e6, unit: 'us', higher_is_better: false)
+    end
+
+    # Records a value measured by the suite itself.
+    def record(label, value, unit:, higher_is_better: true)
+      result = Result.new("#{@name}/#{label}", value.to_f, unit, higher_is_better)
+      @results << result
+      printf("%-48s %14.3f %s\n", result.name, result.value, unit)
+      result
+    end
+  end
+
+  module_function
+
+  # Runs the registered suites whose names match +filter+ and returns the
+  # results.
+  def run(filter: nil, min_time: 1.0)
+    @suites.flat_map do |name, block|
+      next [] if filter && name !~ filter
+      suite = Suite.new(name, min_time: min_time)
+      block.(suite)
+      suite.results
+    end
+  end
+
+  # Returns the results as a Hash to be written in JSON.
+  def to_report(results)
+    {
+      'meta' => {
+        'time' => Time.now.utc.iso8601,
+        'ruby' => RUBY_DESCRIPTION,
+        'mxnet' => MXNet::VERSION,
+        'host' => RbConfig::CONFIG['host'],
+      },
+      'results' => results.map {|r|
+        [r.name, {'value' => r.value, 'unit' => r.unit, 'higher_is_better' => r.higher_is_better}]
+      }.to_h,
+    }
+  end
+
+  # Compares a report with a baseline report and returns the results
+  # which are worse than the baseline by more than +threshold+, as an
+  # Array of [name, baseline value, value, relative change].
+  def compare(report, baseline, threshold:)
+    lines = []
+    regressions = []
+    report['results'].each do |name, r|
+      base = baseline['results'][name]
+      next unless base && base['value'] > 0
+      change = r['value'] / base['value'] - 1
+      worse = r['higher_is_better'] ? -change : change
+      mark = worse > threshold ? 'REGRESSION' : ''
+      lines << format('%-48s %14.3f %14.3f %+8.1f%% %s', name, base['value'], r['value'], change * 100, mark)
+      regressions << [name, base['value'], r['value'], change] if worse > threshold
+    end
+    puts format('%-48s %14s %14s %9s', 'benchmark', 'baseline', 'current', 'change'), lines
+    regressions
+  end
+end
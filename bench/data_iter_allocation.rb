@@ -0,0 +1,51 @@
+# Measures object allocations and GC runs per epoch of MNISTIter, with and
+# without reuse_batch: true, and the cost of wrapping operator outputs.
+#
+#     $ ruby -Ilib -Iext bench/data_iter_allocation.rb [MNIST_DIR]
+#
+# MNIST_DIR must contain train-images-idx3-ubyte and train-labels-idx1-ubyte
+# (default: spec/fixture/mnist).
+
+require 'mxnet'
+require 'benchmark'
+
+mnist_dir = ARGV[0] || File.expand_path('../../spec/fixture/mnist', __FILE__)
+
+def measure(label)
+  GC.start
+  allocated = GC.stat(:total_allocated_objects)
+  gc_count = GC.count
+  time = Benchmark.realtime { yield }
+  printf("%-32s %8.3f s %10d objects %4d GC runs\n", label, time,
+         GC.stat(:total_allocated_objects) - allocated, GC.count - gc_count)
+end
+
+def mnist_iter(dir, **kwargs)
+  MXNet::IO::MNISTIter.new(
+    image: File.join(dir, 'train-images-idx3-ubyte'),
+    label: File.join(dir, 'train-labels-idx1-ubyte'),
+    data_shape: [784],
+    batch_size: 100,
+    flat: 1,
+    silent: 1,
+    **kwargs
+  )
+end
+
+a = MXNet::NDArray.ones([10])
+measure('100k ops (output wrapping)') do
+  100_000.times { a + 1 }
+end
+
+[
+  ['MNISTIter', {}],
+  ['MNISTIter reuse_batch', { reuse_batch: true }],
+  ['MNISTIter prefetch: 2', { prefetch: 2 }],
+  ['MNISTIter prefetch + reuse_batch', { prefetch: 2, reuse_batch: true }],
+].each do |label, kwargs|
+  iter = mnist_iter(mnist_dir, **kwargs)
+  iter.each {}
+  measure(label) do
+    iter.each {|batch| batch.data[0] }
+  end
+end
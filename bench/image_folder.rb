@@ -0,0 +1,47 @@
+# Measures images/sec of ImageFolderDataset through DataLoader on a
+# synthetic folder of PNG images, with per-sample transforms and with the
+# native batch path.
+#
+#     $ ruby -Ilib -Iext bench/image_folder.rb [NUM_IMAGES]
+#
+# The images are written to a temporary directory and removed afterwards.
+
+require 'mxnet'
+require 'mxnet/gluon'
+require 'benchmark'
+require 'tmpdir'
+require_relative '../spec/support/png_writer'
+
+num_images = Integer(ARGV[0] || 512)
+batch_size = 64
+
+Dir.mktmpdir do |root|
+  num_images.times do |i|
+    dir = File.join(root, "class#{i % 4}")
+    Dir.mkdir(dir) unless File.directory?(dir)
+    PNGWriter.write(File.join(dir, format('%05d.png', i)), 320 + i % 64, 240 + i % 48) do |x, y|
+      [(x * i) & 255, (y * 3 + i) & 255, (x ^ y) & 255]
+    end
+  end
+
+  transforms = MXNet::Gluon::Data::Vision::Transforms
+  pipeline = transforms::Compose.new(
+    transforms::RandomResizedCrop.new(224),
+    transforms::ToTensor.new,
+    transforms::Normalize.new([0.485, 0.456, 0.406], [0.229, 0.224, 0.225])
+  )
+  per_sample = ->(img, label) { [pipeline.(img), label] }
+
+  [
+    ['per-sample transform', per_sample],
+    ['native batch', pipeline],
+  ].each do |label, transform|
+    dataset = MXNet::Gluon::Data::Vision::ImageFolderDataset.new(root, transform: transform)
+    loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: batch_size, shuffle: true)
+    loader.first[0].wait_to_read
+    time = Benchmark.realtime do
+      loader.each {|data, _| data.wait_to_read }
+    end
+    printf("%-32s %8.1f images/sec\n", label, num_images / time)
+  end
+end
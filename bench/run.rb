@@ -0,0 +1,49 @@
+# Runs the benchmark suites in bench/suite on CPU and writes the results
+# in JSON.  With --compare, the results are compared with a saved
+# baseline and the process exits with 1 if any of them regressed by more
+# than the threshold.
+#
+#     $ ruby -Ilib -Iext bench/run.rb --output bench/results/baseline.json
+#     $ ruby -Ilib -Iext bench/run.rb --compare bench/results/baseline.json
+#
+# rake bench runs this script with the options taken from BENCH_OUTPUT,
+# BENCH_BASELINE, BENCH_THRESHOLD, BENCH_FILTER and BENCH_TIME.
+
+require 'optparse'
+
+options = {threshold: 0.1, min_time: 1.0}
+OptionParser.new do |opt|
+  opt.banner = "Usage: #{opt.program_name} [options]"
+  opt.on('-o', '--output FILE', 'Write the results to FILE') {|v| options[:output] = v }
+  opt.on('-c', '--compare FILE', 'Compare the results with the baseline in FILE') {|v| options[:baseline] = v }
+  opt.on('-t', '--threshold RATIO', Float, 'Relative change regarded as a regression (default: 0.1)') {|v| options[:threshold] = v }
+  opt.on('-f', '--filter REGEXP', 'Run only the suites whose names match REGEXP') {|v| options[:filter] = Regexp.new(v) }
+  opt.on('--time SEC', Float, 'Minimum time of each measurement (default: 1.0)') {|v| options[:min_time] = v }
+end.parse!(ARGV)
+
+# Keep libmxnet from initializing GPUs; every benchmark runs on CPU.
+ENV['CUDA_VISIBLE_DEVICES'] = ''
+
+require 'mxnet'
+require_relative 'bench_helper'
+
+Dir[File.expand_path('suite/*.rb', __dir__)].sort.each {|f| require f }
+
+MXNet::Context.with(MXNet.cpu) do
+  results = Bench.run(filter: options[:filter], min_time: options[:min_time])
+  report = Bench.to_report(results)
+
+  if options[:output]
+    File.write(options[:output], JSON.pretty_generate(report) + "\n")
+    puts "Wrote #{options[:output]}"
+  end
+
+  if options[:baseline]
+    baseline = JSON.parse(File.read(options[:baseline]))
+    regressions = Bench.compare(report, baseline, threshold: options[:threshold])
+    unless regressions.empty?
+      warn "#{regressions.length} benchmark(s) regressed by more than #{(options[:threshold] * 100).round(1)}%"
+      exit 1
+    end
+  end
+end
@@ -0,0 +1,27 @@
+# Imperative code dominated by small operations, with and without
+# Engine.bulk and NDArray.batch: a chain of elementwise operations, and a hand-written SGD
+# update of many small parameters.
+
+Bench.suite 'bulk' do |s|
+  x = MXNet::NDArray.ones([16])
+  params = Array.new(50) { MXNet::NDArray.ones([16, 16]) }
+  grads = Array.new(50) { MXNet::NDArray.ones([16, 16]) * 0.01 }
+  sync = ->(y) { y.wait_to_read }
+
+  chain = lambda do
+    y = x
+    20.times { y = y * 1.01 + 0.1 }
+    y
+  end
+  sgd = lambda do
+    params.zip(grads) {|p, g| p[0..-1] = p - 0.1 * g }
+    params.last
+  end
+
+  [0, MXNet::Engine::DEFAULT_BULK_SIZE].each do |size|
+    s.rate("elementwise chain bulk=#{size}", unit: 'chains/s', sync: sync) { MXNet::Engine.bulk(size, &chain) }
+    s.rate("sgd update bulk=#{size}", unit: 'steps/s', sync: sync) { MXNet::Engine.bulk(size, &sgd) }
+  end
+  s.rate('elementwise chain batch', unit: 'chains/s', sync: sync) { MXNet::NDArray.batch(&chain) }
+  s.rate('sgd update batch', unit: 'steps/s', sync: sync) { MXNet::NDArray.batch(&sgd) }
+end
@@ -0,0 +1,19 @@
+# Latency of CachedOp#call on a small MLP graph, where the per-call cost
+# of the binding matters as much as the computation.
+
+Bench.suite 'cached_op' do |s|
+  data = MXNet::Symbol.var(:data)
+  fc1 = MXNet::Symbol.FullyConnected(data: data, num_hidden: 64, name: 'fc1')
+  act = MXNet::Symbol.Activation(data: fc1, act_type: 'relu', name: 'relu1')
+  fc2 = MXNet::Symbol.FullyConnected(data: act, num_hidden: 10, name: 'fc2')
+  op = MXNet::CachedOp.new(fc2)
+
+  args = {
+    data: [32, 100],
+    fc1_weight: [64, 100], fc1_bias: [64],
+    fc2_weight: [10, 64], fc2_bias: [10],
+  }
+  inputs = fc2.list_arguments.map {|name| MXNet::NDArray.ones(args.fetch(name)) }
+
+  s.latency('mlp call') { op.call(*inputs).wait_to_read }
+end
@@ -0,0 +1,23 @@
+# Bandwidth of copying between Numo::NArray and NDArray for each dtype
+# which Numo::NArray supports.
+
+require 'mxnet/narray_helper'
+
+Bench.suite 'copy' do |s|
+  shape = [1024, 1024]
+  {
+    float32: Numo::SFloat,
+    float64: Numo::DFloat,
+    uint8: Numo::UInt8,
+    int8: Numo::Int8,
+    int32: Numo::Int32,
+    int64: Numo::Int64,
+  }.each do |dtype, klass|
+    host = klass.new(*shape).seq
+    nd = MXNet::NDArray.empty(shape, dtype: dtype)
+    mb = host.byte_size / 1e6
+
+    s.rate("host to ndarray #{dtype}", unit: 'MB/s', per_call: mb) { MXNet::NArrayHelper.sync_copyfrom(nd, host) }
+    s.rate("ndarray to host #{dtype}", unit: 'MB/s', per_call: mb) { nd.to_narray }
+  end
+end
@@ -0,0 +1,24 @@
+# Samples per second of DataLoader over an in-memory dataset, collating
+# samples one by one and reading whole batches through a MmapDataset.
+# bench/image_folder.rb measures the image decoding pipeline separately.
+
+require 'mxnet/gluon'
+require 'tmpdir'
+
+Bench.suite 'data_loader' do |s|
+  samples = Array.new(1024) {|i| [MXNet::NDArray.ones([3, 32, 32]) * i, i % 10] }
+  dataset = MXNet::Gluon::Data::SimpleDataset.new(samples)
+
+  loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 64, shuffle: true)
+  s.rate('ndarray samples', unit: 'samples/s', per_call: samples.length, warmup: 1) do
+    loader.each {|data, _| data.wait_to_read }
+  end
+
+  Dir.mktmpdir do |dir|
+    path = MXNet::Gluon::Data::MmapDataset.write(File.join(dir, 'bench.raw'), dataset)
+    mmap_loader = MXNet::Gluon::Data::DataLoader.new(MXNet::Gluon::Data::MmapDataset.new(path), batch_size: 64, shuffle: true)
+    s.rate('mmap batches', unit: 'samples/s', per_call: samples.length, warmup: 1) do
+      mmap_loader.each {|data, _| data.wait_to_read }
+    end
+  end
+end
@@ -0,0 +1,26 @@
+# Executor#forward and #backward of a convolutional network bound once.
+
+Bench.suite 'executor' do |s|
+  data = MXNet::Symbol.var(:data)
+  conv = MXNet::Symbol.Convolution(data: data, kernel: [3, 3], num_filter: 16, pad: [1, 1], name: 'conv')
+  act = MXNet::Symbol.Activation(data: conv, act_type: 'relu', name: 'relu')
+  pool = MXNet::Symbol.Pooling(data: act, kernel: [2, 2], stride: [2, 2], pool_type: 'max', name: 'pool')
+  fc = MXNet::Symbol.FullyConnected(data: pool, num_hidden: 10, name: 'fc')
+  net = MXNet::Symbol.sum(data: fc, name: 'loss')
+
+  arg_shapes, = net.infer_shape(data: [16, 3, 32, 32])
+  names = net.list_arguments
+  args = names.zip(arg_shapes).map {|name, shape| [name, MXNet::NDArray.ones(shape) * 0.01] }.to_h
+  grads = names.zip(arg_shapes).map {|name, shape| [name, MXNet::NDArray.zeros(shape)] }.to_h
+  exe = net.bind(MXNet.cpu, args, args_grad: grads, grad_req: 'write')
+
+  s.latency('forward') do
+    exe.forward(is_train: false)
+    exe.outputs[0].wait_to_read
+  end
+  s.latency('forward backward') do
+    exe.forward(is_train: true)
+    exe.backward
+    grads[:data].wait_to_read
+  end
+end
@@ -0,0 +1,12 @@
+# Overhead of dispatching an operator through imperative_invoke, measured
+# on arrays small enough for the dispatch to dominate.
+
+Bench.suite 'imperative' do |s|
+  a = MXNet::NDArray.ones([10])
+  b = MXNet::NDArray.ones([10])
+  sync = ->(x) { x.wait_to_read }
+
+  s.rate('scalar op', sync: sync) { a + 1 }
+  s.rate('binary op', sync: sync) { a + b }
+  s.rate('op with attributes', sync: sync) { MXNet::NDArray.sum(a, axis: 0, keepdims: true) }
+end
@@ -0,0 +1,16 @@
+# Time to require the library in a new process.
+
+require 'open3'
+
+Bench.suite 'require' do |s|
+  lib_dirs = $LOAD_PATH.select {|dir| File.exist?(File.join(dir, 'mxnet.rb')) || File.exist?(File.join(dir, 'mxnet', 'version.rb')) }
+  ext_dirs = $LOAD_PATH.select {|dir| Dir.exist?(dir) && !Dir[File.join(dir, "mxnet.#{RbConfig::CONFIG['DLEXT']}")].empty? }
+  command = [RbConfig.ruby, *(lib_dirs | ext_dirs).map {|dir| "-I#{dir}" }]
+
+  %w[mxnet mxnet/gluon].each do |feature|
+    s.latency("require #{feature}", warmup: 1) do
+      _, status = Open3.capture2e(*command, '-e', "require '#{feature}'")
+      raise "failed to require #{feature}" unless status.success?
+    end
+  end
+end
@@ -0,0 +1,30 @@
+# Training steps per second of a Gluon MLP with Gluon::Trainer.
+
+require 'mxnet/gluon'
+
+Bench.suite 'trainer' do |s|
+  net = MXNet::Gluon::NN::Sequential.new
+  net.with_name_scope do
+    net << MXNet::Gluon::NN::Dense.new(128, activation: :relu, in_units: 784)
+    net << MXNet::Gluon::NN::Dense.new(64, activation: :relu, in_units: 128)
+    net << MXNet::Gluon::NN::Dense.new(10, in_units: 64)
+  end
+  net.init(init: MXNet::Init::Xavier.new)
+  loss_fn = MXNet::Gluon::Loss::SoftmaxCrossEntropyLoss.new
+  trainer = MXNet::Gluon::Trainer.new(net.collect_params, :sgd, optimizer_params: {learning_rate: 0.01})
+
+  batch_size = 64
+  data = MXNet::NDArray.random_uniform(shape: [batch_size, 784])
+  label = MXNet::NDArray.array((0...batch_size).map {|i| i % 10 })
+
+  step = lambda do
+    loss = MXNet::Autograd.record do
+      loss_fn.(net.(data), label)
+    end
+    loss.backward
+    trainer.step(batch_size)
+    loss
+  end
+
+  s.rate('mlp step', unit: 'steps/s', sync: ->(loss) { loss.wait_to_read }, &step)
+end
@@ -0,0 +1,71 @@
+# Measures images/sec of a convolutional network on CPU for each
+# combination of the numbers of OpenMP threads and engine worker threads.
+# Each combination runs in a child process, because the engine reads its
+# configuration when libmxnet is loaded.
+#
+#     $ ruby -Ilib -Iext bench/thread_sweep.rb [OMP_THREADS] [WORKER_THREADS] [--json FILE]
+#
+# OMP_THREADS and WORKER_THREADS are comma-separated lists (default:
+# 1,2,4,... up to the number of processors, and 1,2).
+
+require 'etc'
+require 'json'
+require 'open3'
+require 'rbconfig'
+
+if ENV['THREAD_SWEEP_CHILD']
+  require 'mxnet/engine'
+  MXNet::Engine.configure(omp_threads: Integer(ENV['THREAD_SWEEP_OMP']),
+                          cpu_worker_threads: Integer(ENV['THREAD_SWEEP_WORKERS']),
+                          affinity: :close)
+  require 'mxnet'
+
+  batch_size = 32
+  data = MXNet::Symbol.var(:data)
+  net = data
+  [32, 64, 128].each_with_index do |num_filter, i|
+    net = MXNet::Symbol.Convolution(data: net, kernel: [3, 3], pad: [1, 1], num_filter: num_filter, name: "conv#{i}")
+    net = MXNet::Symbol.Activation(data: net, act_type: 'relu', name: "relu#{i}")
+    net = MXNet::Symbol.Pooling(data: net, kernel: [2, 2], stride: [2, 2], pool_type: 'max', name: "pool#{i}")
+  end
+  net = MXNet::Symbol.FullyConnected(data: net, num_hidden: 10, name: 'fc')
+
+  arg_shapes, = net.infer_shape(data: [batch_size, 3, 64, 64])
+  args = net.list_arguments.zip(arg_shapes).map {|name, shape| [name, MXNet::NDArray.ones(shape) * 0.01] }.to_h
+  exe = net.bind(MXNet.cpu, args)
+
+  run = ->(n) { n.times { exe.forward(is_train: false) }; exe.outputs[0].wait_to_read }
+  run.(3)
+  iterations = 0
+  start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  while (elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start) < 2.0
+    run.(5)
+    iterations += 5
+  end
+  puts JSON.generate(images_per_sec: iterations * batch_size / elapsed)
+  exit
+end
+
+json_path = ARGV.delete('--json') && ARGV.shift
+max_threads = Etc.nprocessors
+omp_counts = (ARGV[0] || (0..Math.log2(max_threads)).map {|i| 2**i }.join(',')).split(',').map {|s| Integer(s) }
+worker_counts = (ARGV[1] || '1,2').split(',').map {|s| Integer(s) }
+
+command = [RbConfig.ruby, *$LOAD_PATH.select {|dir| dir.start_with?(File.expand_path('..', __dir__)) }.map {|dir| "-I#{dir}" }, __FILE__]
+results = []
+printf("%12s %16s %14s\n", 'omp threads', 'worker threads', 'images/sec')
+worker_counts.each do |workers|
+  omp_counts.each do |omp|
+    env = {'THREAD_SWEEP_CHILD' => '1', 'THREAD_SWEEP_OMP' => omp.to_s,
+           'THREAD_SWEEP_WORKERS' => workers.to_s, 'CUDA_VISIBLE_DEVICES' => ''}
+    out, status = Open3.capture2(env, *command)
+    abort "the benchmark failed with omp=#{omp} workers=#{workers}" unless status.success?
+    rate = JSON.parse(out.lines.last)['images_per_sec']
+    results << {omp_threads: omp, worker_threads: workers, images_per_sec: rate}
+    printf("%12d %16d %14.1f\n", omp, workers, rate)
+  end
+end
+
+best = results.max_by {|r| r[:images_per_sec] }
+puts "best: omp_threads=#{best[:omp_threads]} worker_threads=#{best[:worker_threads]}"
+File.write(json_path, JSON.pretty_generate(results) + "\n") if json_path
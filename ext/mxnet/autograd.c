@@ -185,6 +185,7 @@ autograd_s_backward(int argc, VALUE *argv, VALUE mod)
     }
   }
 
+  mxnet_ndarray_batch_flush();
   CHECK_CALL(
     MXNET_API(MXAutogradBackwardEx)(
       heads_len,
@@ -129,10 +129,14 @@ cached_op_call(int argc, VALUE *argv, VALUE obj)
   CachedOpHandle handle;
   VALUE args, kwargs, out, orig_out, output_vars_str, input_vars_str, result;
   NDArrayHandle *output_vars, *input_vars;
-  int i, num_output, num_input, *out_stypes;
+  int i, num_output, num_input, *out_stypes, status;
 
   rb_scan_args(argc, argv, "0*:", &args, &kwargs);
 
+  /* The graph runs now, so the operations recorded by NDArray.batch,
+   * which may compute its inputs, have to run first. */
+  mxnet_ndarray_batch_flush();
+
   out = Qundef;
   if (!NIL_P(kwargs)) {
     static ID kwarg_keys[1];
@@ -181,13 +185,29 @@ cached_op_call(int argc, VALUE *argv, VALUE obj)
   }
 
   handle = mxnet_cached_op_get_handle(obj);
-  CHECK_CALL(MXNET_API(MXInvokeCachedOpEx)(
+  if (mxnet_op_stats_enabled) {
+    uint64_t start_ns = mxnet_op_stats_clock();
+    status = MXNET_API(MXInvokeCachedOpEx)(
+        handle,
+        num_input,
+        input_vars,
+        &num_output,
+        &output_vars,
+        &out_stypes);
+    if (status == 0) {
+      mxnet_op_stats_record(NULL, start_ns, input_vars, num_input);
+    }
+  }
+  else {
+    status = MXNET_API(MXInvokeCachedOpEx)(
         handle,
         num_input,
         input_vars,
         &num_output,
         &output_vars,
-        &out_stypes));
+        &out_stypes);
+  }
+  CHECK_CALL(status);
 
   if (!NIL_P(orig_out)) {
     return orig_out;
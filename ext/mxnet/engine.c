@@ -0,0 +1,71 @@
+#include "mxnet_internal.h"
+
+#define CHECK_ENGINE_API(name) do { \
+    if (MXNET_API(name) == NULL) { \
+      rb_raise(rb_eNotImpError, #name " is unavailable in the loaded libmxnet"); \
+    } \
+  } while (0)
+
+/* Sets the number of OpenMP threads of the calling thread. */
+static VALUE
+engine_s_set_num_omp_threads(VALUE mod, VALUE num_threads)
+{
+  CHECK_ENGINE_API(MXSetNumOMPThreads);
+  CHECK_CALL(MXNET_API(MXSetNumOMPThreads)(NUM2INT(num_threads)));
+  return num_threads;
+}
+
+/* Returns true if the loaded libmxnet can execute imperative operations
+ * in bulk.
+ */
+static VALUE
+engine_s_bulk_available_p(VALUE mod)
+{
+  return MXNET_API(MXEngineSetBulkSize) != NULL ? Qtrue : Qfalse;
+}
+
+/* Sets the maximum number of imperative operations executed in a bulk
+ * segment by the calling thread, and returns the previous one.
+ */
+static VALUE
+engine_s_set_bulk_size(VALUE mod, VALUE size)
+{
+  int prev_size;
+
+  CHECK_ENGINE_API(MXEngineSetBulkSize);
+  CHECK_CALL(MXNET_API(MXEngineSetBulkSize)(NUM2INT(size), &prev_size));
+  return INT2NUM(prev_size);
+}
+
+/* Returns the features the loaded libmxnet was built with, as an Array
+ * of [name, enabled].
+ */
+static VALUE
+engine_s_lib_features(VALUE mod)
+{
+  const struct LibFeature *features;
+  size_t i, size;
+  VALUE result;
+
+  CHECK_ENGINE_API(MXLibInfoFeatures);
+  CHECK_CALL(MXNET_API(MXLibInfoFeatures)(&features, &size));
+
+  result = rb_ary_new_capa((long)size);
+  for (i = 0; i < size; ++i) {
+    rb_ary_push(result, rb_assoc_new(rb_usascii_str_new_cstr(features[i].name),
+                                     features[i].enabled ? Qtrue : Qfalse));
+  }
+  return result;
+}
+
+void
+mxnet_init_engine(void)
+{
+  VALUE mEngine;
+
+  mEngine = rb_const_get_at(mxnet_mMXNet, rb_intern("Engine"));
+  rb_define_singleton_method(mEngine, "_set_num_omp_threads", engine_s_set_num_omp_threads, 1);
+  rb_define_singleton_method(mEngine, "bulk_available?", engine_s_bulk_available_p, 0);
+  rb_define_singleton_method(mEngine, "_set_bulk_size", engine_s_set_bulk_size, 1);
+  rb_define_singleton_method(mEngine, "_lib_features", engine_s_lib_features, 0);
+}
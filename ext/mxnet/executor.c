@@ -1,6 +1,14 @@
 #include "mxnet_internal.h"
 
+#include <ruby/util.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
 VALUE mxnet_cExecutor;
+static VALUE cExecutorMonitor;
 
 VALUE
 mxnet_executor_new(ExecutorHandle handle, VALUE symbol, VALUE ctx, VALUE grad_req, VALUE group2ctx)
@@ -63,6 +71,328 @@ executor_outputs(VALUE obj)
   return res;
 }
 
+/* Monitor of intermediate outputs.
+ *
+ * libmxnet calls executor_monitor_callback for the output of every node
+ * while running the executor.  On sampled steps, the callback computes
+ * the statistic of the outputs of the selected nodes by operators, which
+ * run on the device asynchronously, and appends the resulting NDArrays to
+ * a buffer drained by Executor#monitor_results.  On the other steps, the
+ * callback only releases the output.
+ */
+
+enum monitor_stat {
+  MONITOR_STAT_NORM,
+  MONITOR_STAT_MAX_ABS,
+  MONITOR_STAT_MEAN_ABS
+};
+
+#define MONITOR_MAX_STAT_OPS 2
+
+struct monitor_record {
+  char *name;
+  uint64_t step;
+  uint64_t size;
+  NDArrayHandle stat;
+};
+
+typedef struct {
+  char **names;
+  long num_names;
+  unsigned long interval;
+  uint64_t step;
+  uint64_t next_step;
+  int active;
+  void *stat_ops[MONITOR_MAX_STAT_OPS];
+  int num_stat_ops;
+  struct monitor_record *records;
+  size_t num_records;
+  size_t capa_records;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_t lock;
+#endif
+} mx_monitor;
+
+static void
+monitor_free_records(struct monitor_record *records, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; ++i) {
+    free(records[i].name);
+    MXNET_API(MXNDArrayFree)(records[i].stat);
+  }
+}
+
+static void
+monitor_free(void *ptr)
+{
+  mx_monitor *mon = (mx_monitor *)ptr;
+  long i;
+
+  for (i = 0; i < mon->num_names; ++i) {
+    xfree(mon->names[i]);
+  }
+  xfree(mon->names);
+  monitor_free_records(mon->records, mon->num_records);
+  free(mon->records);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_destroy(&mon->lock);
+#endif
+  xfree(mon);
+}
+
+static size_t
+monitor_memsize(void const *ptr)
+{
+  mx_monitor const *mon = (mx_monitor const *)ptr;
+  return sizeof(mx_monitor) + sizeof(char *) * mon->num_names +
+    sizeof(struct monitor_record) * mon->capa_records;
+}
+
+static const rb_data_type_t monitor_data_type = {
+  "MXNet::Executor::Monitor",
+  {
+    NULL,
+    monitor_free,
+    monitor_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static mx_monitor *
+get_monitor(VALUE obj)
+{
+  mx_monitor *mon;
+  TypedData_Get_Struct(obj, mx_monitor, &monitor_data_type, mon);
+  return mon;
+}
+
+static int
+monitor_name_cmp(void const *a, void const *b)
+{
+  return strcmp(*(char const *const *)a, *(char const *const *)b);
+}
+
+/* Computes the statistic of +arr+ by the operators of the monitor.
+ * Returns NULL if an operator fails.
+ */
+static NDArrayHandle
+monitor_compute_stat(mx_monitor *mon, NDArrayHandle arr)
+{
+  NDArrayHandle cur = arr;
+  int i;
+
+  for (i = 0; i < mon->num_stat_ops; ++i) {
+    NDArrayHandle *outputs = NULL;
+    int num_outputs = 0;
+    int status;
+
+    status = MXNET_API(MXImperativeInvoke)(mon->stat_ops[i], 1, &cur,
+                                           &num_outputs, &outputs, 0, NULL, NULL);
+    if (cur != arr) {
+      MXNET_API(MXNDArrayFree)(cur);
+    }
+    if (status != 0 || num_outputs < 1) {
+      return NULL;
+    }
+    cur = outputs[0];
+  }
+  return cur;
+}
+
+static uint64_t
+monitor_array_size(NDArrayHandle arr)
+{
+  mx_uint ndim, i;
+  const mx_uint *shape;
+  uint64_t size = 1;
+
+  if (MXNET_API(MXNDArrayGetShape)(arr, &ndim, &shape) != 0) {
+    return 0;
+  }
+  for (i = 0; i < ndim; ++i) {
+    size *= shape[i];
+  }
+  return size;
+}
+
+static void
+executor_monitor_callback(const char *name, NDArrayHandle arr, void *callback_handle)
+{
+  mx_monitor *mon = (mx_monitor *)callback_handle;
+  struct monitor_record rec;
+
+  if (!mon->active ||
+      bsearch(&name, mon->names, mon->num_names, sizeof(char *), monitor_name_cmp) == NULL) {
+    MXNET_API(MXNDArrayFree)(arr);
+    return;
+  }
+
+  rec.stat = monitor_compute_stat(mon, arr);
+  rec.size = monitor_array_size(arr);
+  MXNET_API(MXNDArrayFree)(arr);
+  if (rec.stat == NULL) {
+    return;
+  }
+  rec.name = strdup(name);
+  rec.step = mon->step;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&mon->lock);
+#endif
+  if (mon->num_records == mon->capa_records) {
+    size_t capa = mon->capa_records == 0 ? 16 : 2 * mon->capa_records;
+    struct monitor_record *records = realloc(mon->records, sizeof(struct monitor_record) * capa);
+    if (records != NULL) {
+      mon->records = records;
+      mon->capa_records = capa;
+    }
+  }
+  if (rec.name != NULL && mon->num_records < mon->capa_records) {
+    mon->records[mon->num_records++] = rec;
+    rec.stat = NULL;
+  }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock(&mon->lock);
+#endif
+
+  if (rec.stat != NULL) {
+    free(rec.name);
+    MXNET_API(MXNDArrayFree)(rec.stat);
+  }
+}
+
+/* Advances the step of the monitor of +obj+, if any, before a forward pass. */
+static void
+executor_monitor_tick(VALUE obj)
+{
+  VALUE monitor;
+  mx_monitor *mon;
+
+  monitor = rb_attr_get(obj, rb_intern("@monitor_callback"));
+  if (NIL_P(monitor)) {
+    return;
+  }
+  mon = get_monitor(monitor);
+  mon->step = mon->next_step++;
+  mon->active = (mon->step % mon->interval == 0);
+}
+
+/* Installs a monitor of the outputs of the nodes listed in +names+.
+ *
+ * @param names [Array<String>] The names of the outputs to monitor.
+ * @param interval [Integer] Samples every +interval+ forward passes.
+ * @param stat [:norm, :max_abs, :mean_abs] The statistic to compute.
+ */
+static VALUE
+executor_set_monitor(VALUE obj, VALUE names, VALUE interval, VALUE stat)
+{
+  VALUE monitor;
+  mx_monitor *mon;
+  ID stat_id;
+  char const *op_names[MONITOR_MAX_STAT_OPS];
+  int num_ops, i;
+  long j;
+
+  names = rb_check_array_type(names);
+  if (NUM2LONG(interval) <= 0) {
+    rb_raise(rb_eArgError, "interval must be positive");
+  }
+
+  stat_id = SYM2ID(stat);
+  if (stat_id == rb_intern("norm")) {
+    op_names[0] = "norm";
+    num_ops = 1;
+  }
+  else if (stat_id == rb_intern("max_abs")) {
+    op_names[0] = "abs";
+    op_names[1] = "max";
+    num_ops = 2;
+  }
+  else if (stat_id == rb_intern("mean_abs")) {
+    op_names[0] = "abs";
+    op_names[1] = "mean";
+    num_ops = 2;
+  }
+  else {
+    rb_raise(rb_eArgError, "unknown monitor statistic: %"PRIsVALUE, stat);
+  }
+
+  monitor = TypedData_Make_Struct(cExecutorMonitor, mx_monitor, &monitor_data_type, mon);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init(&mon->lock, NULL);
+#endif
+  mon->interval = NUM2ULONG(interval);
+  mon->num_stat_ops = num_ops;
+  for (i = 0; i < num_ops; ++i) {
+    CHECK_CALL(MXNET_API(NNGetOpHandle)(op_names[i], &mon->stat_ops[i]));
+  }
+  mon->names = ALLOC_N(char *, RARRAY_LEN(names));
+  for (j = 0; j < RARRAY_LEN(names); ++j) {
+    VALUE name = RARRAY_AREF(names, j);
+    mon->names[j] = ruby_strdup(StringValueCStr(name));
+    mon->num_names = j + 1;
+  }
+  qsort(mon->names, mon->num_names, sizeof(char *), monitor_name_cmp);
+
+  if (MXNET_API(MXExecutorSetMonitorCallbackEX) != NULL) {
+    CHECK_CALL(MXNET_API(MXExecutorSetMonitorCallbackEX)(
+          mxnet_get_handle(obj), executor_monitor_callback, mon, false));
+  }
+  else {
+    CHECK_CALL(MXNET_API(MXExecutorSetMonitorCallback)(
+          mxnet_get_handle(obj), executor_monitor_callback, mon));
+  }
+  /* The previous monitor is released only after the callback is replaced. */
+  rb_ivar_set(obj, rb_intern("@monitor_callback"), monitor);
+
+  return obj;
+}
+
+/* Takes the records collected by the monitor as an Array of
+ * [step, name, stat, size], where +stat+ is an NDArray which may be still
+ * computing, and +size+ is the number of the elements of the output.
+ */
+static VALUE
+executor_drain_monitor(VALUE obj)
+{
+  VALUE monitor, result;
+  mx_monitor *mon;
+  struct monitor_record *records;
+  size_t n, i;
+
+  monitor = rb_attr_get(obj, rb_intern("@monitor_callback"));
+  if (NIL_P(monitor)) {
+    return rb_ary_new();
+  }
+  mon = get_monitor(monitor);
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&mon->lock);
+#endif
+  records = mon->records;
+  n = mon->num_records;
+  mon->records = NULL;
+  mon->num_records = 0;
+  mon->capa_records = 0;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock(&mon->lock);
+#endif
+
+  result = rb_ary_new_capa((long)n);
+  for (i = 0; i < n; ++i) {
+    rb_ary_push(result, rb_ary_new_from_args(4,
+          ULL2NUM(records[i].step),
+          rb_str_new_cstr(records[i].name),
+          mxnet_ndarray_new(records[i].stat),
+          ULL2NUM(records[i].size)));
+    free(records[i].name);
+  }
+  free(records);
+
+  return result;
+}
+
 struct process_kwargs_params {
   VALUE arg_dict;
 };
@@ -124,6 +454,9 @@ executor_forward(int argc, VALUE *argv, VALUE obj)
     rb_hash_foreach(kwargs, executer_forward_process_kwargs_i, (VALUE)&params);
   }
 
+  executor_monitor_tick(obj);
+
+  mxnet_ndarray_batch_flush();
   handle = mxnet_get_handle(obj);
   CHECK_CALL(MXNET_API(MXExecutorForward)(handle, (int)is_train));
 
@@ -194,6 +527,7 @@ executor_backward(int argc, VALUE *argv, VALUE obj)
     ndarray_handles[i] = mxnet_ndarray_get_handle(ndary);
   }
 
+  mxnet_ndarray_batch_flush();
   handle = mxnet_get_handle(obj);
   CHECK_CALL(MXNET_API(MXExecutorBackwardEx)(
         handle, (mx_uint)num_ndarray_handles, ndarray_handles, (int)is_train));
@@ -212,6 +546,11 @@ mxnet_init_executor(void)
   rb_define_method(cExecutor, "backward", executor_backward, -1);
 
   rb_define_private_method(cExecutor, "get_outputs", executor_outputs, 0);
+  rb_define_private_method(cExecutor, "_set_monitor", executor_set_monitor, 3);
+  rb_define_private_method(cExecutor, "_drain_monitor", executor_drain_monitor, 0);
+
+  cExecutorMonitor = rb_define_class_under(cExecutor, "Monitor", rb_cObject);
+  rb_undef_alloc_func(cExecutorMonitor);
 
   mxnet_cExecutor = cExecutor;
 }
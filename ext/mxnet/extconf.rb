@@ -9,4 +9,9 @@ have_type('int16_t', headers)
 have_type('int32_t', headers)
 have_type('int64_t', headers)
 
+have_header('pthread.h')
+have_header('sys/mman.h')
+have_header('ruby/fiber/scheduler.h')
+have_func('clock_gettime', 'time.h')
+
 create_makefile('mxnet')
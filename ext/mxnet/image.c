@@ -0,0 +1,375 @@
+#include "mxnet_internal.h"
+
+#include <math.h>
+#include <ruby/thread.h>
+#include <string.h>
+
+VALUE mxnet_mImage;
+
+/* ==== Batch decoding ====
+ *
+ * Encoded images are decoded, cropped and resized by libmxnet's OpenCV
+ * operators without the GVL.  The imperative API of libmxnet must be
+ * called from one thread, so the operators are invoked on the calling
+ * thread, and the engine runs the crops and the resizes on its worker
+ * threads while the next images are decoded.  The results are gathered
+ * into one host buffer, which is uploaded to the output NDArray with a
+ * single copy.
+ */
+
+struct image_op_handles {
+  void *decode;
+  void *slice;
+  void *resize;
+};
+
+struct image_batch_args {
+  struct image_op_handles const *ops;
+  char const **bufs;
+  size_t const *lens;
+  double const *crops;
+  size_t num_images;
+  mx_uint height, width, channels;
+  int interp;
+  NDArrayHandle *results;   /* the resized image of each image */
+  size_t num_decoded, num_copied;
+  unsigned char *out;
+  volatile int cancel;
+  int failed;
+  size_t error_index;
+  char error[256];
+};
+
+static int
+image_invoke(void *op, NDArrayHandle input, NDArrayHandle *output,
+             int num_params, char const **keys, char const **vals)
+{
+  NDArrayHandle *outputs = NULL;
+  int num_outputs = 0;
+
+  if (MXNET_API(MXImperativeInvoke)(op, 1, &input, &num_outputs, &outputs, num_params, keys, vals) != 0) {
+    return -1;
+  }
+  /* The output array is a thread-local buffer of libmxnet. */
+  *output = outputs[0];
+  return 0;
+}
+
+static void
+image_crop_rect(double const *crop, mx_uint h, mx_uint w, mx_uint *y, mx_uint *x, mx_uint *ch, mx_uint *cw)
+{
+  double area = crop[0] * h * w;
+  double ratio = exp(crop[1]);
+  double cwf = round(sqrt(area * ratio));
+  double chf = round(sqrt(area / ratio));
+
+  if (cwf < 1 || chf < 1 || cwf > w || chf > h) {
+    /* Falls back to the whole image like a failed RandomResizedCrop. */
+    *y = *x = 0;
+    *ch = h;
+    *cw = w;
+    return;
+  }
+  *cw = (mx_uint)cwf;
+  *ch = (mx_uint)chf;
+  *x = (mx_uint)floor(crop[2] * (w - *cw));
+  *y = (mx_uint)floor(crop[3] * (h - *ch));
+}
+
+/* Decodes the i-th image and pushes its crop and resize to the engine.
+ * The resulting array is stored in args->results[i]. */
+static int
+image_decode_one(struct image_batch_args *args, size_t i)
+{
+  NDArrayHandle raw = NULL, img = NULL, cropped = NULL, resized = NULL, cur;
+  mx_uint len = (mx_uint)args->lens[i], ndim, h, w;
+  mx_uint const *shape;
+  char flag[8], sbegin[64], send[64], sw[16], sh[16], sinterp[8];
+  int res = -1;
+
+  if (MXNET_API(MXNDArrayCreateEx)(&len, 1, 1, 0, 0, kUint8, &raw) != 0 ||
+      MXNET_API(MXNDArraySyncCopyFromCPU)(raw, args->bufs[i], len) != 0) {
+    goto done;
+  }
+
+  {
+    char const *keys[] = { "flag", "to_rgb" };
+    char const *vals[] = { flag, "1" };
+    snprintf(flag, sizeof(flag), "%d", args->channels == 1 ? 0 : 1);
+    if (image_invoke(args->ops->decode, raw, &img, 2, keys, vals) != 0) goto done;
+  }
+  cur = img;
+
+  if (MXNET_API(MXNDArrayGetShape)(cur, &ndim, &shape) != 0) goto done;
+  if (ndim != 3 || shape[2] != args->channels) {
+    snprintf(args->error, sizeof(args->error), "unexpected shape of a decoded image");
+    goto done;
+  }
+  h = shape[0];
+  w = shape[1];
+
+  if (args->crops) {
+    mx_uint y, x, ch, cw;
+    image_crop_rect(args->crops + 4 * i, h, w, &y, &x, &ch, &cw);
+    if (ch != h || cw != w) {
+      char const *keys[] = { "begin", "end" };
+      char const *vals[] = { sbegin, send };
+      snprintf(sbegin, sizeof(sbegin), "(%u,%u,0)", y, x);
+      snprintf(send, sizeof(send), "(%u,%u,%u)", y + ch, x + cw, args->channels);
+      if (image_invoke(args->ops->slice, cur, &cropped, 2, keys, vals) != 0) goto done;
+      cur = cropped;
+      h = ch;
+      w = cw;
+    }
+  }
+
+  if (h != args->height || w != args->width) {
+    char const *keys[] = { "w", "h", "interp" };
+    char const *vals[] = { sw, sh, sinterp };
+    snprintf(sw, sizeof(sw), "%u", args->width);
+    snprintf(sh, sizeof(sh), "%u", args->height);
+    snprintf(sinterp, sizeof(sinterp), "%d", args->interp);
+    if (image_invoke(args->ops->resize, cur, &resized, 3, keys, vals) != 0) goto done;
+    cur = resized;
+  }
+
+  /* The engine keeps the inputs of the pending operations alive. */
+  args->results[i] = cur;
+  if (cur == resized) resized = NULL;
+  if (cur == cropped) cropped = NULL;
+  if (cur == img) img = NULL;
+  res = 0;
+
+done:
+  if (res != 0 && args->error[0] == '\0') {
+    snprintf(args->error, sizeof(args->error), "%s", MXNET_API(MXGetLastError)());
+  }
+  if (resized) MXNET_API(MXNDArrayFree)(resized);
+  if (cropped) MXNET_API(MXNDArrayFree)(cropped);
+  if (img) MXNET_API(MXNDArrayFree)(img);
+  if (raw) MXNET_API(MXNDArrayFree)(raw);
+  return res;
+}
+
+/* Decodes the remaining images, and then copies the results into the
+ * host buffer.  Returns early when cancelled by image_batch_unblock. */
+static void *
+image_batch_run(void *ptr)
+{
+  struct image_batch_args *args = (struct image_batch_args *)ptr;
+  size_t slot_size = (size_t)args->height * args->width * args->channels;
+
+  while (args->num_decoded < args->num_images) {
+    if (args->cancel) return NULL;
+    if (image_decode_one(args, args->num_decoded) != 0) {
+      args->failed = 1;
+      args->error_index = args->num_decoded;
+      return NULL;
+    }
+    ++args->num_decoded;
+  }
+  while (args->num_copied < args->num_images) {
+    size_t i = args->num_copied;
+    if (args->cancel) return NULL;
+    if (MXNET_API(MXNDArraySyncCopyToCPU)(args->results[i], args->out + i * slot_size, slot_size) != 0) {
+      snprintf(args->error, sizeof(args->error), "%s", MXNET_API(MXGetLastError)());
+      args->failed = 1;
+      args->error_index = i;
+      return NULL;
+    }
+    ++args->num_copied;
+  }
+  return NULL;
+}
+
+static void
+image_batch_unblock(void *ptr)
+{
+  ((struct image_batch_args *)ptr)->cancel = 1;
+}
+
+static VALUE
+image_batch_body(VALUE ptr)
+{
+  struct image_batch_args *args = (struct image_batch_args *)ptr;
+
+  for (;;) {
+    args->cancel = 0;
+    rb_thread_call_without_gvl2(image_batch_run, args, image_batch_unblock, args);
+    if (args->failed) {
+      rb_raise(mxnet_eError, "failed to decode image %"PRIuSIZE": %s", args->error_index, args->error);
+    }
+    if (args->num_copied == args->num_images) {
+      return Qnil;
+    }
+    /* Interrupted, or skipped for a pending interrupt, which is handled or
+     * raised here before resuming. */
+    rb_thread_check_ints();
+  }
+}
+
+static VALUE
+image_batch_ensure(VALUE ptr)
+{
+  struct image_batch_args *args = (struct image_batch_args *)ptr;
+  size_t i;
+
+  for (i = 0; i < args->num_decoded; ++i) {
+    MXNET_API(MXNDArrayFree)(args->results[i]);
+  }
+  return Qnil;
+}
+
+/* Decodes encoded images into a uint8 NDArray of shape [N, H, W, C].
+ *
+ * Each image is decoded by +_cvimdecode+, optionally cropped, and resized
+ * to H x W by +_cvimresize+.  C must be 1 (grayscale) or 3 (RGB).
+ *
+ * When +crops+ is given, the i-th image is cropped by four numbers
+ * <tt>[scale, log_ratio, rx, ry]</tt>: the crop covers +scale+ of the
+ * image area with the aspect ratio <tt>exp(log_ratio)</tt>, and is placed
+ * at the relative position (+rx+, +ry+) of the remaining space.  A crop
+ * that does not fit falls back to the whole image.
+ *
+ * @param buffers [Array<String>] Encoded images.
+ * @param out [NDArray] The destination.
+ * @param crops [Array<Array<Float>>, nil] Crop parameters of each image.
+ * @param interp [Integer] The interpolation method of OpenCV.
+ * @return [NDArray] +out+.
+ */
+static VALUE
+image_s_decode_batch(VALUE mod, VALUE buffers, VALUE out, VALUE crops, VALUE interp)
+{
+  static struct image_op_handles ops;
+  NDArrayHandle handle;
+  mx_uint ndim;
+  mx_uint const *shape;
+  int dtype_id;
+  size_t num_images, slot_size;
+  char const **bufs;
+  size_t *lens;
+  double *crop_params = NULL;
+  struct image_batch_args args;
+  long i;
+  VALUE bufs_buf, lens_buf, crops_buf = Qnil, out_buf, results_buf;
+
+  if (ops.decode == NULL) {
+    CHECK_CALL(MXNET_API(NNGetOpHandle)("_cvimdecode", &ops.decode));
+    CHECK_CALL(MXNET_API(NNGetOpHandle)("slice", &ops.slice));
+    CHECK_CALL(MXNET_API(NNGetOpHandle)("_cvimresize", &ops.resize));
+  }
+
+  buffers = rb_convert_type(buffers, T_ARRAY, "Array", "to_ary");
+  mxnet_check_ndarray(out);
+
+  handle = mxnet_ndarray_get_handle(out);
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape));
+  CHECK_CALL(MXNET_API(MXNDArrayGetDType)(handle, &dtype_id));
+  if (ndim != 4 || dtype_id != kUint8 || (shape[3] != 1 && shape[3] != 3)) {
+    rb_raise(rb_eArgError, "out must be a uint8 NDArray of shape [N, H, W, 1 or 3]");
+  }
+  if (shape[0] != (mx_uint)RARRAY_LEN(buffers)) {
+    rb_raise(rb_eArgError, "out has %u images, but %ld buffers are given", shape[0], RARRAY_LEN(buffers));
+  }
+  num_images = shape[0];
+  if (num_images == 0) {
+    return out;
+  }
+
+  memset(&args, 0, sizeof(args));
+  args.ops = &ops;
+  args.num_images = num_images;
+  args.height = shape[1];
+  args.width = shape[2];
+  args.channels = shape[3];
+  args.interp = NUM2INT(interp);
+
+  bufs_buf = rb_str_tmp_new((long)(sizeof(char const *) * num_images));
+  bufs = (char const **)RSTRING_PTR(bufs_buf);
+  lens_buf = rb_str_tmp_new((long)(sizeof(size_t) * num_images));
+  lens = (size_t *)RSTRING_PTR(lens_buf);
+  for (i = 0; i < RARRAY_LEN(buffers); ++i) {
+    VALUE buf = RARRAY_AREF(buffers, i);
+    StringValue(buf);
+    bufs[i] = RSTRING_PTR(buf);
+    lens[i] = (size_t)RSTRING_LEN(buf);
+  }
+  args.bufs = bufs;
+  args.lens = lens;
+
+  if (!NIL_P(crops)) {
+    crops = rb_convert_type(crops, T_ARRAY, "Array", "to_ary");
+    if (RARRAY_LEN(crops) != (long)num_images) {
+      rb_raise(rb_eArgError, "crops must have %"PRIuSIZE" elements", num_images);
+    }
+    crops_buf = rb_str_tmp_new((long)(sizeof(double) * 4 * num_images));
+    crop_params = (double *)RSTRING_PTR(crops_buf);
+    for (i = 0; i < RARRAY_LEN(crops); ++i) {
+      VALUE crop = rb_convert_type(RARRAY_AREF(crops, i), T_ARRAY, "Array", "to_ary");
+      int k;
+      if (RARRAY_LEN(crop) != 4) {
+        rb_raise(rb_eArgError, "crop parameters must be [scale, log_ratio, rx, ry]");
+      }
+      for (k = 0; k < 4; ++k) {
+        crop_params[4 * i + k] = NUM2DBL(RARRAY_AREF(crop, k));
+      }
+    }
+  }
+  args.crops = crop_params;
+
+  slot_size = (size_t)args.height * args.width * args.channels;
+  out_buf = rb_str_tmp_new((long)(num_images * slot_size));
+  args.out = (unsigned char *)RSTRING_PTR(out_buf);
+  results_buf = rb_str_tmp_new((long)(sizeof(NDArrayHandle) * num_images));
+  args.results = (NDArrayHandle *)RSTRING_PTR(results_buf);
+
+  rb_ensure(image_batch_body, (VALUE)&args, image_batch_ensure, (VALUE)&args);
+
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, RSTRING_PTR(out_buf), num_images * slot_size));
+  RB_GC_GUARD(buffers);
+  RB_GC_GUARD(bufs_buf);
+  RB_GC_GUARD(lens_buf);
+  RB_GC_GUARD(crops_buf);
+  RB_GC_GUARD(out_buf);
+  RB_GC_GUARD(results_buf);
+
+  return out;
+}
+
+/*
+ * Returns a one-dimensional uint8 NDArray on CPU holding the bytes of
+ * +buffer+, copied in one call.
+ *
+ * @param buffer [String] An encoded image.
+ * @return [NDArray]
+ */
+static VALUE
+image_s_from_buffer(VALUE mod, VALUE buffer)
+{
+  NDArrayHandle handle;
+  mx_uint len;
+  VALUE obj;
+
+  StringValue(buffer);
+  if (RSTRING_LEN(buffer) > UINT_MAX) {
+    rb_raise(rb_eArgError, "too large buffer (%ld bytes)", RSTRING_LEN(buffer));
+  }
+  len = (mx_uint)RSTRING_LEN(buffer);
+  CHECK_CALL(MXNET_API(MXNDArrayCreateEx)(&len, 1, 1, 0, 0, kUint8, &handle));
+  obj = mxnet_ndarray_new(handle);
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, RSTRING_PTR(buffer), len));
+  RB_GC_GUARD(buffer);
+  return obj;
+}
+
+void
+mxnet_init_image(void)
+{
+  VALUE mImage;
+
+  mImage = rb_define_module_under(mxnet_mMXNet, "Image");
+  rb_define_singleton_method(mImage, "_decode_batch", image_s_decode_batch, 4);
+  rb_define_singleton_method(mImage, "_from_buffer", image_s_from_buffer, 1);
+
+  mxnet_mImage = mImage;
+}
@@ -1,5 +1,10 @@
 #include "mxnet_internal.h"
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+# include <ruby/thread.h>
+#endif
+
 VALUE mxnet_cMXDataIter;
 
 enum {
@@ -7,19 +12,436 @@ enum {
   DEBUG_AT_BEGIN = 0x02,
 };
 
+struct data_iter_prefetcher;
+
 typedef struct {
   DataIterHandle handle;
-  VALUE flags;
-  VALUE first_batch;
-  VALUE provide_data;
-  VALUE provide_label;
+  struct data_iter_prefetcher *prefetcher;
 } mx_data_iter;
 
+#ifdef HAVE_PTHREAD_H
+/* ==== Prefetcher ====
+ *
+ * A native thread advances the iterator ahead of the consumer and copies each
+ * batch into NDArrays owned by a slot.  The iterator reuses its own output
+ * buffers on the next MXDataIterNext, so the copy is required before the
+ * worker can move forward.
+ *
+ * Each slot owns its NDArray handles, while the Ruby-side wrappers hold
+ * aliases of them created by MXNDArraySlice.  Handing a slot to Ruby is then
+ * just a state change, and the wrappers are reused across batches.
+ */
+
+enum {
+  SLOT_EMPTY = 0,
+  SLOT_FILLING,
+  SLOT_HELD,
+  SLOT_READY,
+  SLOT_END,
+  SLOT_ERROR
+};
+
+typedef struct {
+  int state;
+  NDArrayHandle data;
+  NDArrayHandle label;
+  int pad;
+  uint64_t *index;
+  uint64_t index_size;
+  uint64_t index_capa;
+  unsigned long generation;
+  unsigned long wrapper_generation;
+  VALUE data_v;
+  VALUE label_v;
+} data_iter_slot;
+
+struct data_iter_prefetcher {
+  DataIterHandle handle;
+  void *copy_op;
+  int num_slots;
+  int read_pos;
+  int held;
+  int stop;
+  int interrupted;
+  int running;
+  int exited;
+  char *error;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  data_iter_slot slots[1];
+};
+
+static char *
+prefetcher_strdup(char const *str)
+{
+  size_t len = strlen(str);
+  char *dup = malloc(len + 1);
+  if (dup) memcpy(dup, str, len + 1);
+  return dup;
+}
+
+static int
+prefetcher_fail(struct data_iter_prefetcher *pf)
+{
+  free(pf->error);
+  pf->error = prefetcher_strdup(MXNET_API(MXGetLastError)());
+  return SLOT_ERROR;
+}
+
+/* Replaces the slot-owned array with a new one when the shape or dtype of
+ * the source does not match. */
+static int
+prefetcher_ensure_array(NDArrayHandle src, NDArrayHandle *pdst, unsigned long *pgeneration)
+{
+  mx_uint src_ndim, dst_ndim;
+  mx_uint const *src_shape_p, *dst_shape_p;
+  mx_uint src_shape[16];
+  int src_dtype, dst_dtype, dev_type, dev_id;
+
+  if (MXNET_API(MXNDArrayGetShape)(src, &src_ndim, &src_shape_p) != 0) return -1;
+  if (src_ndim > 16) return -1;
+  memcpy(src_shape, src_shape_p, sizeof(mx_uint) * src_ndim);
+  if (MXNET_API(MXNDArrayGetDType)(src, &src_dtype) != 0) return -1;
+
+  if (*pdst != NULL) {
+    if (MXNET_API(MXNDArrayGetShape)(*pdst, &dst_ndim, &dst_shape_p) != 0) return -1;
+    if (MXNET_API(MXNDArrayGetDType)(*pdst, &dst_dtype) != 0) return -1;
+    if (src_ndim == dst_ndim && src_dtype == dst_dtype &&
+        memcmp(src_shape, dst_shape_p, sizeof(mx_uint) * src_ndim) == 0) {
+      return 0;
+    }
+    MXNET_API(MXNDArrayFree)(*pdst);
+    *pdst = NULL;
+  }
+
+  if (MXNET_API(MXNDArrayGetContext)(src, &dev_type, &dev_id) != 0) return -1;
+  if (MXNET_API(MXNDArrayCreateEx)(src_shape, src_ndim, dev_type, dev_id, 0, src_dtype, pdst) != 0) return -1;
+  ++*pgeneration;
+
+  return 0;
+}
+
+static int
+prefetcher_copy(struct data_iter_prefetcher *pf, NDArrayHandle src, NDArrayHandle dst)
+{
+  NDArrayHandle outputs[1], *poutputs = outputs;
+  int num_outputs = 1;
+
+  outputs[0] = dst;
+  if (MXNET_API(MXImperativeInvoke)(pf->copy_op, 1, &src, &num_outputs, &poutputs, 0, NULL, NULL) != 0) return -1;
+  return MXNET_API(MXNDArrayWaitToRead)(dst);
+}
+
+static int
+prefetcher_fill_slot(struct data_iter_prefetcher *pf, data_iter_slot *slot)
+{
+  NDArrayHandle data = NULL, label = NULL;
+  uint64_t *index, index_size;
+  int next_res = 0, state = SLOT_READY;
+
+  if (MXNET_API(MXDataIterNext)(pf->handle, &next_res) != 0) {
+    return prefetcher_fail(pf);
+  }
+  if (next_res == 0) {
+    return SLOT_END;
+  }
+
+  if (MXNET_API(MXDataIterGetData)(pf->handle, &data) != 0 ||
+      MXNET_API(MXDataIterGetLabel)(pf->handle, &label) != 0 ||
+      MXNET_API(MXDataIterGetPadNum)(pf->handle, &slot->pad) != 0 ||
+      MXNET_API(MXDataIterGetIndex)(pf->handle, &index, &index_size) != 0 ||
+      prefetcher_ensure_array(data, &slot->data, &slot->generation) != 0 ||
+      prefetcher_ensure_array(label, &slot->label, &slot->generation) != 0 ||
+      prefetcher_copy(pf, data, slot->data) != 0 ||
+      prefetcher_copy(pf, label, slot->label) != 0) {
+    state = prefetcher_fail(pf);
+    goto done;
+  }
+
+  if (index_size > slot->index_capa) {
+    uint64_t *new_index = realloc(slot->index, sizeof(uint64_t) * index_size);
+    if (new_index == NULL) {
+      free(pf->error);
+      pf->error = prefetcher_strdup("failed to allocate the index buffer for prefetching");
+      state = SLOT_ERROR;
+      goto done;
+    }
+    slot->index = new_index;
+    slot->index_capa = index_size;
+  }
+  if (index_size > 0) {
+    memcpy(slot->index, index, sizeof(uint64_t) * index_size);
+  }
+  slot->index_size = index_size;
+
+done:
+  if (data) MXNET_API(MXNDArrayFree)(data);
+  if (label) MXNET_API(MXNDArrayFree)(label);
+  return state;
+}
+
+static void *
+prefetcher_worker(void *ptr)
+{
+  struct data_iter_prefetcher *pf = (struct data_iter_prefetcher *)ptr;
+  int pos = 0, state;
+
+  for (;;) {
+    data_iter_slot *slot = &pf->slots[pos];
+
+    pthread_mutex_lock(&pf->mutex);
+    while (!pf->stop && slot->state != SLOT_EMPTY) {
+      pthread_cond_wait(&pf->cond, &pf->mutex);
+    }
+    if (pf->stop) {
+      pthread_mutex_unlock(&pf->mutex);
+      break;
+    }
+    slot->state = SLOT_FILLING;
+    pthread_mutex_unlock(&pf->mutex);
+
+    state = prefetcher_fill_slot(pf, slot);
+
+    pthread_mutex_lock(&pf->mutex);
+    slot->state = state;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->mutex);
+
+    if (state != SLOT_READY) break;
+    pos = (pos + 1) % pf->num_slots;
+  }
+
+  pthread_mutex_lock(&pf->mutex);
+  pf->exited = 1;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->mutex);
+
+  return NULL;
+}
+
+/* Starts the prefetching thread.  Returns the error number of
+ * pthread_create, and leaves the prefetcher stopped on failure. */
+static int
+prefetcher_start(struct data_iter_prefetcher *pf)
+{
+  int i, err;
+
+  for (i = 0; i < pf->num_slots; ++i) {
+    pf->slots[i].state = SLOT_EMPTY;
+  }
+  pf->read_pos = 0;
+  pf->held = -1;
+  pf->stop = 0;
+  pf->exited = 0;
+  free(pf->error);
+  pf->error = NULL;
+
+  err = pthread_create(&pf->thread, NULL, prefetcher_worker, pf);
+  if (err != 0) {
+    return err;
+  }
+  pf->running = 1;
+  return 0;
+}
+
+static void *
+prefetcher_wait_exit(void *ptr)
+{
+  struct data_iter_prefetcher *pf = (struct data_iter_prefetcher *)ptr;
+
+  pthread_mutex_lock(&pf->mutex);
+  while (!pf->interrupted && !pf->exited) {
+    pthread_cond_wait(&pf->cond, &pf->mutex);
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return NULL;
+}
+
+static void prefetcher_unblock(void *ptr);
+
+static void
+prefetcher_stop(struct data_iter_prefetcher *pf, int with_gvl)
+{
+  if (!pf->running) return;
+
+  pthread_mutex_lock(&pf->mutex);
+  pf->stop = 1;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->mutex);
+
+  if (with_gvl) {
+    /* The worker may be in MXDataIterNext, so wait for it interruptibly.
+     * If an interrupt raises, the prefetcher stays stopping and the next
+     * call waits again. */
+    for (;;) {
+      int exited;
+
+      pthread_mutex_lock(&pf->mutex);
+      exited = pf->exited;
+      pf->interrupted = 0;
+      pthread_mutex_unlock(&pf->mutex);
+      if (exited) break;
+
+      rb_thread_call_without_gvl(prefetcher_wait_exit, pf, prefetcher_unblock, pf);
+      rb_thread_check_ints();
+    }
+  }
+  pthread_join(pf->thread, NULL);
+  pf->running = 0;
+}
+
+static void
+prefetcher_free(struct data_iter_prefetcher *pf)
+{
+  int i;
+
+  prefetcher_stop(pf, 0);
+  for (i = 0; i < pf->num_slots; ++i) {
+    data_iter_slot *slot = &pf->slots[i];
+    if (slot->data) MXNET_API(MXNDArrayFree)(slot->data);
+    if (slot->label) MXNET_API(MXNDArrayFree)(slot->label);
+    free(slot->index);
+  }
+  free(pf->error);
+  pthread_cond_destroy(&pf->cond);
+  pthread_mutex_destroy(&pf->mutex);
+  xfree(pf);
+}
+
+static void
+prefetcher_mark(struct data_iter_prefetcher *pf)
+{
+  int i;
+
+  for (i = 0; i < pf->num_slots; ++i) {
+    rb_gc_mark(pf->slots[i].data_v);
+    rb_gc_mark(pf->slots[i].label_v);
+  }
+}
+
+static void *
+prefetcher_wait(void *ptr)
+{
+  struct data_iter_prefetcher *pf = (struct data_iter_prefetcher *)ptr;
+
+  pthread_mutex_lock(&pf->mutex);
+  while (!pf->interrupted && !pf->stop && pf->slots[pf->read_pos].state < SLOT_READY) {
+    pthread_cond_wait(&pf->cond, &pf->mutex);
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return NULL;
+}
+
+static void
+prefetcher_unblock(void *ptr)
+{
+  struct data_iter_prefetcher *pf = (struct data_iter_prefetcher *)ptr;
+
+  pthread_mutex_lock(&pf->mutex);
+  pf->interrupted = 1;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->mutex);
+}
+
+static VALUE
+prefetcher_wrap(NDArrayHandle handle)
+{
+  NDArrayHandle alias;
+  mx_uint ndim;
+  mx_uint const *shape;
+
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape));
+  CHECK_CALL(MXNET_API(MXNDArraySlice)(handle, 0, ndim > 0 ? shape[0] : 1, &alias));
+  return mxnet_ndarray_new(alias);
+}
+
+/* Releases the slot held by the consumer, and then waits for the next one.
+ * Returns the slot, or NULL at the end of the data. */
+static data_iter_slot *
+prefetcher_next(struct data_iter_prefetcher *pf)
+{
+  data_iter_slot *slot;
+  int state;
+
+  pthread_mutex_lock(&pf->mutex);
+  if (pf->held >= 0) {
+    pf->slots[pf->held].state = SLOT_EMPTY;
+    pf->held = -1;
+    pthread_cond_broadcast(&pf->cond);
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  slot = &pf->slots[pf->read_pos];
+  for (;;) {
+    int stop;
+
+    pthread_mutex_lock(&pf->mutex);
+    state = slot->state;
+    stop = pf->stop;
+    pf->interrupted = 0;
+    pthread_mutex_unlock(&pf->mutex);
+    if (state >= SLOT_READY) break;
+    if (stop) {
+      rb_raise(rb_eRuntimeError, "the prefetching thread has been stopped");
+    }
+
+    rb_thread_call_without_gvl(prefetcher_wait, pf, prefetcher_unblock, pf);
+    rb_thread_check_ints();
+  }
+
+  switch (state) {
+    case SLOT_END:
+      return NULL;
+    case SLOT_ERROR:
+      rb_raise(mxnet_eError, "%s", pf->error ? pf->error : "unknown error in the prefetching thread");
+    default:
+      break;
+  }
+
+  if (slot->wrapper_generation != slot->generation || NIL_P(slot->data_v)) {
+    slot->data_v = prefetcher_wrap(slot->data);
+    slot->label_v = prefetcher_wrap(slot->label);
+    slot->wrapper_generation = slot->generation;
+  }
+
+  pthread_mutex_lock(&pf->mutex);
+  slot->state = SLOT_HELD;
+  pf->held = pf->read_pos;
+  pf->read_pos = (pf->read_pos + 1) % pf->num_slots;
+  pthread_mutex_unlock(&pf->mutex);
+
+  return slot;
+}
+#endif /* HAVE_PTHREAD_H */
+
+static void
+data_iter_mark(void *ptr)
+{
+#ifdef HAVE_PTHREAD_H
+  mx_data_iter *iter = (mx_data_iter *)ptr;
+  if (iter != NULL && iter->prefetcher != NULL) {
+    prefetcher_mark(iter->prefetcher);
+  }
+#endif
+}
+
 static void
 data_iter_free(void *ptr)
 {
-  if (ptr != NULL) {
-    CHECK_CALL(MXNET_API(MXDataIterFree)((DataIterHandle)ptr));
+  mx_data_iter *iter = (mx_data_iter *)ptr;
+  if (iter != NULL) {
+#ifdef HAVE_PTHREAD_H
+    if (iter->prefetcher != NULL) {
+      prefetcher_free(iter->prefetcher);
+    }
+#endif
+    if (iter->handle != NULL) {
+      CHECK_CALL(MXNET_API(MXDataIterFree)(iter->handle));
+    }
+    xfree(iter);
   }
 }
 
@@ -32,25 +454,36 @@ data_iter_memsize(void const *ptr)
 static const rb_data_type_t data_iter_data_type = {
   "MXDataIter",
   {
-    NULL,
+    data_iter_mark,
     data_iter_free,
     data_iter_memsize,
   },
   0, 0, RUBY_TYPED_FREE_IMMEDIATELY
 };
 
+static mx_data_iter *
+get_data_iter(VALUE obj)
+{
+  mx_data_iter *iter;
+  TypedData_Get_Struct(obj, mx_data_iter, &data_iter_data_type, iter);
+  return iter;
+}
+
 static DataIterHandle
 get_data_iter_handle(VALUE obj)
 {
-  DataIterHandle handle;
-  TypedData_Get_Struct(obj, void, &data_iter_data_type, handle);
-  return handle;
+  mx_data_iter *iter = get_data_iter(obj);
+  if (iter->prefetcher != NULL) {
+    rb_raise(rb_eRuntimeError, "the iterator is driven by the prefetching thread");
+  }
+  return iter->handle;
 }
 
 static VALUE
 data_iter_allocate(VALUE klass)
 {
-  return TypedData_Wrap_Struct(klass, &data_iter_data_type, NULL);
+  mx_data_iter *iter;
+  return TypedData_Make_Struct(klass, mx_data_iter, &data_iter_data_type, iter);
 }
 
 static int
@@ -61,6 +494,10 @@ data_iter_initialize_extract_kwargs_i(VALUE key, VALUE val, VALUE arg)
   char const **param_vals = (char const **)pmemo[1];
 
   if (RB_TYPE_P(key, T_SYMBOL)) {
+    /* prefetch: and reuse_batch: are consumed by MXDataIter, not by libmxnet */
+    if (SYM2ID(key) == rb_intern("prefetch") || SYM2ID(key) == rb_intern("reuse_batch")) {
+      return ST_CONTINUE;
+    }
     key = rb_sym_to_s(key);
   }
   *param_keys = StringValueCStr(key);
@@ -109,10 +546,11 @@ data_iter_initialize(int argc, VALUE *argv, VALUE obj)
     memo[1] = (VALUE)param_vals;
     memo[2] = rb_ary_tmp_new(num_param * 2);
     rb_hash_foreach(kwargs, data_iter_initialize_extract_kwargs_i, (VALUE)memo);
+    num_param = (mx_uint)((char const **)memo[0] - param_keys);
   }
 
   CHECK_CALL(MXNET_API(MXDataIterCreateIter)(creator_handle, num_param, param_keys, param_vals, &iter_handle));
-  DATA_PTR(obj) = iter_handle;
+  get_data_iter(obj)->handle = iter_handle;
 
   rb_call_super(argc, argv);
 
@@ -122,14 +560,143 @@ data_iter_initialize(int argc, VALUE *argv, VALUE obj)
 static VALUE
 data_iter_reset_impl(VALUE obj)
 {
-  DataIterHandle handle;
-
-  handle = get_data_iter_handle(obj);
-  CHECK_CALL(MXNET_API(MXDataIterBeforeFirst)(handle));
+  mx_data_iter *iter;
+
+  iter = get_data_iter(obj);
+#ifdef HAVE_PTHREAD_H
+  if (iter->prefetcher != NULL) {
+    struct data_iter_prefetcher *pf = iter->prefetcher;
+    int err;
+
+    prefetcher_stop(pf, 1);
+    CHECK_CALL(MXNET_API(MXDataIterBeforeFirst)(iter->handle));
+    err = prefetcher_start(pf);
+    if (err != 0) {
+      iter->prefetcher = NULL;
+      prefetcher_free(pf);
+      rb_syserr_fail(err, "pthread_create");
+    }
+    return Qnil;
+  }
+#endif
+  CHECK_CALL(MXNET_API(MXDataIterBeforeFirst)(iter->handle));
 
   return Qnil;
 }
 
+/* Starts the native prefetching thread with the given number of slots.
+ * After this call, batches must be taken by `_prefetch_next`.
+ */
+static VALUE
+data_iter_start_prefetch(VALUE obj, VALUE num_slots_v)
+{
+#ifdef HAVE_PTHREAD_H
+  mx_data_iter *iter;
+  struct data_iter_prefetcher *pf;
+  int i, num_slots, err;
+  void *copy_op;
+
+  iter = get_data_iter(obj);
+  if (iter->prefetcher != NULL) {
+    rb_raise(rb_eRuntimeError, "prefetching has already been started");
+  }
+
+  num_slots = NUM2INT(num_slots_v);
+  if (num_slots < 1) {
+    rb_raise(rb_eArgError, "prefetch must be positive (%d given)", num_slots);
+  }
+
+  CHECK_CALL(MXNET_API(NNGetOpHandle)("_copyto", &copy_op));
+
+  pf = (struct data_iter_prefetcher *)xcalloc(1,
+      sizeof(struct data_iter_prefetcher) + sizeof(data_iter_slot) * (num_slots - 1));
+  pf->handle = iter->handle;
+  pf->copy_op = copy_op;
+  pf->num_slots = num_slots;
+  for (i = 0; i < num_slots; ++i) {
+    pf->slots[i].data_v = Qnil;
+    pf->slots[i].label_v = Qnil;
+  }
+  pthread_mutex_init(&pf->mutex, NULL);
+  pthread_cond_init(&pf->cond, NULL);
+
+  err = prefetcher_start(pf);
+  if (err != 0) {
+    prefetcher_free(pf);
+    rb_syserr_fail(err, "pthread_create");
+  }
+  iter->prefetcher = pf;
+
+  return obj;
+#else
+  rb_raise(rb_eNotImpError, "prefetch is unavailable on this platform");
+#endif
+}
+
+/* Takes the next prefetched batch.
+ *
+ * Returns `[data, label, pad, index]`, or `nil` at the end of the data.
+ * `data` and `label` are the NDArrays of the slot, which are reused once the
+ * slot comes round again.  `index` is a binary String of native uint64
+ * values, that can be decoded by `unpack('Q*')`.
+ */
+static VALUE
+data_iter_prefetch_next(VALUE obj)
+{
+#ifdef HAVE_PTHREAD_H
+  mx_data_iter *iter;
+  data_iter_slot *slot;
+  VALUE res;
+
+  iter = get_data_iter(obj);
+  if (iter->prefetcher == NULL) {
+    rb_raise(rb_eRuntimeError, "prefetching is not started");
+  }
+
+  slot = prefetcher_next(iter->prefetcher);
+  if (slot == NULL) {
+    return Qnil;
+  }
+
+  res = rb_ary_new_capa(4);
+  rb_ary_push(res, slot->data_v);
+  rb_ary_push(res, slot->label_v);
+  rb_ary_push(res, INT2NUM(slot->pad));
+  rb_ary_push(res, rb_str_new((char const *)slot->index, (long)(sizeof(uint64_t) * slot->index_size)));
+  return res;
+#else
+  rb_raise(rb_eNotImpError, "prefetch is unavailable on this platform");
+#endif
+}
+
+/* Returns the number of prefetched batches ready to be taken, excluding the
+ * one held by the consumer. */
+static VALUE
+data_iter_prefetch_occupancy(VALUE obj)
+{
+#ifdef HAVE_PTHREAD_H
+  mx_data_iter *iter;
+  struct data_iter_prefetcher *pf;
+  int i, count = 0;
+
+  iter = get_data_iter(obj);
+  pf = iter->prefetcher;
+  if (pf == NULL) {
+    return INT2FIX(0);
+  }
+
+  pthread_mutex_lock(&pf->mutex);
+  for (i = 0; i < pf->num_slots; ++i) {
+    if (pf->slots[i].state == SLOT_READY) ++count;
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return INT2FIX(count);
+#else
+  return INT2FIX(0);
+#endif
+}
+
 static VALUE
 data_iter_iter_next_impl(VALUE obj)
 {
@@ -142,30 +709,50 @@ data_iter_iter_next_impl(VALUE obj)
   return INT2NUM(next_res);
 }
 
+/* When an NDArray is given, it is rebound to the current data and returned
+ * instead of a new wrapper. */
 static VALUE
-data_iter_current_data_impl(VALUE obj)
+data_iter_current_data_impl(int argc, VALUE *argv, VALUE obj)
 {
   DataIterHandle handle;
   NDArrayHandle ndary_handle;
-  VALUE ndary;
+  VALUE ndary, out;
+
+  rb_scan_args(argc, argv, "01", &out);
 
   handle = get_data_iter_handle(obj);
   CHECK_CALL(MXNET_API(MXDataIterGetData)(handle, &ndary_handle));
 
+  if (!NIL_P(out)) {
+    mxnet_check_ndarray(out);
+    mxnet_ndarray_rebind(out, ndary_handle);
+    return out;
+  }
+
   ndary = mxnet_ndarray_new(ndary_handle);
   return ndary;
 }
 
+/* When an NDArray is given, it is rebound to the current label and returned
+ * instead of a new wrapper. */
 static VALUE
-data_iter_current_label_impl(VALUE obj)
+data_iter_current_label_impl(int argc, VALUE *argv, VALUE obj)
 {
   DataIterHandle handle;
   NDArrayHandle ndary_handle;
-  VALUE ndary;
+  VALUE ndary, out;
+
+  rb_scan_args(argc, argv, "01", &out);
 
   handle = get_data_iter_handle(obj);
   CHECK_CALL(MXNET_API(MXDataIterGetLabel)(handle, &ndary_handle));
 
+  if (!NIL_P(out)) {
+    mxnet_check_ndarray(out);
+    mxnet_ndarray_rebind(out, ndary_handle);
+    return out;
+  }
+
   ndary = mxnet_ndarray_new(ndary_handle);
   return ndary;
 }
@@ -229,10 +816,13 @@ mxnet_init_io(void)
   rb_define_alloc_func(mxnet_cMXDataIter, data_iter_allocate);
   rb_define_private_method(mxnet_cMXDataIter, "_reset", data_iter_reset_impl, 0);
   rb_define_private_method(mxnet_cMXDataIter, "_iter_next", data_iter_iter_next_impl, 0);
-  rb_define_private_method(mxnet_cMXDataIter, "_current_data", data_iter_current_data_impl, 0);
-  rb_define_private_method(mxnet_cMXDataIter, "_current_label", data_iter_current_label_impl, 0);
+  rb_define_private_method(mxnet_cMXDataIter, "_current_data", data_iter_current_data_impl, -1);
+  rb_define_private_method(mxnet_cMXDataIter, "_current_label", data_iter_current_label_impl, -1);
   rb_define_private_method(mxnet_cMXDataIter, "_current_pad", data_iter_current_pad_impl, 0);
   rb_define_private_method(mxnet_cMXDataIter, "_current_index", data_iter_current_index_impl, 0);
+  rb_define_private_method(mxnet_cMXDataIter, "_start_prefetch", data_iter_start_prefetch, 1);
+  rb_define_private_method(mxnet_cMXDataIter, "_prefetch_next", data_iter_prefetch_next, 0);
+  rb_define_private_method(mxnet_cMXDataIter, "_prefetch_occupancy", data_iter_prefetch_occupancy, 0);
 
   {
     mx_uint i, size;
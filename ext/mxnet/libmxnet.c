@@ -47,6 +47,9 @@ init_api_table(VALUE handle)
     ((api_table).member_name) = fptr; \
   } while (0)
 #define INIT_API_TABLE_ENTRY(api_name) INIT_API_TABLE_ENTRY2(api_name, api_name)
+/* Optional entries are left NULL when the library does not provide them. */
+#define INIT_OPTIONAL_API_TABLE_ENTRY(api_name) \
+  ((api_table).api_name = LOOKUP_API_ENTRY(api_name))
 
   INIT_API_TABLE_ENTRY(MXGetLastError);
   INIT_API_TABLE_ENTRY(MXRandomSeed);
@@ -55,8 +58,11 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXExecutorForward);
   INIT_API_TABLE_ENTRY(MXExecutorBackwardEx);
   INIT_API_TABLE_ENTRY(MXExecutorBindEX);
+  INIT_API_TABLE_ENTRY(MXExecutorSetMonitorCallback);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXExecutorSetMonitorCallbackEX);
 
   INIT_API_TABLE_ENTRY(MXNDArrayCreateEx);
+  INIT_API_TABLE_ENTRY(MXNDArrayCreateNone);
   INIT_API_TABLE_ENTRY(MXNDArrayFree);
   INIT_API_TABLE_ENTRY(MXNDArraySave);
   INIT_API_TABLE_ENTRY(MXNDArrayLoad);
@@ -71,6 +77,7 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXNDArraySlice);
   INIT_API_TABLE_ENTRY(MXNDArrayGetGrad);
   INIT_API_TABLE_ENTRY(MXNDArrayWaitToRead);
+  INIT_API_TABLE_ENTRY(MXNDArrayWaitAll);
 
   INIT_API_TABLE_ENTRY(MXAutogradSetIsRecording);
   INIT_API_TABLE_ENTRY(MXAutogradSetIsTraining);
@@ -101,6 +108,7 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXSymbolCreateGroup);
   INIT_API_TABLE_ENTRY(NNSymbolCompose);
   INIT_API_TABLE_ENTRY(MXSymbolCopy);
+  INIT_API_TABLE_ENTRY(MXSymbolGetInternals);
   INIT_API_TABLE_ENTRY(MXSymbolCreateVariable);
   INIT_API_TABLE_ENTRY(MXSymbolGetName);
   INIT_API_TABLE_ENTRY(MXSymbolGetAttr);
@@ -115,6 +123,40 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXSymbolSaveToFile);
   INIT_API_TABLE_ENTRY(MXSymbolSaveToJSON);
 
+  INIT_API_TABLE_ENTRY(MXRecordIOWriterCreate);
+  INIT_API_TABLE_ENTRY(MXRecordIOWriterFree);
+  INIT_API_TABLE_ENTRY(MXRecordIOWriterWriteRecord);
+  INIT_API_TABLE_ENTRY(MXRecordIOWriterTell);
+  INIT_API_TABLE_ENTRY(MXRecordIOReaderCreate);
+  INIT_API_TABLE_ENTRY(MXRecordIOReaderFree);
+  INIT_API_TABLE_ENTRY(MXRecordIOReaderReadRecord);
+  INIT_API_TABLE_ENTRY(MXRecordIOReaderSeek);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXRecordIOReaderTell);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXSetProfilerConfig);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXSetProfilerState);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXDumpProfile);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXAggregateProfileStatsPrint);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfilePause);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileCreateDomain);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileCreateTask);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileCreateFrame);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileCreateEvent);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileCreateCounter);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileDestroyHandle);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileDurationStart);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileDurationStop);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileSetCounter);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileAdjustCounter);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXProfileSetMarker);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXSetNumOMPThreads);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXLibInfoFeatures);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXEngineSetBulkSize);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXEnginePushSyncND);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXStorageEmptyCache);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXGetGPUMemoryInformation64);
+
   INIT_API_TABLE_ENTRY(MXCreateCachedOpEx);
   INIT_API_TABLE_ENTRY(MXFreeCachedOp);
   INIT_API_TABLE_ENTRY(MXInvokeCachedOpEx);
@@ -124,10 +166,21 @@ static VALUE
 imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out)
 {
   VALUE inputs_str, outputs_str, keys_str, vals_str;
-  int i;
+  int i, status;
   int num_inputs, num_params, num_outputs = 0;
+  void *op_handle;
   void **inputs, **outputs = NULL;
   char const **params_keys, **params_vals;
+  NDArrayHandle (*get_handle)(VALUE);
+  VALUE batch = Qnil;
+
+  op_handle = NUM2PTR(handle);
+  if (mxnet_ndarray_batch_depth > 0) {
+    batch = mxnet_ndarray_batch_current();
+  }
+  /* A recorded operation may take the outputs of the operations recorded
+   * before it, which must not be submitted to get their handles. */
+  get_handle = NIL_P(batch) ? mxnet_ndarray_get_handle : mxnet_ndarray_get_handle_raw;
 
   ndargs = rb_convert_type(ndargs, T_ARRAY, "Array", "to_ary");
   keys = rb_convert_type(keys, T_ARRAY, "Array", "to_ary");
@@ -140,7 +193,7 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
   inputs_str = rb_str_tmp_new(sizeof(void *)*num_inputs);
   inputs = (void **)RSTRING_PTR(inputs_str);
   for (i = 0; i < num_inputs; ++i) {
-    inputs[i] = mxnet_ndarray_get_handle(RARRAY_AREF(ndargs, i));
+    inputs[i] = get_handle(RARRAY_AREF(ndargs, i));
   }
 
   num_params = (int)RARRAY_LEN(keys);
@@ -166,7 +219,7 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
       num_outputs = 1;
       outputs_str = rb_str_tmp_new(sizeof(void *));
       outputs = (void **)RSTRING_PTR(outputs_str);
-      outputs[0] = mxnet_ndarray_get_handle(out);
+      outputs[0] = get_handle(out);
     }
     else {
       out = rb_convert_type(out, T_ARRAY, "Array", "to_ary");
@@ -178,16 +231,37 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
       outputs = (void **)RSTRING_PTR(outputs_str);
       for (i = 0; i < num_outputs; ++i) {
         VALUE v = RARRAY_AREF(out, i);
-        outputs[i] = mxnet_ndarray_get_handle(v);
+        outputs[i] = get_handle(v);
       }
     }
   }
 
-  CHECK_CALL(MXNET_API(MXImperativeInvoke)(
-        NUM2PTR(handle),
+  if (!NIL_P(batch)) {
+    return mxnet_ndarray_batch_record(batch, op_handle,
+                                      ndargs, inputs, num_inputs,
+                                      params_keys, params_vals, num_params,
+                                      out, outputs, num_outputs);
+  }
+
+  if (mxnet_op_stats_enabled) {
+    uint64_t start_ns = mxnet_op_stats_clock();
+    status = MXNET_API(MXImperativeInvoke)(
+        op_handle,
         num_inputs, inputs,
         &num_outputs, &outputs,
-        num_params, params_keys, params_vals));
+        num_params, params_keys, params_vals);
+    if (status == 0) {
+      mxnet_op_stats_record(op_handle, start_ns, inputs, num_inputs);
+    }
+  }
+  else {
+    status = MXNET_API(MXImperativeInvoke)(
+        op_handle,
+        num_inputs, inputs,
+        &num_outputs, &outputs,
+        num_params, params_keys, params_vals);
+  }
+  CHECK_CALL(status);
 
   if (!NIL_P(out)) {
     return out;
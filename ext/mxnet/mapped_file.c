@@ -0,0 +1,762 @@
+#include "mxnet_internal.h"
+
+#include <math.h>
+#include <ruby/thread.h>
+
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <errno.h>
+#endif
+
+VALUE mxnet_cMappedFile;
+
+typedef struct {
+  char *ptr;
+  size_t size;
+  int closed;
+  int busy;
+} mx_mapped_file;
+
+static void
+mapped_file_unmap(mx_mapped_file *mf)
+{
+#ifdef HAVE_SYS_MMAN_H
+  if (mf->ptr != NULL) {
+    munmap(mf->ptr, mf->size);
+  }
+#endif
+  mf->ptr = NULL;
+  mf->size = 0;
+}
+
+static void
+mapped_file_free(void *ptr)
+{
+  mx_mapped_file *mf = (mx_mapped_file *)ptr;
+  mapped_file_unmap(mf);
+  xfree(mf);
+}
+
+static size_t
+mapped_file_memsize(void const *ptr)
+{
+  return sizeof(mx_mapped_file);
+}
+
+static const rb_data_type_t mapped_file_data_type = {
+  "MXNet::MappedFile",
+  {
+    NULL,
+    mapped_file_free,
+    mapped_file_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+mapped_file_allocate(VALUE klass)
+{
+  mx_mapped_file *mf;
+  return TypedData_Make_Struct(klass, mx_mapped_file, &mapped_file_data_type, mf);
+}
+
+static mx_mapped_file *
+get_mapped_file(VALUE obj)
+{
+  mx_mapped_file *mf;
+  TypedData_Get_Struct(obj, mx_mapped_file, &mapped_file_data_type, mf);
+  return mf;
+}
+
+static mx_mapped_file *
+get_opened_mapped_file(VALUE obj)
+{
+  mx_mapped_file *mf = get_mapped_file(obj);
+  if (mf->closed) {
+    rb_raise(rb_eIOError, "closed mapped file");
+  }
+  return mf;
+}
+
+/* Maps the whole file at the given path read-only.
+ *
+ * @param path [String] The path of the file.
+ */
+static VALUE
+mapped_file_initialize(VALUE obj, VALUE path)
+{
+#ifdef HAVE_SYS_MMAN_H
+  mx_mapped_file *mf;
+  struct stat st;
+  char const *path_cstr;
+  int fd;
+
+  mf = get_mapped_file(obj);
+  FilePathValue(path);
+  path_cstr = StringValueCStr(path);
+
+  fd = open(path_cstr, O_RDONLY);
+  if (fd < 0) {
+    rb_sys_fail_str(path);
+  }
+  if (fstat(fd, &st) != 0) {
+    int e = errno;
+    close(fd);
+    rb_syserr_fail_str(e, path);
+  }
+
+  mf->size = (size_t)st.st_size;
+  if (mf->size > 0) {
+    void *ptr = mmap(NULL, mf->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      int e = errno;
+      close(fd);
+      mf->size = 0;
+      rb_syserr_fail_str(e, path);
+    }
+    mf->ptr = (char *)ptr;
+  }
+  close(fd);
+
+  rb_ivar_set(obj, rb_intern("@path"), rb_str_dup_frozen(path));
+
+  return obj;
+#else
+  rb_raise(rb_eNotImpError, "mmap is unavailable on this platform");
+#endif
+}
+
+static VALUE
+mapped_file_size(VALUE obj)
+{
+  mx_mapped_file *mf = get_opened_mapped_file(obj);
+  return SIZET2NUM(mf->size);
+}
+
+static VALUE
+mapped_file_close(VALUE obj)
+{
+  mx_mapped_file *mf = get_mapped_file(obj);
+  if (mf->busy > 0) {
+    rb_raise(rb_eIOError, "mapped file is in use by another thread");
+  }
+  mapped_file_unmap(mf);
+  mf->closed = 1;
+  return Qnil;
+}
+
+static VALUE
+mapped_file_closed_p(VALUE obj)
+{
+  mx_mapped_file *mf = get_mapped_file(obj);
+  return mf->closed ? Qtrue : Qfalse;
+}
+
+/* Converts a record index, raising IndexError for a negative index. */
+static size_t
+mapped_file_record_index(VALUE index_v)
+{
+  long index = NUM2LONG(index_v);
+
+  if (index < 0) {
+    rb_raise(rb_eIndexError, "negative record index %ld", index);
+  }
+  return (size_t)index;
+}
+
+/* Raises RangeError unless the records [first, first + count) of stride
+ * bytes from offset are in the mapping, without wrapping around. */
+static void
+mapped_file_check_records(mx_mapped_file *mf, size_t offset, size_t stride, size_t first, size_t count)
+{
+  if (stride > 0 && (offset > mf->size || first > (mf->size - offset) / stride ||
+                     count > (mf->size - offset) / stride - first)) {
+    rb_raise(rb_eRangeError, "records [%"PRIuSIZE", %"PRIuSIZE") of %"PRIuSIZE" bytes exceed the mapped size %"PRIuSIZE,
+             first, first + count, stride, mf->size);
+  }
+}
+
+static void
+mapped_file_check_range(mx_mapped_file *mf, size_t offset, size_t length)
+{
+  if (offset > mf->size || length > mf->size - offset) {
+    rb_raise(rb_eRangeError, "range [%"PRIuSIZE", %"PRIuSIZE") exceeds the mapped size %"PRIuSIZE,
+             offset, offset + length, mf->size);
+  }
+}
+
+/* Returns a copy of the bytes at [offset, offset + length) as a binary String.
+ */
+static VALUE
+mapped_file_read(VALUE obj, VALUE offset_v, VALUE length_v)
+{
+  mx_mapped_file *mf;
+  size_t offset, length;
+
+  mf = get_opened_mapped_file(obj);
+  offset = NUM2SIZET(offset_v);
+  length = NUM2SIZET(length_v);
+  mapped_file_check_range(mf, offset, length);
+
+  return rb_str_new(mf->ptr + offset, (long)length);
+}
+
+/* Uploads records from the mapping into an NDArray.
+ *
+ * The i-th record is the +stride+ bytes at <tt>offset + i * stride</tt>.  The
+ * records at the given indices are copied to +ndarray+, whose size must be
+ * <tt>indices.length * stride</tt> bytes.  A run of consecutive indices is
+ * copied straight from the mapping without an intermediate buffer.  The
+ * indices must not be negative.
+ *
+ * @param ndarray [NDArray] The destination.
+ * @param offset [Integer] The offset of the first record.
+ * @param stride [Integer] The byte size of a record.
+ * @param indices [Array<Integer>, Range] Record indices.
+ * @return [NDArray] +ndarray+.
+ */
+static VALUE
+mapped_file_copy_to(VALUE obj, VALUE ndarray, VALUE offset_v, VALUE stride_v, VALUE indices)
+{
+  mx_mapped_file *mf;
+  NDArrayHandle handle;
+  mx_uint ndim, i;
+  mx_uint const *shape;
+  int dtype_id;
+  size_t offset, stride, elsize, num_elements = 1, num_records, first;
+  long j;
+  int contiguous = 1;
+  char const *src;
+  VALUE buf = Qnil;
+
+  mf = get_opened_mapped_file(obj);
+  mxnet_check_ndarray(ndarray);
+  offset = NUM2SIZET(offset_v);
+  stride = NUM2SIZET(stride_v);
+
+  if (rb_obj_is_kind_of(indices, rb_cRange)) {
+    indices = rb_funcallv(indices, rb_intern("to_a"), 0, NULL);
+  }
+  indices = rb_convert_type(indices, T_ARRAY, "Array", "to_ary");
+  num_records = (size_t)RARRAY_LEN(indices);
+  if (num_records == 0) {
+    return ndarray;
+  }
+
+  handle = mxnet_ndarray_get_handle(ndarray);
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape));
+  CHECK_CALL(MXNET_API(MXNDArrayGetDType)(handle, &dtype_id));
+  for (i = 0; i < ndim; ++i) {
+    num_elements *= shape[i];
+  }
+  elsize = mxnet_dtype_size(dtype_id);
+  if (elsize == 0 || num_elements * elsize != num_records * stride) {
+    rb_raise(rb_eArgError, "the size of NDArray (%"PRIuSIZE" bytes) does not match %"PRIuSIZE" records of %"PRIuSIZE" bytes",
+             num_elements * elsize, num_records, stride);
+  }
+
+  first = mapped_file_record_index(RARRAY_AREF(indices, 0));
+  for (j = 1; j < RARRAY_LEN(indices); ++j) {
+    if (mapped_file_record_index(RARRAY_AREF(indices, j)) != first + (size_t)j) {
+      contiguous = 0;
+      break;
+    }
+  }
+
+  if (contiguous) {
+    mapped_file_check_records(mf, offset, stride, first, num_records);
+    src = mf->ptr + offset + first * stride;
+  }
+  else {
+    char *dst;
+    buf = rb_str_tmp_new((long)(num_records * stride));
+    dst = RSTRING_PTR(buf);
+    for (j = 0; j < RARRAY_LEN(indices); ++j) {
+      size_t k = mapped_file_record_index(RARRAY_AREF(indices, j));
+      mapped_file_check_records(mf, offset, stride, k, 1);
+      memcpy(dst + j * stride, mf->ptr + offset + k * stride, stride);
+    }
+    src = dst;
+  }
+
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, src, num_elements));
+  RB_GC_GUARD(buf);
+
+  return ndarray;
+}
+
+/* ==== Line-oriented text ====
+ *
+ * A line index is a binary String of native uint64_t offsets, one per
+ * non-empty line, pointing at the first byte of the line.  The end of a line
+ * is found again with memchr when it is read, so blank lines can be left out
+ * of the index without storing lengths.
+ */
+
+struct line_index_args {
+  char const *ptr;
+  size_t size;
+  uint64_t *starts;
+  size_t count;
+};
+
+struct mapped_file_nogvl_args {
+  mx_mapped_file *mf;
+  void *(*func)(void *);
+  void *arg;
+};
+
+static VALUE
+mapped_file_nogvl_body(VALUE ptr)
+{
+  struct mapped_file_nogvl_args *args = (struct mapped_file_nogvl_args *)ptr;
+  rb_thread_call_without_gvl(args->func, args->arg, NULL, NULL);
+  return Qnil;
+}
+
+static VALUE
+mapped_file_nogvl_ensure(VALUE ptr)
+{
+  struct mapped_file_nogvl_args *args = (struct mapped_file_nogvl_args *)ptr;
+  --args->mf->busy;
+  return Qnil;
+}
+
+/* Calls func without the GVL, keeping the mapping busy so that #close
+ * does not unmap it meanwhile.  A pending interrupt is raised before or
+ * after the call, and the busy count is restored in either case. */
+static void
+mapped_file_call_without_gvl(mx_mapped_file *mf, void *(*func)(void *), void *arg)
+{
+  struct mapped_file_nogvl_args args;
+
+  args.mf = mf;
+  args.func = func;
+  args.arg = arg;
+  ++mf->busy;
+  rb_ensure(mapped_file_nogvl_body, (VALUE)&args, mapped_file_nogvl_ensure, (VALUE)&args);
+}
+
+static int
+line_is_blank(char const *p, char const *end)
+{
+  return p == end || (p + 1 == end && *p == '\r');
+}
+
+static void *
+mapped_file_scan_lines(void *ptr)
+{
+  struct line_index_args *args = (struct line_index_args *)ptr;
+  char const *p = args->ptr, *end = args->ptr + args->size;
+  size_t count = 0;
+
+  while (p < end) {
+    char const *nl = memchr(p, '\n', (size_t)(end - p));
+    char const *eol = nl ? nl : end;
+    if (!line_is_blank(p, eol)) {
+      if (args->starts) {
+        args->starts[count] = (uint64_t)(p - args->ptr);
+      }
+      ++count;
+    }
+    p = eol + 1;
+  }
+  args->count = count;
+
+  return NULL;
+}
+
+/* Scans the mapping once and returns the offsets of its non-empty lines as
+ * a binary String of native uint64 values.  The scan runs without the GVL.
+ *
+ * @return [String] The line index.
+ */
+static VALUE
+mapped_file_line_index(VALUE obj)
+{
+  mx_mapped_file *mf;
+  struct line_index_args args;
+  VALUE index;
+
+  mf = get_opened_mapped_file(obj);
+  args.ptr = mf->ptr;
+  args.size = mf->size;
+  args.starts = NULL;
+
+  /* The first pass counts lines and the second fills the index. */
+  mapped_file_call_without_gvl(mf, mapped_file_scan_lines, &args);
+  index = rb_str_new(NULL, (long)(args.count * sizeof(uint64_t)));
+  args.starts = (uint64_t *)RSTRING_PTR(index);
+  mapped_file_call_without_gvl(mf, mapped_file_scan_lines, &args);
+
+  return index;
+}
+
+static char const *
+mapped_file_line_end(mx_mapped_file *mf, size_t start)
+{
+  char const *p = mf->ptr + start, *end = mf->ptr + mf->size;
+  char const *nl = memchr(p, '\n', (size_t)(end - p));
+  if (nl == NULL) {
+    nl = end;
+  }
+  if (nl > p && nl[-1] == '\r') {
+    --nl;
+  }
+  return nl;
+}
+
+/* Returns the line starting at the given offset, without its line
+ * terminator.
+ */
+static VALUE
+mapped_file_read_line(VALUE obj, VALUE offset_v)
+{
+  mx_mapped_file *mf;
+  size_t offset;
+  char const *eol;
+
+  mf = get_opened_mapped_file(obj);
+  offset = NUM2SIZET(offset_v);
+  mapped_file_check_range(mf, offset, 0);
+  eol = mapped_file_line_end(mf, offset);
+
+  return rb_str_new(mf->ptr + offset, (long)(eol - (mf->ptr + offset)));
+}
+
+enum {
+  PARSE_OK = 0,
+  PARSE_MISSING_COLUMN,
+  PARSE_INVALID_NUMBER,
+  PARSE_EMPTY_FIELD,
+  PARSE_OUT_OF_RANGE,
+};
+
+/* The minimum number of rows given to each thread.  Smaller batches are
+ * parsed on the calling thread, as creating threads costs more than
+ * parsing them. */
+#define PARSE_LINES_MIN_ROWS_PER_THREAD 4096
+
+struct parse_lines_job {
+  mx_mapped_file *mf;
+  size_t const *starts;
+  size_t begin, end;
+  int const *column_map;
+  int max_column;
+  size_t num_columns;
+  char delimiter;
+  int dtype_id;
+  size_t elsize;
+  char *out;
+  int error;
+  size_t error_row;
+  int error_column;
+};
+
+static int
+parse_field(char const *p, char const *end, double *value)
+{
+  char buf[64], *endp;
+  size_t len;
+
+  while (p < end && (*p == ' ' || *p == '\t')) ++p;
+  while (end > p && (end[-1] == ' ' || end[-1] == '\t')) --end;
+  if (end - p >= 2 && *p == '"' && end[-1] == '"') {
+    ++p;
+    --end;
+  }
+  if (p == end) {
+    *value = NAN;
+    return 1;
+  }
+
+  len = (size_t)(end - p);
+  if (len >= sizeof(buf)) {
+    return 0;
+  }
+  memcpy(buf, p, len);
+  buf[len] = '\0';
+  *value = strtod(buf, &endp);
+
+  return endp == buf + len;
+}
+
+static void *
+parse_lines_worker(void *ptr)
+{
+  struct parse_lines_job *job = (struct parse_lines_job *)ptr;
+  size_t row;
+
+  for (row = job->begin; row < job->end; ++row) {
+    char const *p = job->mf->ptr + job->starts[row];
+    char const *eol = mapped_file_line_end(job->mf, job->starts[row]);
+    char *dst = job->out + row * job->num_columns * job->elsize;
+    int column = 0;
+
+    while (column <= job->max_column) {
+      char const *q = memchr(p, job->delimiter, (size_t)(eol - p));
+      char const *field_end = q ? q : eol;
+      int pos = job->column_map[column];
+      if (pos >= 0) {
+        double v;
+        if (!parse_field(p, field_end, &v)) {
+          job->error = PARSE_INVALID_NUMBER;
+          goto error;
+        }
+        if (mxnet_dtype_store_double(dst + pos * job->elsize, job->dtype_id, v) != STORE_DOUBLE_OK) {
+          job->error = isnan(v) ? PARSE_EMPTY_FIELD : PARSE_OUT_OF_RANGE;
+          goto error;
+        }
+      }
+      ++column;
+      if (q == NULL) {
+        break;
+      }
+      p = q + 1;
+    }
+    if (column <= job->max_column) {
+      job->error = PARSE_MISSING_COLUMN;
+      goto error;
+    }
+    continue;
+
+  error:
+    job->error_row = row;
+    job->error_column = column;
+    return NULL;
+  }
+
+  return NULL;
+}
+
+struct parse_lines_args {
+  struct parse_lines_job *jobs;
+  int num_threads;
+};
+
+static void *
+parse_lines_run(void *ptr)
+{
+  struct parse_lines_args *args = (struct parse_lines_args *)ptr;
+  struct parse_lines_job *jobs = args->jobs;
+  int num_threads = args->num_threads, i;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_t *threads = (pthread_t *)alloca(sizeof(pthread_t) * num_threads);
+  int *started = (int *)alloca(sizeof(int) * num_threads);
+
+  for (i = 1; i < num_threads; ++i) {
+    started[i] = pthread_create(&threads[i], NULL, parse_lines_worker, &jobs[i]) == 0;
+    if (!started[i]) {
+      parse_lines_worker(&jobs[i]);
+    }
+  }
+  parse_lines_worker(&jobs[0]);
+  for (i = 1; i < num_threads; ++i) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+#else
+  for (i = 0; i < num_threads; ++i) {
+    parse_lines_worker(&jobs[i]);
+  }
+#endif
+
+  return NULL;
+}
+
+/* Parses delimited numeric columns of the given lines into an NDArray.
+ *
+ * Row +i+ of +ndarray+ receives the +columns+ of the line at
+ * <tt>index[indices[i]]</tt>, where +index+ is a String returned by
+ * #line_index.  Empty fields become NaN, and raise ArgumentError for an
+ * integer dtype as well as values out of its range.  Quoted fields are
+ * unquoted, but must not contain the delimiter.
+ *
+ * The lines are split among up to +num_threads+ native threads, each of
+ * which parses at least PARSE_LINES_MIN_ROWS_PER_THREAD lines, into one
+ * host buffer without the GVL.  The buffer is then copied to +ndarray+ at
+ * once.
+ *
+ * @param ndarray [NDArray] The destination of shape <tt>[indices.length, columns.length]</tt>.
+ * @param index [String] A line index.
+ * @param indices [Array<Integer>] Indices into the line index.
+ * @param columns [Array<Integer>] Zero-based column numbers to be stored.
+ * @param delimiter [String] The field delimiter, a single byte.
+ * @param num_threads [Integer] The number of threads.
+ * @return [NDArray] +ndarray+.
+ */
+static VALUE
+mapped_file_parse_lines(VALUE obj, VALUE ndarray, VALUE index, VALUE indices,
+                        VALUE columns, VALUE delimiter, VALUE num_threads_v)
+{
+  mx_mapped_file *mf;
+  NDArrayHandle handle;
+  mx_uint ndim, i;
+  mx_uint const *shape;
+  int dtype_id, max_column = -1, num_threads, t;
+  size_t num_rows, num_columns, num_lines, num_elements = 1, elsize, chunk;
+  uint64_t const *line_starts;
+  size_t *starts;
+  int *column_map;
+  struct parse_lines_job *jobs;
+  struct parse_lines_args args;
+  long j;
+  VALUE starts_buf, column_buf, out_buf, jobs_buf;
+
+  mf = get_opened_mapped_file(obj);
+  mxnet_check_ndarray(ndarray);
+  StringValue(index);
+  indices = rb_convert_type(indices, T_ARRAY, "Array", "to_ary");
+  columns = rb_convert_type(columns, T_ARRAY, "Array", "to_ary");
+  StringValue(delimiter);
+  if (RSTRING_LEN(delimiter) != 1) {
+    rb_raise(rb_eArgError, "delimiter must be a single byte");
+  }
+  num_threads = NUM2INT(num_threads_v);
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+
+  num_rows = (size_t)RARRAY_LEN(indices);
+  num_columns = (size_t)RARRAY_LEN(columns);
+  if (num_rows == 0 || num_columns == 0) {
+    return ndarray;
+  }
+
+  handle = mxnet_ndarray_get_handle(ndarray);
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape));
+  CHECK_CALL(MXNET_API(MXNDArrayGetDType)(handle, &dtype_id));
+  for (i = 0; i < ndim; ++i) {
+    num_elements *= shape[i];
+  }
+  if (num_elements != num_rows * num_columns) {
+    rb_raise(rb_eArgError, "the size of NDArray (%"PRIuSIZE") does not match %"PRIuSIZE" rows of %"PRIuSIZE" columns",
+             num_elements, num_rows, num_columns);
+  }
+  if (dtype_id == kFloat16) {
+    rb_raise(rb_eArgError, "parsing into float16 is unsupported");
+  }
+  elsize = mxnet_dtype_size(dtype_id);
+
+  for (j = 0; j < RARRAY_LEN(columns); ++j) {
+    int c = NUM2INT(RARRAY_AREF(columns, j));
+    if (c < 0) {
+      rb_raise(rb_eArgError, "negative column number: %d", c);
+    }
+    if (c > max_column) {
+      max_column = c;
+    }
+  }
+  column_buf = rb_str_tmp_new((long)(sizeof(int) * (max_column + 1)));
+  column_map = (int *)RSTRING_PTR(column_buf);
+  for (t = 0; t <= max_column; ++t) {
+    column_map[t] = -1;
+  }
+  for (j = 0; j < RARRAY_LEN(columns); ++j) {
+    column_map[NUM2INT(RARRAY_AREF(columns, j))] = (int)j;
+  }
+
+  num_lines = (size_t)RSTRING_LEN(index) / sizeof(uint64_t);
+  line_starts = (uint64_t const *)RSTRING_PTR(index);
+  starts_buf = rb_str_tmp_new((long)(sizeof(size_t) * num_rows));
+  starts = (size_t *)RSTRING_PTR(starts_buf);
+  for (j = 0; j < RARRAY_LEN(indices); ++j) {
+    long k = NUM2LONG(RARRAY_AREF(indices, j));
+    if (k < 0 || (size_t)k >= num_lines) {
+      rb_raise(rb_eIndexError, "line %ld is out of range for %"PRIuSIZE" lines", k, num_lines);
+    }
+    starts[j] = (size_t)line_starts[k];
+    mapped_file_check_range(mf, starts[j], 0);
+  }
+
+  out_buf = rb_str_tmp_new((long)(num_elements * elsize));
+
+  if ((size_t)num_threads > num_rows / PARSE_LINES_MIN_ROWS_PER_THREAD) {
+    num_threads = (int)(num_rows / PARSE_LINES_MIN_ROWS_PER_THREAD);
+    if (num_threads < 1) {
+      num_threads = 1;
+    }
+  }
+  chunk = (num_rows + num_threads - 1) / num_threads;
+  jobs_buf = rb_str_tmp_new((long)(sizeof(struct parse_lines_job) * num_threads));
+  jobs = (struct parse_lines_job *)RSTRING_PTR(jobs_buf);
+  for (t = 0; t < num_threads; ++t) {
+    struct parse_lines_job *job = &jobs[t];
+    job->mf = mf;
+    job->starts = starts;
+    job->begin = chunk * t;
+    job->end = job->begin + chunk < num_rows ? job->begin + chunk : num_rows;
+    job->column_map = column_map;
+    job->max_column = max_column;
+    job->num_columns = num_columns;
+    job->delimiter = RSTRING_PTR(delimiter)[0];
+    job->dtype_id = dtype_id;
+    job->elsize = elsize;
+    job->out = RSTRING_PTR(out_buf);
+    job->error = PARSE_OK;
+    job->error_row = 0;
+    job->error_column = 0;
+  }
+  args.jobs = jobs;
+  args.num_threads = num_threads;
+
+  mapped_file_call_without_gvl(mf, parse_lines_run, &args);
+
+  for (t = 0; t < num_threads; ++t) {
+    if (jobs[t].error != PARSE_OK) {
+      long line = NUM2LONG(RARRAY_AREF(indices, (long)jobs[t].error_row));
+      switch (jobs[t].error) {
+        case PARSE_MISSING_COLUMN:
+          rb_raise(rb_eArgError, "line %ld has only %d columns", line, jobs[t].error_column);
+        case PARSE_EMPTY_FIELD:
+          rb_raise(rb_eArgError, "line %ld has an empty field in column %d, which %"PRIsVALUE" cannot hold",
+                   line, jobs[t].error_column, mxnet_dtype_id2name(dtype_id));
+        case PARSE_OUT_OF_RANGE:
+          rb_raise(rb_eArgError, "line %ld has a value out of the range of %"PRIsVALUE" in column %d",
+                   line, mxnet_dtype_id2name(dtype_id), jobs[t].error_column);
+        default:
+          break;
+      }
+      rb_raise(rb_eArgError, "line %ld has an invalid number in column %d", line, jobs[t].error_column);
+    }
+  }
+
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, RSTRING_PTR(out_buf), num_elements));
+  RB_GC_GUARD(index);
+  RB_GC_GUARD(column_buf);
+  RB_GC_GUARD(starts_buf);
+  RB_GC_GUARD(out_buf);
+  RB_GC_GUARD(jobs_buf);
+
+  return ndarray;
+}
+
+void
+mxnet_init_mapped_file(void)
+{
+  VALUE cMappedFile;
+
+  cMappedFile = rb_define_class_under(mxnet_mMXNet, "MappedFile", rb_cObject);
+  rb_define_alloc_func(cMappedFile, mapped_file_allocate);
+  rb_define_private_method(cMappedFile, "initialize", mapped_file_initialize, 1);
+  rb_define_method(cMappedFile, "size", mapped_file_size, 0);
+  rb_define_method(cMappedFile, "close", mapped_file_close, 0);
+  rb_define_method(cMappedFile, "closed?", mapped_file_closed_p, 0);
+  rb_define_method(cMappedFile, "read", mapped_file_read, 2);
+  rb_define_method(cMappedFile, "copy_to", mapped_file_copy_to, 4);
+  rb_define_method(cMappedFile, "line_index", mapped_file_line_index, 0);
+  rb_define_method(cMappedFile, "read_line", mapped_file_read_line, 1);
+  rb_define_method(cMappedFile, "parse_lines", mapped_file_parse_lines, 6);
+  rb_define_attr(cMappedFile, "path", 1, 0);
+
+  mxnet_cMappedFile = cMappedFile;
+}
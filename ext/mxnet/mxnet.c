@@ -128,8 +128,15 @@ Init_mxnet(void)
   mxnet_init_executor();
 
   mxnet_init_io();
+  mxnet_init_mapped_file();
+  mxnet_init_recordio();
+  mxnet_init_image();
+  mxnet_init_profiler();
+  mxnet_init_op_stats();
+  mxnet_init_engine();
 
   mxnet_init_ndarray();
+  mxnet_init_ndarray_batch();
   mxnet_init_operations(mxnet_cNDArray);
 
   mxnet_init_symbol();
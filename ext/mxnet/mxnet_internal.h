@@ -78,11 +78,26 @@ typedef void *ExecutorHandle;
 typedef void *DataIterCreator;
 typedef void *DataIterHandle;
 typedef void *NDArrayHandle;
+typedef void *ProfileHandle;
+typedef void *RecordIOHandle;
 typedef void *SymbolHandle;
+typedef void (*ExecutorMonitorCallback)(const char *name,
+                                        NDArrayHandle handle,
+                                        void *callback_handle);
+typedef const void *ContextHandle;
+typedef const void *EngineFnPropertyHandle;
+typedef void (*EngineSyncFunc)(void *run_context, void *func_param);
+typedef void (*EngineFuncParamDeleter)(void *func_param);
 
 #define NUM2MXUINT(num) NUM2UINT(num)
 #define MXUINT2NUM(val) UINT2NUM(val)
 
+/* An entry of the features returned by MXLibInfoFeatures. */
+struct LibFeature {
+  const char *name;
+  bool enabled;
+};
+
 enum DTypeID {
   kFloat32 = 0,
   kFloat64 = 1,
@@ -122,10 +137,19 @@ struct mxnet_api_table {
                            NDArrayHandle *aux_states,
                            ExecutorHandle shared_exec,
                            ExecutorHandle *out);
+  int (* MXExecutorSetMonitorCallback)(ExecutorHandle handle,
+                                       ExecutorMonitorCallback callback,
+                                       void *callback_handle);
+  /* optional: MXExecutorSetMonitorCallbackEX is unavailable before MXNet 1.4 */
+  int (* MXExecutorSetMonitorCallbackEX)(ExecutorHandle handle,
+                                         ExecutorMonitorCallback callback,
+                                         void *callback_handle,
+                                         bool monitor_all);
 
   int (* MXNDArrayCreateEx)(const mx_uint *shape, mx_uint ndim,
                             int dev_type, int dev_id, int delay_alloc,
                             int dtype, NDArrayHandle *out);
+  int (* MXNDArrayCreateNone)(NDArrayHandle *out);
   int (* MXNDArrayFree)(NDArrayHandle handle);
   int (* MXNDArraySave)(const char *fname, mx_uint num_args,
                         NDArrayHandle *args, const char **keys);
@@ -147,6 +171,7 @@ struct mxnet_api_table {
   int (* MXNDArraySlice)(NDArrayHandle handle, mx_uint start, mx_uint stop, NDArrayHandle *out);
   int (* MXNDArrayGetGrad)(NDArrayHandle handle, NDArrayHandle *out);
   int (* MXNDArrayWaitToRead)(NDArrayHandle handle);
+  int (* MXNDArrayWaitAll)(void);
 
   int (* MXAutogradSetIsRecording)(int is_recording, int* prev);
   int (* MXAutogradSetIsTraining)(int is_training, int* prev);
@@ -227,6 +252,7 @@ struct mxnet_api_table {
                           const char **keys,
                           void **args);
   int (* MXSymbolCopy)(SymbolHandle symbol, SymbolHandle *out);
+  int (* MXSymbolGetInternals)(SymbolHandle symbol, SymbolHandle *out);
   int (* MXSymbolCreateVariable)(const char *name, void **out);
   int (* MXSymbolGetName)(SymbolHandle symbol,
                           const char** out,
@@ -295,6 +321,65 @@ struct mxnet_api_table {
   int (* MXSymbolSaveToFile)(SymbolHandle symbol, const char *fname);
   int (* MXSymbolSaveToJSON)(SymbolHandle symbol, const char **out_json);
 
+  int (* MXRecordIOWriterCreate)(const char *uri, RecordIOHandle *out);
+  int (* MXRecordIOWriterFree)(RecordIOHandle handle);
+  int (* MXRecordIOWriterWriteRecord)(RecordIOHandle handle,
+                                      const char *buf, size_t size);
+  int (* MXRecordIOWriterTell)(RecordIOHandle handle, size_t *pos);
+  int (* MXRecordIOReaderCreate)(const char *uri, RecordIOHandle *out);
+  int (* MXRecordIOReaderFree)(RecordIOHandle handle);
+  int (* MXRecordIOReaderReadRecord)(RecordIOHandle handle,
+                                     char const **buf, size_t *size);
+  int (* MXRecordIOReaderSeek)(RecordIOHandle handle, size_t pos);
+  /* optional: MXRecordIOReaderTell is unavailable in old versions */
+  int (* MXRecordIOReaderTell)(RecordIOHandle handle, size_t *pos);
+
+  /* optional: the profiler API is unavailable before MXNet 1.2 */
+  int (* MXSetProfilerConfig)(int num_params,
+                              const char *const *keys,
+                              const char *const *vals);
+  int (* MXSetProfilerState)(int state);
+  int (* MXDumpProfile)(int finished);
+  int (* MXAggregateProfileStatsPrint)(const char **out_str, int reset);
+  int (* MXProfilePause)(int paused);
+  int (* MXProfileCreateDomain)(const char *domain, ProfileHandle *out);
+  int (* MXProfileCreateTask)(ProfileHandle domain,
+                              const char *task_name,
+                              ProfileHandle *out);
+  int (* MXProfileCreateFrame)(ProfileHandle domain,
+                               const char *frame_name,
+                               ProfileHandle *out);
+  int (* MXProfileCreateEvent)(const char *event_name, ProfileHandle *out);
+  int (* MXProfileCreateCounter)(ProfileHandle domain,
+                                 const char *counter_name,
+                                 ProfileHandle *out);
+  int (* MXProfileDestroyHandle)(ProfileHandle handle);
+  int (* MXProfileDurationStart)(ProfileHandle duration_handle);
+  int (* MXProfileDurationStop)(ProfileHandle duration_handle);
+  int (* MXProfileSetCounter)(ProfileHandle counter_handle, uint64_t value);
+  int (* MXProfileAdjustCounter)(ProfileHandle counter_handle, int64_t delta);
+  int (* MXProfileSetMarker)(ProfileHandle domain,
+                             const char *instant_marker_name,
+                             const char *scope);
+
+  /* optional: MXSetNumOMPThreads is unavailable before MXNet 1.0 */
+  int (* MXSetNumOMPThreads)(int thread_num);
+  /* optional: MXLibInfoFeatures is unavailable before MXNet 1.5 */
+  int (* MXLibInfoFeatures)(const struct LibFeature **lib_features, size_t *size);
+  /* optional: MXEngineSetBulkSize is unavailable before MXNet 1.3 */
+  int (* MXEngineSetBulkSize)(int bulk_size, int *prev_bulk_size);
+  /* optional: MXEnginePushSyncND is unavailable before MXNet 1.5 */
+  int (* MXEnginePushSyncND)(EngineSyncFunc sync_func, void *func_param,
+                             EngineFuncParamDeleter deleter, ContextHandle ctx_handle,
+                             NDArrayHandle *const_nds_handle, int num_const_nds,
+                             NDArrayHandle *mutable_nds_handle, int num_mutable_nds,
+                             EngineFnPropertyHandle prop_handle, int priority,
+                             const char *opr_name);
+  /* optional: MXStorageEmptyCache is unavailable before MXNet 1.5 */
+  int (* MXStorageEmptyCache)(int dev_type, int dev_id);
+  /* optional: MXGetGPUMemoryInformation64 is unavailable before MXNet 1.4 */
+  int (* MXGetGPUMemoryInformation64)(int dev, uint64_t *free_mem, uint64_t *total_mem);
+
   int (* MXCreateCachedOpEx)(SymbolHandle symbol,
                              int num_flags,
                              const char **keys,
@@ -321,6 +406,12 @@ void mxnet_set_handle(VALUE obj, VALUE handle_v);
 VALUE mxnet_dtype_id2name(int dtype_id);
 int mxnet_dtype_name2id(VALUE dtype_name);
 VALUE mxnet_dtype_name(VALUE id_or_name);
+size_t mxnet_dtype_size(int dtype_id);
+
+#define STORE_DOUBLE_UNSUPPORTED 0
+#define STORE_DOUBLE_OK 1
+#define STORE_DOUBLE_OUT_OF_RANGE -1
+int mxnet_dtype_store_double(char *dst, int dtype_id, double v);
 
 VALUE mxnet_grad_req_map(void);
 
@@ -332,7 +423,11 @@ void mxnet_executor_set_aux_arrays(VALUE obj, VALUE aux_states);
 void mxnet_check_type(VALUE obj, VALUE klass);
 
 VALUE mxnet_ndarray_new(NDArrayHandle ndarray_handle);
+VALUE mxnet_ndarray_new_untracked(NDArrayHandle ndarray_handle);
+void mxnet_ndarray_track(VALUE obj);
+void mxnet_ndarray_rebind(VALUE obj, NDArrayHandle ndarray_handle);
 NDArrayHandle mxnet_ndarray_get_handle(VALUE obj);
+NDArrayHandle mxnet_ndarray_get_handle_raw(VALUE obj);
 VALUE mxnet_ndarray_get_shape(VALUE obj);
 
 VALUE mxnet_symbol_new(SymbolHandle mxsymbol_handle);
@@ -340,12 +435,35 @@ VALUE mxnet_symbol_list_outputs(VALUE obj);
 
 CachedOpHandle mxnet_cached_op_get_handle(VALUE obj);
 
+extern int mxnet_op_stats_enabled;
+uint64_t mxnet_op_stats_clock(void);
+void mxnet_op_stats_record(void *op_handle, uint64_t start_ns,
+                           NDArrayHandle *inputs, int num_inputs);
+void mxnet_op_stats_record_elapsed(void *op_handle, uint64_t elapsed,
+                                   NDArrayHandle *inputs, int num_inputs);
+
+extern int mxnet_ndarray_batch_depth;
+VALUE mxnet_ndarray_batch_current(void);
+void mxnet_ndarray_batch_resolve(NDArrayHandle handle);
+void mxnet_ndarray_batch_flush(void);
+VALUE mxnet_ndarray_batch_record(VALUE batch, void *op_handle,
+                                 VALUE ndargs, NDArrayHandle *inputs, int num_inputs,
+                                 char const **params_keys, char const **params_vals, int num_params,
+                                 VALUE out, NDArrayHandle *outputs, int num_outputs);
+
 void mxnet_init_libmxnet(void);
 void mxnet_init_autograd(void);
 void mxnet_init_cached_op(void);
 void mxnet_init_executor(void);
 void mxnet_init_io(void);
+void mxnet_init_mapped_file(void);
+void mxnet_init_recordio(void);
+void mxnet_init_image(void);
+void mxnet_init_profiler(void);
+void mxnet_init_op_stats(void);
+void mxnet_init_engine(void);
 void mxnet_init_ndarray(void);
+void mxnet_init_ndarray_batch(void);
 void mxnet_init_symbol(void);
 void mxnet_init_operations(VALUE klass);
 void mxnet_init_random(void);
@@ -1,5 +1,17 @@
 #include "mxnet_internal.h"
 
+#include <ruby/debug.h>
+#include <ruby/thread.h>
+#ifdef HAVE_RUBY_FIBER_SCHEDULER_H
+# include <ruby/fiber/scheduler.h>
+#endif
+
+#include <errno.h>
+#include <unistd.h>
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
 VALUE mxnet_cNDArray;
 
 static size_t dtype_sizes[NUMBER_OF_DTYPE_IDS];
@@ -93,15 +105,348 @@ mxnet_dtype_is_available(VALUE dtype)
   return 0 <= dtype_id && dtype_id < NUMBER_OF_DTYPE_IDS;
 }
 
+size_t
+mxnet_dtype_size(int dtype_id)
+{
+  if (0 <= dtype_id && dtype_id < NUMBER_OF_DTYPE_IDS) {
+    return dtype_sizes[dtype_id];
+  }
+
+  return 0;
+}
+
+/* Stores v as dtype_id.  Converting NaN or a value out of the range of
+ * an integer type is undefined behaviour, so it is rejected as well as
+ * float16, which has no C type.  This does not need the GVL. */
+int
+mxnet_dtype_store_double(char *dst, int dtype_id, double v)
+{
+  switch (dtype_id) {
+    case kFloat32: *(float *)dst = (float)v; return STORE_DOUBLE_OK;
+    case kFloat64: *(double *)dst = v; return STORE_DOUBLE_OK;
+    case kUint8:
+      if (!(v > -1.0 && v < 256.0)) return STORE_DOUBLE_OUT_OF_RANGE;
+      *(uint8_t *)dst = (uint8_t)v;
+      return STORE_DOUBLE_OK;
+    case kInt32:
+      if (!(v > -2147483649.0 && v < 2147483648.0)) return STORE_DOUBLE_OUT_OF_RANGE;
+      *(int32_t *)dst = (int32_t)v;
+      return STORE_DOUBLE_OK;
+    case kInt8:
+      if (!(v > -129.0 && v < 128.0)) return STORE_DOUBLE_OUT_OF_RANGE;
+      *(int8_t *)dst = (int8_t)v;
+      return STORE_DOUBLE_OK;
+    case kInt64:
+      if (!(v >= -9223372036854775808.0 && v < 9223372036854775808.0)) return STORE_DOUBLE_OUT_OF_RANGE;
+      *(int64_t *)dst = (int64_t)v;
+      return STORE_DOUBLE_OK;
+  }
+  return STORE_DOUBLE_UNSUPPORTED;
+}
+
 static VALUE
 dtype_m_available_p(VALUE mod, VALUE dtype)
 {
   return mxnet_dtype_is_available(dtype) ? Qtrue : Qfalse;
 }
 
+/* Census of live NDArrays.
+ *
+ * While tracking, every handle wrapped by mxnet_ndarray_new is recorded
+ * with its size, context, dtype, and the Ruby location that created it,
+ * and removed when the wrapper is freed.  The table is allocated by plain
+ * malloc, because the wrappers are freed in GC, which may run inside any
+ * allocation of Ruby's heap.  When not tracking, the table is NULL, and
+ * the wrappers pay a single check of it.
+ */
+
+struct census_entry {
+  NDArrayHandle handle;
+  ID site;
+  uint64_t bytes;
+  int dev_type;
+  int dev_id;
+  int dtype;
+};
+
+#define CENSUS_INITIAL_CAPA 1024
+#define CENSUS_MAX_FRAMES 32
+
+static struct census_entry *census_entries = NULL;
+static size_t census_capa = 0;
+static size_t census_size = 0;
+static VALUE census_lib_dir = Qnil;
+
+static size_t
+census_hash(NDArrayHandle handle)
+{
+  uint64_t h = (uint64_t)(uintptr_t)handle;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (size_t)h & (census_capa - 1);
+}
+
+static size_t
+census_find(NDArrayHandle handle)
+{
+  size_t i = census_hash(handle);
+  while (census_entries[i].handle != NULL && census_entries[i].handle != handle) {
+    i = (i + 1) & (census_capa - 1);
+  }
+  return i;
+}
+
+static int
+census_grow(void)
+{
+  struct census_entry *old_entries = census_entries;
+  size_t old_capa = census_capa, i;
+
+  census_entries = calloc(2 * old_capa, sizeof(struct census_entry));
+  if (census_entries == NULL) {
+    census_entries = old_entries;
+    return 0;
+  }
+  census_capa = 2 * old_capa;
+  for (i = 0; i < old_capa; ++i) {
+    if (old_entries[i].handle != NULL) {
+      census_entries[census_find(old_entries[i].handle)] = old_entries[i];
+    }
+  }
+  free(old_entries);
+  return 1;
+}
+
+/* Returns the first caller location outside of this library. */
+static ID
+census_capture_site(void)
+{
+  VALUE frames[CENSUS_MAX_FRAMES];
+  int lines[CENSUS_MAX_FRAMES];
+  int n, i;
+
+  n = rb_profile_frames(0, CENSUS_MAX_FRAMES, frames, lines);
+  for (i = 0; i < n; ++i) {
+    VALUE path = rb_profile_frame_path(frames[i]);
+    if (NIL_P(path) || RSTRING_LEN(path) == 0 || RSTRING_PTR(path)[0] == '<') {
+      continue;
+    }
+    if (!NIL_P(census_lib_dir) &&
+        RSTRING_LEN(path) > RSTRING_LEN(census_lib_dir) &&
+        memcmp(RSTRING_PTR(path), RSTRING_PTR(census_lib_dir), RSTRING_LEN(census_lib_dir)) == 0) {
+      continue;
+    }
+    return rb_intern_str(rb_sprintf("%"PRIsVALUE":%d", path, lines[i]));
+  }
+  return rb_intern("(unknown)");
+}
+
+static void
+census_track(NDArrayHandle handle)
+{
+  struct census_entry entry;
+  mx_uint ndim, i;
+  const mx_uint *shape;
+  size_t pos;
+
+  if (handle == NULL) {
+    return;
+  }
+
+  /* This may run GC, which may remove entries. */
+  entry.site = census_capture_site();
+
+  entry.handle = handle;
+  entry.bytes = 0;
+  entry.dtype = -1;
+  entry.dev_type = entry.dev_id = -1;
+  if (MXNET_API(MXNDArrayGetDType)(handle, &entry.dtype) == 0 &&
+      MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape) == 0) {
+    entry.bytes = mxnet_dtype_size(entry.dtype);
+    for (i = 0; i < ndim; ++i) {
+      entry.bytes *= shape[i];
+    }
+  }
+  MXNET_API(MXNDArrayGetContext)(handle, &entry.dev_type, &entry.dev_id);
+
+  if (census_entries == NULL) {
+    return;
+  }
+  pos = census_find(handle);
+  if (census_entries[pos].handle == NULL) {
+    if (2 * (census_size + 1) > census_capa) {
+      if (!census_grow()) {
+        return;
+      }
+      pos = census_find(handle);
+    }
+    ++census_size;
+  }
+  census_entries[pos] = entry;
+}
+
+static void
+census_untrack(NDArrayHandle handle)
+{
+  size_t i, j, k, mask;
+
+  if (handle == NULL) {
+    return;
+  }
+  i = census_find(handle);
+  if (census_entries[i].handle == NULL) {
+    return;
+  }
+  census_entries[i].handle = NULL;
+  --census_size;
+
+  /* Shifts back the following entries of the probe sequence. */
+  mask = census_capa - 1;
+  for (j = (i + 1) & mask; census_entries[j].handle != NULL; j = (j + 1) & mask) {
+    k = census_hash(census_entries[j].handle);
+    if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+      census_entries[i] = census_entries[j];
+      census_entries[j].handle = NULL;
+      i = j;
+    }
+  }
+}
+
+/* Starts recording the NDArrays created from now on.
+ *
+ * @param lib_dir [String] Locations under this directory are skipped when
+ *   looking for the allocation site.
+ */
+static VALUE
+memory_s_start_tracking(VALUE mod, VALUE lib_dir)
+{
+  census_lib_dir = rb_str_new_frozen(StringValue(lib_dir));
+  if (census_entries == NULL) {
+    census_entries = calloc(CENSUS_INITIAL_CAPA, sizeof(struct census_entry));
+    if (census_entries == NULL) {
+      rb_memerror();
+    }
+    census_capa = CENSUS_INITIAL_CAPA;
+    census_size = 0;
+  }
+  return Qnil;
+}
+
+/* Stops recording and discards the records. */
+static VALUE
+memory_s_stop_tracking(VALUE mod)
+{
+  struct census_entry *entries = census_entries;
+
+  census_entries = NULL;
+  census_capa = census_size = 0;
+  free(entries);
+  return Qnil;
+}
+
+static VALUE
+memory_s_tracking_p(VALUE mod)
+{
+  return census_entries != NULL ? Qtrue : Qfalse;
+}
+
+/* Returns the records of the live NDArrays as an Array of
+ * [site, dev_type, dev_id, dtype_id, bytes].
+ */
+static VALUE
+memory_s_census_records(VALUE mod)
+{
+  struct census_entry *copy;
+  size_t capa, i;
+  VALUE result;
+
+  if (census_entries == NULL) {
+    return rb_ary_new();
+  }
+
+  /* Copies the table first, as building the result may run GC. */
+  capa = census_capa;
+  copy = malloc(sizeof(struct census_entry) * capa);
+  if (copy == NULL) {
+    rb_memerror();
+  }
+  MEMCPY(copy, census_entries, struct census_entry, capa);
+
+  result = rb_ary_new_capa((long)census_size);
+  for (i = 0; i < capa; ++i) {
+    if (copy[i].handle == NULL) {
+      continue;
+    }
+    rb_ary_push(result, rb_ary_new_from_args(5,
+          rb_id2str(copy[i].site),
+          INT2NUM(copy[i].dev_type),
+          INT2NUM(copy[i].dev_id),
+          INT2NUM(copy[i].dtype),
+          ULL2NUM(copy[i].bytes)));
+  }
+  free(copy);
+
+  return result;
+}
+
+struct release_cached_args {
+  int dev_type;
+  int dev_id;
+};
+
+static void *
+memory_release_cached(void *ptr)
+{
+  struct release_cached_args *args = (struct release_cached_args *)ptr;
+  int status;
+
+  /* Pending operations may still hold buffers to be returned to the pool. */
+  status = MXNET_API(MXNDArrayWaitAll)();
+  if (status == 0) {
+    status = MXNET_API(MXStorageEmptyCache)(args->dev_type, args->dev_id);
+  }
+  return (void *)(intptr_t)status;
+}
+
+/* Waits for all the pending operations, and releases the free buffers
+ * the storage pool of the given device keeps, without holding the GVL.
+ */
+static VALUE
+memory_s_release_cached(VALUE mod, VALUE dev_type, VALUE dev_id)
+{
+  struct release_cached_args args;
+  void *ret;
+
+  if (MXNET_API(MXStorageEmptyCache) == NULL) {
+    rb_raise(rb_eNotImpError, "MXStorageEmptyCache is unavailable in the loaded libmxnet");
+  }
+  args.dev_type = NUM2INT(dev_type);
+  args.dev_id = NUM2INT(dev_id);
+  ret = rb_thread_call_without_gvl(memory_release_cached, &args, NULL, NULL);
+  CHECK_CALL((int)(intptr_t)ret);
+  return Qnil;
+}
+
+/* Returns [free, total] bytes of the memory of a GPU. */
+static VALUE
+memory_s_gpu_memory_info(VALUE mod, VALUE dev_id)
+{
+  uint64_t free_mem, total_mem;
+
+  if (MXNET_API(MXGetGPUMemoryInformation64) == NULL) {
+    rb_raise(rb_eNotImpError, "MXGetGPUMemoryInformation64 is unavailable in the loaded libmxnet");
+  }
+  CHECK_CALL(MXNET_API(MXGetGPUMemoryInformation64)(NUM2INT(dev_id), &free_mem, &total_mem));
+  return rb_assoc_new(ULL2NUM(free_mem), ULL2NUM(total_mem));
+}
+
 static void
 ndarray_free(void *ptr)
 {
+  if (census_entries != NULL) {
+    census_untrack((NDArrayHandle)ptr);
+  }
   if (ptr != NULL) {
     CHECK_CALL(MXNET_API(MXNDArrayFree)((NDArrayHandle)ptr));
   }
@@ -125,6 +470,20 @@ static const rb_data_type_t ndarray_data_type = {
 
 NDArrayHandle
 mxnet_ndarray_get_handle(VALUE obj)
+{
+  NDArrayHandle handle;
+  TypedData_Get_Struct(obj, void, &ndarray_data_type, handle);
+  if (mxnet_ndarray_batch_depth > 0) {
+    /* Submits the batch if the array is an output not computed yet. */
+    mxnet_ndarray_batch_resolve(handle);
+  }
+  return handle;
+}
+
+/* Returns the handle of obj without resolving it, for recording an
+ * operation into NDArray.batch. */
+NDArrayHandle
+mxnet_ndarray_get_handle_raw(VALUE obj)
 {
   NDArrayHandle handle;
   TypedData_Get_Struct(obj, void, &ndarray_data_type, handle);
@@ -137,14 +496,53 @@ ndarray_allocate(VALUE klass)
   return TypedData_Wrap_Struct(klass, &ndarray_data_type, NULL);
 }
 
+/* Wraps an output handle without going through `initialize`, as NDArray
+ * has no Ruby-level initializer to run. */
 VALUE
 mxnet_ndarray_new(NDArrayHandle ndarray_handle)
 {
-  VALUE obj = rb_class_new_instance(0, NULL, mxnet_cNDArray);
-  DATA_PTR(obj) = ndarray_handle;
+  VALUE obj = TypedData_Wrap_Struct(mxnet_cNDArray, &ndarray_data_type, ndarray_handle);
+  if (census_entries != NULL) {
+    census_track(ndarray_handle);
+  }
   return obj;
 }
 
+/* Wraps a handle which does not hold data yet, such as an output of an
+ * operation deferred by NDArray.batch.  mxnet_ndarray_track registers it
+ * to the census once the data is there. */
+VALUE
+mxnet_ndarray_new_untracked(NDArrayHandle ndarray_handle)
+{
+  return TypedData_Wrap_Struct(mxnet_cNDArray, &ndarray_data_type, ndarray_handle);
+}
+
+void
+mxnet_ndarray_track(VALUE obj)
+{
+  if (census_entries != NULL) {
+    census_track(mxnet_ndarray_get_handle_raw(obj));
+  }
+}
+
+/* Replaces the handle wrapped by obj, and releases the previous one.
+ * This lets steady-state loops reuse a wrapper object for a new output. */
+void
+mxnet_ndarray_rebind(VALUE obj, NDArrayHandle ndarray_handle)
+{
+  NDArrayHandle old_handle;
+
+  old_handle = mxnet_ndarray_get_handle(obj);
+  DATA_PTR(obj) = ndarray_handle;
+  if (census_entries != NULL && old_handle != ndarray_handle) {
+    census_untrack(old_handle);
+    census_track(ndarray_handle);
+  }
+  if (old_handle != NULL && old_handle != ndarray_handle) {
+    CHECK_CALL(MXNET_API(MXNDArrayFree)(old_handle));
+  }
+}
+
 static NDArrayHandle
 ndarray_allocate_handle(VALUE shape_v, VALUE ctx_v, VALUE delay_alloc, VALUE dtype_v)
 {
@@ -581,6 +979,7 @@ ndarray_backward(int argc, VALUE *argv, VALUE obj)
     }
   }
 
+  mxnet_ndarray_batch_flush();
   self_handle = mxnet_ndarray_get_handle(obj);
   CHECK_CALL(MXNET_API(MXAutogradBackwardEx)(
         1, &self_handle, &ograd_handle,
@@ -727,30 +1126,712 @@ ndarray_to_a(VALUE obj)
   return ary;
 }
 
+/* Stacks variable-length samples into +out+, padding the first axis of each
+ * sample up to <tt>out.shape[1]</tt> with +pad_val+.
+ *
+ * The batch is assembled in one host buffer and uploaded with a single copy.
+ * A sample is an NDArray of the same dtype as +out+, whose shape is
+ * <tt>[length, *out.shape[2..-1]]</tt>, or an Array of numbers when +out+ is
+ * two-dimensional.
+ */
 static VALUE
-ndarray_wait_to_read(VALUE obj)
+ndarray_s_pad_stack(VALUE klass, VALUE out, VALUE samples, VALUE pad_val)
+{
+  NDArrayHandle handle;
+  mx_uint ndim, i;
+  mx_uint const *shape_ptr;
+  mx_uint *shape;
+  int dtype_id;
+  size_t batch_size, max_length, row_size = 1, slot_size, elsize, k;
+  double pad;
+  char *buf;
+  long j;
+  VALUE buf_str;
+
+  mxnet_check_ndarray(out);
+  samples = rb_convert_type(samples, T_ARRAY, "Array", "to_ary");
+  pad = NUM2DBL(pad_val);
+
+  handle = mxnet_ndarray_get_handle(out);
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape_ptr));
+  CHECK_CALL(MXNET_API(MXNDArrayGetDType)(handle, &dtype_id));
+  /* The shape buffer is reused by the next MXNDArrayGetShape. */
+  shape = ALLOCA_N(mx_uint, ndim);
+  MEMCPY(shape, shape_ptr, mx_uint, ndim);
+  if (ndim < 2 || shape[0] != (mx_uint)RARRAY_LEN(samples)) {
+    rb_raise(rb_eArgError, "the shape of out does not match %ld samples", RARRAY_LEN(samples));
+  }
+  batch_size = shape[0];
+  max_length = shape[1];
+  for (i = 2; i < ndim; ++i) {
+    row_size *= shape[i];
+  }
+  slot_size = max_length * row_size;
+  elsize = mxnet_dtype_size(dtype_id);
+
+  buf_str = rb_str_tmp_new((long)(batch_size * slot_size * elsize));
+  buf = RSTRING_PTR(buf_str);
+  if (pad == 0.0) {
+    memset(buf, 0, batch_size * slot_size * elsize);
+  }
+  else {
+    switch (mxnet_dtype_store_double(buf, dtype_id, pad)) {
+      case STORE_DOUBLE_UNSUPPORTED:
+        rb_raise(rb_eArgError, "padding float16 with a non-zero value is unsupported");
+      case STORE_DOUBLE_OUT_OF_RANGE:
+        rb_raise(rb_eRangeError, "pad value %g is out of the range of %"PRIsVALUE,
+                 pad, mxnet_dtype_id2name(dtype_id));
+    }
+    for (k = 1; k < batch_size * slot_size; ++k) {
+      memcpy(buf + k * elsize, buf, elsize);
+    }
+  }
+
+  for (j = 0; j < RARRAY_LEN(samples); ++j) {
+    VALUE sample = RARRAY_AREF(samples, j);
+    char *dst = buf + j * slot_size * elsize;
+
+    if (RB_TYPE_P(sample, T_ARRAY)) {
+      long n = RARRAY_LEN(sample), m;
+      if (ndim != 2) {
+        rb_raise(rb_eArgError, "sample %ld must be an NDArray of %u dimensions", j, ndim - 1);
+      }
+      if ((size_t)n > max_length) {
+        rb_raise(rb_eArgError, "sample %ld is longer than %"PRIuSIZE, j, max_length);
+      }
+      for (m = 0; m < n; ++m) {
+        double v = NUM2DBL(RARRAY_AREF(sample, m));
+        switch (mxnet_dtype_store_double(dst + m * elsize, dtype_id, v)) {
+          case STORE_DOUBLE_UNSUPPORTED:
+            rb_raise(rb_eArgError, "Array samples cannot be stored as float16");
+          case STORE_DOUBLE_OUT_OF_RANGE:
+            rb_raise(rb_eRangeError, "value %g of sample %ld is out of the range of %"PRIsVALUE,
+                     v, j, mxnet_dtype_id2name(dtype_id));
+        }
+      }
+    }
+    else {
+      NDArrayHandle sample_handle;
+      mx_uint sample_ndim;
+      mx_uint const *sample_shape;
+      int sample_dtype_id;
+      size_t sample_size;
+
+      mxnet_check_ndarray(sample);
+      sample_handle = mxnet_ndarray_get_handle(sample);
+      CHECK_CALL(MXNET_API(MXNDArrayGetShape)(sample_handle, &sample_ndim, &sample_shape));
+      CHECK_CALL(MXNET_API(MXNDArrayGetDType)(sample_handle, &sample_dtype_id));
+      if (sample_dtype_id != dtype_id) {
+        rb_raise(rb_eArgError, "sample %ld has a different dtype from out", j);
+      }
+      if (sample_ndim != ndim - 1 || sample_shape[0] > max_length) {
+        rb_raise(rb_eArgError, "sample %ld has an incompatible shape", j);
+      }
+      for (i = 1; i < sample_ndim; ++i) {
+        if (sample_shape[i] != shape[i + 1]) {
+          rb_raise(rb_eArgError, "sample %ld has an incompatible shape", j);
+        }
+      }
+      sample_size = sample_shape[0] * row_size;
+      if (sample_size > 0) {
+        CHECK_CALL(MXNET_API(MXNDArraySyncCopyToCPU)(sample_handle, dst, sample_size));
+      }
+    }
+  }
+
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, buf, batch_size * slot_size));
+  RB_GC_GUARD(buf_str);
+
+  return out;
+}
+
+/* A function pushed to the engine after the pending writes to an array,
+ * which marks its completion, and queues its ID for the dispatcher of
+ * NDArray#on_ready if it is a notification.
+ *
+ * It is shared by the engine, which drops its reference in the deleter,
+ * by the caller, and by the notification queue until the ID is taken.
+ */
+struct ndarray_completion {
+  int refcnt;
+  int done;
+  int notify;
+  uint64_t id;
+  struct ndarray_completion *next;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+#endif
+};
+
+/* The layout of mxnet::Context. */
+struct engine_context {
+  int dev_type;
+  int32_t dev_id;
+};
+
+/* The notifications completed by the engine and not taken yet.
+ *
+ * The engine threads must neither block nor drop an ID, so the IDs are
+ * queued here, and the pipe of the dispatcher only carries wakeup bytes.
+ * A byte is written when the queue becomes non-empty; if the pipe is
+ * full, the dispatcher has bytes to read and drains the queue anyway.
+ */
+static struct {
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_t lock;
+#endif
+  pid_t pid;
+  int fd;
+  struct ndarray_completion *head, *tail;
+} notifications;
+
+static ID id_ready_completion;
+
+static void
+notifications_lock(void)
 {
-  NDArrayHandle *handle;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&notifications.lock);
+#endif
+}
+
+static void
+notifications_unlock(void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock(&notifications.lock);
+#endif
+}
+
+static void
+notifications_reset(void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init(&notifications.lock, NULL);
+#endif
+  notifications.pid = getpid();
+  notifications.fd = -1;
+  notifications.head = notifications.tail = NULL;
+}
+
+/* Queues a finished completion, which holds a reference for the queue. */
+static void
+notifications_push(struct ndarray_completion *c)
+{
+  static const char wakeup = 0;
+  ssize_t n;
+  int was_empty;
+
+  notifications_lock();
+  c->next = NULL;
+  was_empty = notifications.head == NULL;
+  if (notifications.tail != NULL) {
+    notifications.tail->next = c;
+  }
+  else {
+    notifications.head = c;
+  }
+  notifications.tail = c;
+  if (was_empty && notifications.fd >= 0) {
+    /* EAGAIN is ignored, see above. */
+    do {
+      n = write(notifications.fd, &wakeup, 1);
+    } while (n < 0 && errno == EINTR);
+  }
+  notifications_unlock();
+}
+
+static void
+ndarray_completion_release(struct ndarray_completion *c)
+{
+  int refcnt;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&c->lock);
+  refcnt = --c->refcnt;
+  pthread_mutex_unlock(&c->lock);
+  if (refcnt == 0) {
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->lock);
+    free(c);
+  }
+#else
+  refcnt = --c->refcnt;
+  if (refcnt == 0) {
+    free(c);
+  }
+#endif
+}
+
+/* Marks the completion done, once. */
+static void
+ndarray_completion_finish(struct ndarray_completion *c)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&c->lock);
+#endif
+  if (!c->done) {
+    c->done = 1;
+    if (c->notify) {
+      ++c->refcnt;
+      notifications_push(c);
+    }
+#ifdef HAVE_PTHREAD_H
+    pthread_cond_broadcast(&c->cond);
+#endif
+  }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock(&c->lock);
+#endif
+}
+
+static int
+ndarray_completion_done_p(struct ndarray_completion *c)
+{
+  int done;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&c->lock);
+  done = c->done;
+  pthread_mutex_unlock(&c->lock);
+#else
+  done = c->done;
+#endif
+  return done;
+}
+
+static void
+ndarray_completion_run(void *run_context, void *func_param)
+{
+  ndarray_completion_finish((struct ndarray_completion *)func_param);
+}
+
+/* The engine skips the function when a pending write has failed, but
+ * still deletes it, so the deleter finishes the completion as well.
+ */
+static void
+ndarray_completion_delete(void *func_param)
+{
+  struct ndarray_completion *c = (struct ndarray_completion *)func_param;
+
+  ndarray_completion_finish(c);
+  ndarray_completion_release(c);
+}
+
+/* Initializes a completion with two references, one for the engine or
+ * the thread finishing it, and one for the caller.
+ */
+static void
+ndarray_completion_init(struct ndarray_completion *c, int notify, uint64_t id)
+{
+  c->refcnt = 2;
+  c->done = 0;
+  c->notify = notify;
+  c->id = id;
+  c->next = NULL;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init(&c->lock, NULL);
+  pthread_cond_init(&c->cond, NULL);
+#endif
+}
+
+/* kAsync of mxnet::FnProperty.  The engine runs such a function in the
+ * pushing thread when the array has no pending writes, and never holds it
+ * back in a bulk of operations.
+ */
+static const int engine_fn_property_async = 4;
+
+/* Pushes a completion after the pending writes to +obj+, with one
+ * reference kept for the caller, who has to release it.
+ */
+static struct ndarray_completion *
+ndarray_push_completion(VALUE obj, int notify, uint64_t id)
+{
+  struct ndarray_completion *c;
+  struct engine_context ctx;
+  NDArrayHandle handle;
+  int status;
+
+  if (MXNET_API(MXEnginePushSyncND) == NULL) {
+    rb_raise(rb_eNotImpError, "MXEnginePushSyncND is unavailable in the loaded libmxnet");
+  }
 
   handle = mxnet_ndarray_get_handle(obj);
-  CHECK_CALL(MXNET_API(MXNDArrayWaitToRead)(handle));
+  CHECK_CALL(MXNET_API(MXNDArrayGetContext)(handle, &ctx.dev_type, &ctx.dev_id));
+
+  c = malloc(sizeof(struct ndarray_completion));
+  if (c == NULL) {
+    rb_memerror();
+  }
+  ndarray_completion_init(c, notify, id);
+
+  status = MXNET_API(MXEnginePushSyncND)(ndarray_completion_run, c, ndarray_completion_delete,
+                                         &ctx, &handle, 1, NULL, 0,
+                                         (EngineFnPropertyHandle)&engine_fn_property_async, 0,
+                                         "RubyNDArrayCompletion");
+  if (status != 0) {
+    /* Whether the engine has dropped its reference is unknown, so only
+     * ours is released, at the cost of leaking the completion. */
+    ndarray_completion_release(c);
+    CHECK_CALL(status);
+  }
+  RB_GC_GUARD(obj);
+  return c;
+}
+
+static void
+ndarray_completion_wrapper_free(void *ptr)
+{
+  if (ptr != NULL) {
+    ndarray_completion_release((struct ndarray_completion *)ptr);
+  }
+}
+
+static const rb_data_type_t ndarray_completion_data_type = {
+  "MXNet::NDArray::Completion",
+  {
+    NULL,
+    ndarray_completion_wrapper_free,
+    NULL,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+/* Returns true if the array has no pending writes.  This never blocks.
+ *
+ * libmxnet cannot be asked about the state of an array, so each call
+ * pushes a completion after the pending writes, which the engine runs at
+ * once when there are none.  While a completion is pending, the later
+ * calls only read its flag.
+ */
+static VALUE
+ndarray_ready_p(VALUE obj)
+{
+  struct ndarray_completion *c;
+  VALUE wrapper;
+
+  wrapper = rb_ivar_get(obj, id_ready_completion);
+  if (NIL_P(wrapper)) {
+    wrapper = TypedData_Wrap_Struct(0, &ndarray_completion_data_type, NULL);
+    rb_ivar_set(obj, id_ready_completion, wrapper);
+  }
+  c = (struct ndarray_completion *)DATA_PTR(wrapper);
+  if (c != NULL) {
+    if (!ndarray_completion_done_p(c)) {
+      return Qfalse;
+    }
+    DATA_PTR(wrapper) = NULL;
+    ndarray_completion_release(c);
+  }
+
+  c = ndarray_push_completion(obj, 0, 0);
+  if (ndarray_completion_done_p(c)) {
+    ndarray_completion_release(c);
+    return Qtrue;
+  }
+  DATA_PTR(wrapper) = c;
+  return Qfalse;
+}
 
+/* Pushes a completion which queues +id+ for NDArray._take_notifications
+ * after the pending writes to the array.
+ */
+static VALUE
+ndarray_push_notification(VALUE obj, VALUE id)
+{
+  ndarray_completion_release(ndarray_push_completion(obj, 1, NUM2ULL(id)));
+  return obj;
+}
+
+static void *
+ndarray_wait_to_read_nogvl(void *ptr)
+{
+  return (void *)(intptr_t)MXNET_API(MXNDArrayWaitToRead)((NDArrayHandle)ptr);
+}
+
+static void *
+ndarray_wait_all_nogvl(void *ptr)
+{
+  return (void *)(intptr_t)MXNET_API(MXNDArrayWaitAll)();
+}
+
+#ifdef HAVE_PTHREAD_H
+struct ndarray_wait_args {
+  struct ndarray_completion *c;
+  int interrupted;
+};
+
+static void *
+ndarray_wait_completion_nogvl(void *ptr)
+{
+  struct ndarray_wait_args *args = (struct ndarray_wait_args *)ptr;
+
+  pthread_mutex_lock(&args->c->lock);
+  while (!args->c->done && !args->interrupted) {
+    pthread_cond_wait(&args->c->cond, &args->c->lock);
+  }
+  pthread_mutex_unlock(&args->c->lock);
+  return NULL;
+}
+
+static void
+ndarray_wait_completion_unblock(void *ptr)
+{
+  struct ndarray_wait_args *args = (struct ndarray_wait_args *)ptr;
+
+  pthread_mutex_lock(&args->c->lock);
+  args->interrupted = 1;
+  pthread_cond_broadcast(&args->c->cond);
+  pthread_mutex_unlock(&args->c->lock);
+}
+
+/* Waits for the completion without the GVL, handling the interrupts which
+ * wake the thread up, so Thread#raise and Thread#kill stop the wait.
+ */
+static void
+ndarray_wait_completion_loop(struct ndarray_wait_args *args)
+{
+  while (!ndarray_completion_done_p(args->c)) {
+    args->interrupted = 0;
+    rb_thread_call_without_gvl(ndarray_wait_completion_nogvl, args,
+                               ndarray_wait_completion_unblock, args);
+    rb_thread_check_ints();
+  }
+}
+
+static VALUE
+ndarray_wait_completion_body(VALUE arg)
+{
+  ndarray_wait_completion_loop((struct ndarray_wait_args *)arg);
   return Qnil;
 }
 
+static VALUE
+ndarray_wait_completion_ensure(VALUE arg)
+{
+  ndarray_completion_release(((struct ndarray_wait_args *)arg)->c);
+  return Qnil;
+}
+
+/* A thread running MXNDArrayWaitAll, which cannot be interrupted, for a
+ * waiter who can stop waiting for it.  The completion is the first member,
+ * so that releasing it frees the whole.
+ */
+struct wait_all_thread {
+  struct ndarray_completion c;
+  int status;
+  char error[4096];
+};
+
+static void *
+wait_all_thread_main(void *ptr)
+{
+  struct wait_all_thread *w = (struct wait_all_thread *)ptr;
+
+  w->status = MXNET_API(MXNDArrayWaitAll)();
+  if (w->status != 0) {
+    snprintf(w->error, sizeof(w->error), "%s", MXNET_API(MXGetLastError)());
+  }
+  ndarray_completion_finish(&w->c);
+  ndarray_completion_release(&w->c);
+  return NULL;
+}
+
+static VALUE
+wait_all_thread_body(VALUE arg)
+{
+  struct ndarray_wait_args *args = (struct ndarray_wait_args *)arg;
+  struct wait_all_thread *w = (struct wait_all_thread *)args->c;
+
+  ndarray_wait_completion_loop(args);
+  return w->status != 0 ? rb_str_new_cstr(w->error) : Qnil;
+}
+#endif /* HAVE_PTHREAD_H */
+
+/* Waits until the pending writes to the array complete, without holding
+ * the GVL, and raises the error of a failed one.
+ */
+static void
+ndarray_wait_for(VALUE obj)
+{
+  NDArrayHandle handle;
+  void *ret;
+
+  handle = mxnet_ndarray_get_handle(obj);
+#ifdef HAVE_PTHREAD_H
+  if (MXNET_API(MXEnginePushSyncND) != NULL) {
+    struct ndarray_wait_args args;
+
+    args.c = ndarray_push_completion(obj, 0, 0);
+    args.interrupted = 0;
+    rb_ensure(ndarray_wait_completion_body, (VALUE)&args,
+              ndarray_wait_completion_ensure, (VALUE)&args);
+    /* The writes have completed, so this only reports their error. */
+    CHECK_CALL(MXNET_API(MXNDArrayWaitToRead)(handle));
+    RB_GC_GUARD(obj);
+    return;
+  }
+#endif
+  ret = rb_thread_call_without_gvl(ndarray_wait_to_read_nogvl, handle, NULL, NULL);
+  CHECK_CALL((int)(intptr_t)ret);
+  RB_GC_GUARD(obj);
+}
+
+/* Waits until all the pending operations complete, without holding the
+ * GVL.
+ */
+static void
+ndarray_wait_all_operations(void)
+{
+  void *ret;
+
+#ifdef HAVE_PTHREAD_H
+  struct wait_all_thread *w;
+  struct ndarray_wait_args args;
+  pthread_t thread;
+  VALUE error;
+
+  w = malloc(sizeof(struct wait_all_thread));
+  if (w == NULL) {
+    rb_memerror();
+  }
+  ndarray_completion_init(&w->c, 0, 0);
+  w->status = 0;
+  w->error[0] = '\0';
+  if (pthread_create(&thread, NULL, wait_all_thread_main, w) == 0) {
+    pthread_detach(thread);
+    args.c = &w->c;
+    args.interrupted = 0;
+    error = rb_ensure(wait_all_thread_body, (VALUE)&args,
+                      ndarray_wait_completion_ensure, (VALUE)&args);
+    if (!NIL_P(error)) {
+      rb_exc_raise(rb_exc_new_str(mxnet_eError, error));
+    }
+    return;
+  }
+  /* Without a thread, the wait cannot be interrupted. */
+  ndarray_completion_release(&w->c);
+  ndarray_completion_release(&w->c);
+#endif
+  ret = rb_thread_call_without_gvl(ndarray_wait_all_nogvl, NULL, NULL, NULL);
+  CHECK_CALL((int)(intptr_t)ret);
+}
+
+/* Waits until the pending writes to the array complete, without holding
+ * the GVL.  Under a Fiber scheduler, other fibers run while waiting.
+ */
+static VALUE
+ndarray_wait_to_read(VALUE obj)
+{
+#ifdef HAVE_RUBY_FIBER_SCHEDULER_H
+  if (!NIL_P(rb_fiber_scheduler_current())) {
+    return rb_funcall(obj, rb_intern("_wait_with_scheduler"), 0);
+  }
+#endif
+
+  ndarray_wait_for(obj);
+  return Qnil;
+}
+
+/* The same as #wait_to_read, but blocks the thread even under a Fiber
+ * scheduler.
+ */
+static VALUE
+ndarray_wait_to_read_blocking(VALUE obj)
+{
+  ndarray_wait_for(obj);
+  return Qnil;
+}
+
+/* Waits until the pending writes to the given arrays complete, or all the
+ * pending operations when +arrays+ is nil, without holding the GVL.
+ *
+ * @param arrays [Array<NDArray>, nil] The arrays to wait for.
+ */
+static VALUE
+ndarray_s_wait_all(int argc, VALUE *argv, VALUE klass)
+{
+  VALUE arrays;
+  long i;
+
+  rb_scan_args(argc, argv, "01", &arrays);
+
+  if (NIL_P(arrays)) {
+    ndarray_wait_all_operations();
+    return Qnil;
+  }
+
+  arrays = rb_check_array_type(arrays);
+  if (NIL_P(arrays)) {
+    rb_raise(rb_eTypeError, "arrays must be an Array of NDArrays");
+  }
+  for (i = 0; i < RARRAY_LEN(arrays); ++i) {
+    mxnet_check_ndarray(RARRAY_AREF(arrays, i));
+  }
+  for (i = 0; i < RARRAY_LEN(arrays); ++i) {
+    ndarray_wait_for(RARRAY_AREF(arrays, i));
+  }
+
+  RB_GC_GUARD(arrays);
+  return Qnil;
+}
+
+/* Sets the write end of the pipe of the dispatcher.  In a child process,
+ * the queue is reset, as it holds the notifications of the parent, and
+ * its lock may be held by a thread which does not exist in the child.
+ */
+static VALUE
+ndarray_s_set_notification_fd(VALUE klass, VALUE fd)
+{
+  if (notifications.pid != getpid()) {
+    notifications_reset();
+  }
+  notifications_lock();
+  notifications.fd = NUM2INT(fd);
+  notifications_unlock();
+  return fd;
+}
+
+/* Takes the IDs of the completed notifications, in the completion order. */
+static VALUE
+ndarray_s_take_notifications(VALUE klass)
+{
+  struct ndarray_completion *c, *next;
+  VALUE ids;
+
+  notifications_lock();
+  c = notifications.head;
+  notifications.head = notifications.tail = NULL;
+  notifications_unlock();
+
+  ids = rb_ary_new();
+  for (; c != NULL; c = next) {
+    uint64_t id = c->id;
+    next = c->next;
+    ndarray_completion_release(c);
+    rb_ary_push(ids, ULL2NUM(id));
+  }
+  return ids;
+}
+
 void
 mxnet_init_ndarray(void)
 {
-  VALUE cNDArray, mDType;
+  VALUE cNDArray, mMemory, mDType;
 
   cNDArray = rb_const_get_at(mxnet_mMXNet, rb_intern("NDArray"));
 
+  id_ready_completion = rb_intern("__ready_completion__");
+  notifications_reset();
+
   rb_define_alloc_func(cNDArray, ndarray_allocate);
   rb_undef_method(CLASS_OF(cNDArray), "new");
 
   rb_define_singleton_method(cNDArray, "empty", ndarray_s_empty, -1);
   rb_define_singleton_method(cNDArray, "save", ndarray_s_save, 2);
   rb_define_singleton_method(cNDArray, "load", ndarray_s_load, 1);
+  rb_define_singleton_method(cNDArray, "_pad_stack", ndarray_s_pad_stack, 3);
   /* TODO: rb_define_singleton_method(cNDArray, "load_from_buffer", ndarray_s_load_from_buffer, 1); */
 
   rb_define_method(cNDArray, "dtype", ndarray_get_dtype, 0);
@@ -760,15 +1841,30 @@ mxnet_init_ndarray(void)
   rb_define_method(cNDArray, "backward", ndarray_backward, -1);
   rb_define_method(cNDArray, "to_a", ndarray_to_a, 0);
   rb_define_method(cNDArray, "wait_to_read", ndarray_wait_to_read, 0);
+  rb_define_method(cNDArray, "ready?", ndarray_ready_p, 0);
+  rb_define_singleton_method(cNDArray, "wait_all", ndarray_s_wait_all, -1);
 
   rb_define_private_method(cNDArray, "__mxnet_handle__", ndarray_get_mxnet_handle, 0);
   rb_define_private_method(cNDArray, "_get_context_params", ndarray_get_context_params, 0);
   rb_define_private_method(cNDArray, "_at", ndarray_at, 1);
   rb_define_private_method(cNDArray, "_slice", ndarray_slice, 2);
   rb_define_private_method(cNDArray, "_attach_grad", ndarray_attach_grad, 2);
+  rb_define_private_method(cNDArray, "_wait_to_read_blocking", ndarray_wait_to_read_blocking, 0);
+  rb_define_private_method(cNDArray, "_push_notification", ndarray_push_notification, 1);
+  rb_define_singleton_method(cNDArray, "_set_notification_fd", ndarray_s_set_notification_fd, 1);
+  rb_define_singleton_method(cNDArray, "_take_notifications", ndarray_s_take_notifications, 0);
 
   mxnet_cNDArray = cNDArray;
 
+  mMemory = rb_const_get_at(mxnet_mMXNet, rb_intern("Memory"));
+  rb_define_singleton_method(mMemory, "_start_tracking", memory_s_start_tracking, 1);
+  rb_define_singleton_method(mMemory, "_stop_tracking", memory_s_stop_tracking, 0);
+  rb_define_singleton_method(mMemory, "tracking?", memory_s_tracking_p, 0);
+  rb_define_singleton_method(mMemory, "_census_records", memory_s_census_records, 0);
+  rb_define_singleton_method(mMemory, "_release_cached", memory_s_release_cached, 2);
+  rb_define_singleton_method(mMemory, "_gpu_memory_info", memory_s_gpu_memory_info, 1);
+  rb_gc_register_address(&census_lib_dir);
+
   mDType = rb_define_module_under(mxnet_mMXNet, "DType");
 
   rb_define_module_function(mDType, "id2name", dtype_m_id2name, 1);
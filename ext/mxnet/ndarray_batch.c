@@ -0,0 +1,580 @@
+#include "mxnet_internal.h"
+
+#include <ruby/thread.h>
+#include <string.h>
+
+/* A command buffer of NDArray.batch.
+ *
+ * While a batch is active in a fiber, imperative_invoke records each
+ * operation into the buffer of the batch instead of calling
+ * MXImperativeInvoke.  The handles of the inputs and the outputs, and the
+ * parameters copied into a string arena, are stored in flat arrays, so
+ * that the batch is submitted by a loop of MXImperativeInvoke calls
+ * without the GVL and without touching any Ruby object.
+ *
+ * An operation called without +out+ gets a placeholder created by
+ * MXNDArrayCreateNone as its output.  MXImperativeInvoke fills the given
+ * outputs in place, so the placeholder becomes the result when the batch
+ * is submitted, and can be an input of a later operation in the batch.
+ *
+ * The handles of the outputs are also kept in a hash set.  Taking the
+ * handle of an array with mxnet_ndarray_get_handle, as any method which
+ * reads it does, submits the batch first if the array is one of them, and
+ * the paths which run operations without recording them call
+ * mxnet_ndarray_batch_flush.
+ */
+
+struct batch_command {
+  void *op_handle;
+  int num_inputs;
+  int num_outputs;
+  int num_params;
+  int is_recording;
+  int is_training;
+  size_t handles_pos;   /* the inputs, followed by the outputs */
+  size_t params_pos;    /* the keys, followed by the values */
+};
+
+struct ndarray_batch {
+  struct batch_command *commands;
+  size_t num_commands, commands_capa;
+  NDArrayHandle *handles;
+  size_t num_handles, handles_capa;
+  size_t *params;       /* offsets in strings */
+  size_t num_params, params_capa;
+  char *strings;
+  size_t strings_size, strings_capa;
+  VALUE arrays;         /* keeps the inputs and the outputs alive */
+  VALUE pending;        /* the placeholders */
+  NDArrayHandle *outputs;  /* open addressing set of the output handles */
+  size_t num_outputs, outputs_capa;
+  int active;
+  int submitting;
+};
+
+int mxnet_ndarray_batch_depth;
+
+static VALUE cBatch;
+static ID id_current_batch;
+
+static void
+batch_mark(void *ptr)
+{
+  struct ndarray_batch *batch = ptr;
+
+  rb_gc_mark(batch->arrays);
+  rb_gc_mark(batch->pending);
+}
+
+static void
+batch_free(void *ptr)
+{
+  struct ndarray_batch *batch = ptr;
+
+  xfree(batch->commands);
+  xfree(batch->handles);
+  xfree(batch->params);
+  xfree(batch->strings);
+  xfree(batch->outputs);
+  xfree(batch);
+}
+
+static size_t
+batch_memsize(void const *ptr)
+{
+  struct ndarray_batch const *batch = ptr;
+
+  return sizeof(*batch)
+    + sizeof(struct batch_command) * batch->commands_capa
+    + sizeof(NDArrayHandle) * batch->handles_capa
+    + sizeof(size_t) * batch->params_capa
+    + batch->strings_capa
+    + sizeof(NDArrayHandle) * batch->outputs_capa;
+}
+
+static const rb_data_type_t batch_data_type = {
+  "MXNet::NDArray::Batch",
+  {
+    batch_mark,
+    batch_free,
+    batch_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static struct ndarray_batch *
+batch_get(VALUE obj)
+{
+  struct ndarray_batch *batch;
+  TypedData_Get_Struct(obj, struct ndarray_batch, &batch_data_type, batch);
+  return batch;
+}
+
+static VALUE
+batch_allocate(VALUE klass)
+{
+  struct ndarray_batch *batch;
+  VALUE obj;
+
+  obj = TypedData_Make_Struct(klass, struct ndarray_batch, &batch_data_type, batch);
+  batch->arrays = rb_ary_new();
+  batch->pending = rb_ary_new();
+  return obj;
+}
+
+/* Grows *ptr so that it has room for n more elements. */
+static void
+batch_reserve(void **ptr, size_t *capa, size_t size, size_t n, size_t elem_size)
+{
+  size_t new_capa;
+
+  if (size + n <= *capa) {
+    return;
+  }
+  new_capa = *capa > 0 ? *capa : 16;
+  while (new_capa < size + n) {
+    new_capa *= 2;
+  }
+  *ptr = ruby_xrealloc2(*ptr, new_capa, elem_size);
+  *capa = new_capa;
+}
+
+static void
+batch_push_string(struct ndarray_batch *batch, char const *str)
+{
+  size_t len = strlen(str) + 1;
+
+  batch_reserve((void **)&batch->strings, &batch->strings_capa, batch->strings_size, len, 1);
+  memcpy(batch->strings + batch->strings_size, str, len);
+  batch->params[batch->num_params++] = batch->strings_size;
+  batch->strings_size += len;
+}
+
+static void
+batch_push_arrays(struct ndarray_batch *batch, VALUE arrays)
+{
+  if (RB_TYPE_P(arrays, T_ARRAY)) {
+    rb_ary_cat(batch->arrays, RARRAY_CONST_PTR(arrays), RARRAY_LEN(arrays));
+  }
+  else {
+    rb_ary_push(batch->arrays, arrays);
+  }
+}
+
+static size_t
+batch_output_slot(NDArrayHandle const *set, size_t capa, NDArrayHandle handle)
+{
+  size_t mask = capa - 1;
+  size_t i = ((uintptr_t)handle >> 4) & mask;
+
+  while (set[i] != NULL && set[i] != handle) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+static void
+batch_add_output(struct ndarray_batch *batch, NDArrayHandle handle)
+{
+  size_t i;
+
+  /* Keeps the load factor at most 1/2. */
+  if (2 * (batch->num_outputs + 1) > batch->outputs_capa) {
+    NDArrayHandle *old = batch->outputs;
+    size_t old_capa = batch->outputs_capa;
+    size_t new_capa = old_capa > 0 ? 2 * old_capa : 64;
+
+    batch->outputs = ZALLOC_N(NDArrayHandle, new_capa);
+    batch->outputs_capa = new_capa;
+    for (i = 0; i < old_capa; ++i) {
+      if (old[i] != NULL) {
+        batch->outputs[batch_output_slot(batch->outputs, new_capa, old[i])] = old[i];
+      }
+    }
+    xfree(old);
+  }
+
+  i = batch_output_slot(batch->outputs, batch->outputs_capa, handle);
+  if (batch->outputs[i] == NULL) {
+    batch->outputs[i] = handle;
+    ++batch->num_outputs;
+  }
+}
+
+static int
+batch_has_output(struct ndarray_batch const *batch, NDArrayHandle handle)
+{
+  if (batch->num_outputs == 0) {
+    return 0;
+  }
+  return batch->outputs[batch_output_slot(batch->outputs, batch->outputs_capa, handle)] != NULL;
+}
+
+static void
+batch_reset(struct ndarray_batch *batch)
+{
+  batch->num_commands = 0;
+  batch->num_handles = 0;
+  batch->num_params = 0;
+  batch->strings_size = 0;
+  rb_ary_clear(batch->arrays);
+  rb_ary_clear(batch->pending);
+  if (batch->num_outputs > 0) {
+    MEMZERO(batch->outputs, NDArrayHandle, batch->outputs_capa);
+    batch->num_outputs = 0;
+  }
+}
+
+/* Returns the batch active in the current fiber, or nil. */
+VALUE
+mxnet_ndarray_batch_current(void)
+{
+  return rb_thread_local_aref(rb_thread_current(), id_current_batch);
+}
+
+/* Records an operation called by imperative_invoke into the batch, and
+ * returns the value of the operation: +out+, or the placeholder of the
+ * output if +out+ is nil.
+ */
+VALUE
+mxnet_ndarray_batch_record(VALUE obj, void *op_handle,
+                           VALUE ndargs, NDArrayHandle *inputs, int num_inputs,
+                           char const **params_keys, char const **params_vals, int num_params,
+                           VALUE out, NDArrayHandle *outputs, int num_outputs)
+{
+  struct ndarray_batch *batch;
+  struct batch_command *cmd;
+  NDArrayHandle placeholder;
+  bool is_recording, is_training;
+  VALUE result;
+  int i;
+
+  batch = batch_get(obj);
+  if (batch->submitting) {
+    rb_raise(rb_eRuntimeError, "the batch is being submitted");
+  }
+  if (!NIL_P(out) && num_outputs == 0) {
+    rb_raise(rb_eArgError, "no output arrays given");
+  }
+
+  CHECK_CALL(MXNET_API(MXAutogradIsRecording)(&is_recording));
+  CHECK_CALL(MXNET_API(MXAutogradIsTraining)(&is_training));
+
+  if (NIL_P(out)) {
+    CHECK_CALL(MXNET_API(MXNDArrayCreateNone)(&placeholder));
+    result = mxnet_ndarray_new_untracked(placeholder);
+    rb_ary_push(batch->pending, result);
+    outputs = &placeholder;
+    num_outputs = 1;
+  }
+  else {
+    result = out;
+  }
+
+  batch_reserve((void **)&batch->commands, &batch->commands_capa,
+                batch->num_commands, 1, sizeof(struct batch_command));
+  batch_reserve((void **)&batch->handles, &batch->handles_capa,
+                batch->num_handles, (size_t)num_inputs + num_outputs, sizeof(NDArrayHandle));
+  batch_reserve((void **)&batch->params, &batch->params_capa,
+                batch->num_params, 2 * (size_t)num_params, sizeof(size_t));
+
+  cmd = &batch->commands[batch->num_commands++];
+  cmd->op_handle = op_handle;
+  cmd->num_inputs = num_inputs;
+  cmd->num_outputs = num_outputs;
+  cmd->num_params = num_params;
+  cmd->is_recording = is_recording;
+  cmd->is_training = is_training;
+  cmd->handles_pos = batch->num_handles;
+  cmd->params_pos = batch->num_params;
+
+  for (i = 0; i < num_inputs; ++i) {
+    batch->handles[batch->num_handles++] = inputs[i];
+  }
+  for (i = 0; i < num_outputs; ++i) {
+    batch->handles[batch->num_handles++] = outputs[i];
+    batch_add_output(batch, outputs[i]);
+  }
+  for (i = 0; i < num_params; ++i) {
+    batch_push_string(batch, params_keys[i]);
+  }
+  for (i = 0; i < num_params; ++i) {
+    batch_push_string(batch, params_vals[i]);
+  }
+
+  batch_push_arrays(batch, ndargs);
+  batch_push_arrays(batch, result);
+  return result;
+}
+
+struct batch_submit_args {
+  struct ndarray_batch *batch;
+  char const **params;
+  uint64_t *elapsed;    /* NULL unless the op stats are enabled */
+  size_t num_done;
+  int status;
+};
+
+static void *
+batch_submit_nogvl(void *ptr)
+{
+  struct batch_submit_args *args = ptr;
+  struct ndarray_batch *batch = args->batch;
+  struct batch_command *cmd;
+  NDArrayHandle *outputs;
+  int num_outputs, prev;
+  int is_recording = -1, is_training = -1;
+  int saved_recording = -1, saved_training = -1;
+  uint64_t start_ns = 0;
+  size_t i;
+
+  args->status = 0;
+  for (i = 0; i < batch->num_commands; ++i) {
+    cmd = &batch->commands[i];
+
+    /* Each operation runs in the autograd mode it was called in. */
+    if (cmd->is_recording != is_recording) {
+      if (MXNET_API(MXAutogradSetIsRecording)(cmd->is_recording, &prev) != 0) {
+        args->status = -1;
+        break;
+      }
+      if (saved_recording < 0) {
+        saved_recording = prev;
+      }
+      is_recording = cmd->is_recording;
+    }
+    if (cmd->is_training != is_training) {
+      if (MXNET_API(MXAutogradSetIsTraining)(cmd->is_training, &prev) != 0) {
+        args->status = -1;
+        break;
+      }
+      if (saved_training < 0) {
+        saved_training = prev;
+      }
+      is_training = cmd->is_training;
+    }
+
+    outputs = &batch->handles[cmd->handles_pos + cmd->num_inputs];
+    num_outputs = cmd->num_outputs;
+    if (args->elapsed != NULL) {
+      start_ns = mxnet_op_stats_clock();
+    }
+    args->status = MXNET_API(MXImperativeInvoke)(
+        cmd->op_handle,
+        cmd->num_inputs, &batch->handles[cmd->handles_pos],
+        &num_outputs, &outputs,
+        cmd->num_params,
+        &args->params[cmd->params_pos],
+        &args->params[cmd->params_pos + cmd->num_params]);
+    if (args->elapsed != NULL) {
+      args->elapsed[i] = mxnet_op_stats_clock() - start_ns;
+    }
+    if (args->status != 0) {
+      break;
+    }
+  }
+  args->num_done = i;
+
+  /* Restoring the modes does not overwrite the error of the operation,
+   * as it succeeds. */
+  if (saved_recording >= 0) {
+    MXNET_API(MXAutogradSetIsRecording)(saved_recording, &prev);
+  }
+  if (saved_training >= 0) {
+    MXNET_API(MXAutogradSetIsTraining)(saved_training, &prev);
+  }
+  return NULL;
+}
+
+static VALUE
+batch_failure_message(struct ndarray_batch *batch, size_t index)
+{
+  char const *name, *description, *key_var_num_args, *return_type;
+  char const **arg_names, **arg_type_infos, **arg_descriptions;
+  mx_uint num_args;
+  VALUE message;
+
+  message = rb_str_new_cstr(MXNET_API(MXGetLastError)());
+  if (MXNET_API(MXSymbolGetAtomicSymbolInfo)(
+        batch->commands[index].op_handle, &name, &description, &num_args,
+        &arg_names, &arg_type_infos, &arg_descriptions,
+        &key_var_num_args, &return_type) != 0) {
+    name = "unknown";
+  }
+  rb_str_catf(message, " (in operation #%"PRIsVALUE" %s of the batch of %"PRIsVALUE")",
+              SIZET2NUM(index), name, SIZET2NUM(batch->num_commands));
+  return message;
+}
+
+/*
+ * Executes the operations recorded in the batch, and empties it.  The
+ * results of the operations can be used after this.
+ *
+ * @return [Batch] self
+ * @raise [MXNet::Error] when an operation fails.  The operations after it
+ *   are not executed, and their results remain empty.
+ */
+static VALUE
+batch_submit(VALUE obj)
+{
+  struct ndarray_batch *batch;
+  struct batch_submit_args args;
+  VALUE params_str, elapsed_str = Qnil, message = Qnil;
+  struct batch_command *cmd;
+  size_t i;
+
+  batch = batch_get(obj);
+  if (batch->submitting) {
+    rb_raise(rb_eRuntimeError, "the batch is being submitted");
+  }
+  if (batch->num_commands == 0) {
+    return obj;
+  }
+
+  params_str = rb_str_tmp_new(sizeof(char const *) * batch->num_params);
+  args.batch = batch;
+  args.params = (char const **)RSTRING_PTR(params_str);
+  for (i = 0; i < batch->num_params; ++i) {
+    args.params[i] = batch->strings + batch->params[i];
+  }
+  args.elapsed = NULL;
+  if (mxnet_op_stats_enabled) {
+    elapsed_str = rb_str_tmp_new(sizeof(uint64_t) * batch->num_commands);
+    args.elapsed = (uint64_t *)RSTRING_PTR(elapsed_str);
+  }
+
+  batch->submitting = 1;
+  rb_thread_call_without_gvl(batch_submit_nogvl, &args, NULL, NULL);
+  batch->submitting = 0;
+
+  if (args.status != 0) {
+    message = batch_failure_message(batch, args.num_done);
+  }
+  if (args.elapsed != NULL) {
+    for (i = 0; i < args.num_done; ++i) {
+      cmd = &batch->commands[i];
+      mxnet_op_stats_record_elapsed(cmd->op_handle, args.elapsed[i],
+                                    &batch->handles[cmd->handles_pos], cmd->num_inputs);
+    }
+  }
+  if (args.status == 0) {
+    for (i = 0; i < (size_t)RARRAY_LEN(batch->pending); ++i) {
+      mxnet_ndarray_track(RARRAY_AREF(batch->pending, i));
+    }
+  }
+
+  batch_reset(batch);
+  RB_GC_GUARD(params_str);
+  RB_GC_GUARD(elapsed_str);
+
+  if (!NIL_P(message)) {
+    rb_exc_raise(rb_exc_new_str(mxnet_eError, message));
+  }
+  return obj;
+}
+
+/* Submits the batch active in the current fiber if handle is an output
+ * of an operation recorded in it, so that the array can be read. */
+void
+mxnet_ndarray_batch_resolve(NDArrayHandle handle)
+{
+  VALUE obj = mxnet_ndarray_batch_current();
+  struct ndarray_batch *batch;
+
+  if (NIL_P(obj)) {
+    return;
+  }
+  batch = batch_get(obj);
+  if (!batch->submitting && batch_has_output(batch, handle)) {
+    batch_submit(obj);
+  }
+}
+
+/* Submits the batch active in the current fiber, before running
+ * operations which are not recorded into it. */
+void
+mxnet_ndarray_batch_flush(void)
+{
+  VALUE obj;
+  struct ndarray_batch *batch;
+
+  if (mxnet_ndarray_batch_depth == 0) {
+    return;
+  }
+  obj = mxnet_ndarray_batch_current();
+  if (NIL_P(obj)) {
+    return;
+  }
+  batch = batch_get(obj);
+  if (!batch->submitting && batch->num_commands > 0) {
+    batch_submit(obj);
+  }
+}
+
+/*
+ * Returns the number of the operations recorded in the batch and not
+ * submitted yet.
+ *
+ * @return [Integer]
+ */
+static VALUE
+batch_size(VALUE obj)
+{
+  return SIZET2NUM(batch_get(obj)->num_commands);
+}
+
+/* Makes the batch record the operations called in the current fiber. */
+static VALUE
+batch_activate(VALUE obj)
+{
+  struct ndarray_batch *batch = batch_get(obj);
+
+  if (batch->active) {
+    rb_raise(rb_eRuntimeError, "the batch is already active");
+  }
+  rb_thread_local_aset(rb_thread_current(), id_current_batch, obj);
+  batch->active = 1;
+  ++mxnet_ndarray_batch_depth;
+  return obj;
+}
+
+static VALUE
+batch_deactivate(VALUE obj)
+{
+  struct ndarray_batch *batch = batch_get(obj);
+
+  if (!batch->active) {
+    return obj;
+  }
+  if (mxnet_ndarray_batch_current() == obj) {
+    rb_thread_local_aset(rb_thread_current(), id_current_batch, Qnil);
+  }
+  batch->active = 0;
+  --mxnet_ndarray_batch_depth;
+  return obj;
+}
+
+/*
+ * Returns the batch active in the current fiber, or nil.
+ *
+ * @return [Batch, nil]
+ */
+static VALUE
+batch_s_current(VALUE klass)
+{
+  return mxnet_ndarray_batch_depth > 0 ? mxnet_ndarray_batch_current() : Qnil;
+}
+
+void
+mxnet_init_ndarray_batch(void)
+{
+  id_current_batch = rb_intern("__mxnet_ndarray_batch__");
+
+  cBatch = rb_define_class_under(mxnet_cNDArray, "Batch", rb_cObject);
+  rb_define_alloc_func(cBatch, batch_allocate);
+  rb_define_singleton_method(cBatch, "current", batch_s_current, 0);
+  rb_define_method(cBatch, "submit", batch_submit, 0);
+  rb_define_method(cBatch, "size", batch_size, 0);
+  rb_define_private_method(cBatch, "_activate", batch_activate, 0);
+  rb_define_private_method(cBatch, "_deactivate", batch_deactivate, 0);
+}
@@ -0,0 +1,303 @@
+#include "mxnet_internal.h"
+
+#include <time.h>
+#ifndef HAVE_CLOCK_GETTIME
+# include <sys/time.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
+/* Per-operator dispatch statistics.
+ *
+ * imperative_invoke and CachedOp#call record the number of calls, the
+ * time spent in the dispatching API call, and the total size of the
+ * input arrays, keyed by the operator handle.  The durations are counted
+ * in histograms whose i-th bucket holds [2**i, 2**(i+1)) nanoseconds.
+ *
+ * Each native thread records into its own table, so recording never
+ * takes a lock.  Recording and reading both happen with the GVL held,
+ * and the tables of exited threads are kept to preserve their counts.
+ */
+
+#define OP_STATS_NUM_BUCKETS 32
+#define OP_STATS_INITIAL_CAPA 64
+
+int mxnet_op_stats_enabled = 0;
+
+struct op_stats_entry {
+  void *key;
+  uint64_t calls;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t input_bytes;
+  uint64_t buckets[OP_STATS_NUM_BUCKETS];
+};
+
+struct op_stats_table {
+  struct op_stats_table *next;
+  size_t capa;
+  size_t size;
+  struct op_stats_entry *entries;
+};
+
+static struct op_stats_table *op_stats_tables = NULL;
+#ifdef HAVE_PTHREAD_H
+static pthread_key_t op_stats_table_key;
+static pthread_mutex_t op_stats_tables_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* The key of CachedOp invocations, which are counted together. */
+static char op_stats_cached_op_key;
+
+uint64_t
+mxnet_op_stats_clock(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+#endif
+}
+
+static struct op_stats_table *
+op_stats_current_table(void)
+{
+  struct op_stats_table *table;
+
+#ifdef HAVE_PTHREAD_H
+  table = pthread_getspecific(op_stats_table_key);
+#else
+  table = op_stats_tables;
+#endif
+  if (table != NULL) {
+    return table;
+  }
+
+  table = ALLOC(struct op_stats_table);
+  table->capa = OP_STATS_INITIAL_CAPA;
+  table->size = 0;
+  table->entries = ZALLOC_N(struct op_stats_entry, table->capa);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock(&op_stats_tables_lock);
+  table->next = op_stats_tables;
+  op_stats_tables = table;
+  pthread_mutex_unlock(&op_stats_tables_lock);
+  pthread_setspecific(op_stats_table_key, table);
+#else
+  table->next = NULL;
+  op_stats_tables = table;
+#endif
+  return table;
+}
+
+static size_t
+op_stats_hash(void *key, size_t capa)
+{
+  uint64_t h = (uint64_t)(uintptr_t)key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (size_t)h & (capa - 1);
+}
+
+static struct op_stats_entry *
+op_stats_find(struct op_stats_entry *entries, size_t capa, void *key)
+{
+  size_t i = op_stats_hash(key, capa);
+  while (entries[i].key != NULL && entries[i].key != key) {
+    i = (i + 1) & (capa - 1);
+  }
+  return &entries[i];
+}
+
+static void
+op_stats_grow(struct op_stats_table *table)
+{
+  struct op_stats_entry *entries;
+  size_t i, capa;
+
+  capa = table->capa * 2;
+  entries = ZALLOC_N(struct op_stats_entry, capa);
+  for (i = 0; i < table->capa; ++i) {
+    if (table->entries[i].key != NULL) {
+      *op_stats_find(entries, capa, table->entries[i].key) = table->entries[i];
+    }
+  }
+  xfree(table->entries);
+  table->entries = entries;
+  table->capa = capa;
+}
+
+static uint64_t
+op_stats_input_bytes(NDArrayHandle *inputs, int num_inputs)
+{
+  uint64_t total = 0;
+  int i;
+
+  for (i = 0; i < num_inputs; ++i) {
+    mx_uint ndim, j;
+    const mx_uint *shape;
+    int dtype_id;
+    uint64_t size;
+
+    if (MXNET_API(MXNDArrayGetShape)(inputs[i], &ndim, &shape) != 0 ||
+        MXNET_API(MXNDArrayGetDType)(inputs[i], &dtype_id) != 0) {
+      continue;
+    }
+    size = mxnet_dtype_size(dtype_id);
+    for (j = 0; j < ndim; ++j) {
+      size *= shape[j];
+    }
+    total += size;
+  }
+
+  return total;
+}
+
+/* Records a dispatch of the operator +op_handle+, or of a CachedOp when
+ * +op_handle+ is NULL, which started at +start_ns+ of mxnet_op_stats_clock.
+ */
+void
+mxnet_op_stats_record(void *op_handle, uint64_t start_ns,
+                      NDArrayHandle *inputs, int num_inputs)
+{
+  mxnet_op_stats_record_elapsed(op_handle, mxnet_op_stats_clock() - start_ns,
+                                inputs, num_inputs);
+}
+
+/* Records an operation whose time was measured by the caller. */
+void
+mxnet_op_stats_record_elapsed(void *op_handle, uint64_t elapsed,
+                              NDArrayHandle *inputs, int num_inputs)
+{
+  struct op_stats_table *table;
+  struct op_stats_entry *entry;
+  int bucket;
+  void *key;
+
+  key = op_handle != NULL ? op_handle : &op_stats_cached_op_key;
+
+  table = op_stats_current_table();
+  entry = op_stats_find(table->entries, table->capa, key);
+  if (entry->key == NULL) {
+    if (2 * (table->size + 1) > table->capa) {
+      op_stats_grow(table);
+      entry = op_stats_find(table->entries, table->capa, key);
+    }
+    entry->key = key;
+    ++table->size;
+  }
+
+  for (bucket = 0; bucket < OP_STATS_NUM_BUCKETS - 1 && (elapsed >> (bucket + 1)) != 0; ++bucket);
+
+  ++entry->calls;
+  entry->total_ns += elapsed;
+  if (elapsed > entry->max_ns) {
+    entry->max_ns = elapsed;
+  }
+  entry->input_bytes += op_stats_input_bytes(inputs, num_inputs);
+  ++entry->buckets[bucket];
+}
+
+static VALUE
+op_stats_key_name(void *key)
+{
+  char const *name, *description, *key_var_num_args, *return_type;
+  char const **arg_names, **arg_type_infos, **arg_descriptions;
+  mx_uint num_args;
+
+  if (key == &op_stats_cached_op_key) {
+    return rb_usascii_str_new_cstr("CachedOp");
+  }
+  CHECK_CALL(MXNET_API(MXSymbolGetAtomicSymbolInfo)(
+        key, &name, &description, &num_args, &arg_names, &arg_type_infos,
+        &arg_descriptions, &key_var_num_args, &return_type));
+  return rb_usascii_str_new_cstr(name);
+}
+
+/* Enables or disables recording. */
+static VALUE
+stats_s_set_ops_enabled(VALUE mod, VALUE enabled)
+{
+  mxnet_op_stats_enabled = RTEST(enabled);
+  return enabled;
+}
+
+static VALUE
+stats_s_ops_enabled_p(VALUE mod)
+{
+  return mxnet_op_stats_enabled ? Qtrue : Qfalse;
+}
+
+/* Returns the recorded entries of all the threads as an Array of
+ * [name, calls, total_ns, max_ns, input_bytes, buckets].  An operator
+ * called from multiple threads has an entry for each of them.
+ */
+static VALUE
+stats_s_ops_entries(VALUE mod)
+{
+  struct op_stats_table *table;
+  VALUE result;
+  size_t i;
+  int j;
+
+  result = rb_ary_new();
+  for (table = op_stats_tables; table != NULL; table = table->next) {
+    for (i = 0; i < table->capa; ++i) {
+      struct op_stats_entry *entry = &table->entries[i];
+      VALUE buckets;
+
+      if (entry->key == NULL || entry->calls == 0) {
+        continue;
+      }
+      buckets = rb_ary_new_capa(OP_STATS_NUM_BUCKETS);
+      for (j = 0; j < OP_STATS_NUM_BUCKETS; ++j) {
+        rb_ary_push(buckets, ULL2NUM(entry->buckets[j]));
+      }
+      rb_ary_push(result, rb_ary_new_from_args(6,
+            op_stats_key_name(entry->key),
+            ULL2NUM(entry->calls),
+            ULL2NUM(entry->total_ns),
+            ULL2NUM(entry->max_ns),
+            ULL2NUM(entry->input_bytes),
+            buckets));
+    }
+  }
+
+  return result;
+}
+
+/* Clears the recorded entries of all the threads. */
+static VALUE
+stats_s_reset_ops(VALUE mod)
+{
+  struct op_stats_table *table;
+
+  for (table = op_stats_tables; table != NULL; table = table->next) {
+    MEMZERO(table->entries, struct op_stats_entry, table->capa);
+    table->size = 0;
+  }
+  return Qnil;
+}
+
+void
+mxnet_init_op_stats(void)
+{
+  VALUE mStats;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_key_create(&op_stats_table_key, NULL);
+#endif
+
+  mStats = rb_const_get_at(mxnet_mMXNet, rb_intern("Stats"));
+  rb_define_const(mStats, "OPS_HISTOGRAM_BUCKETS", INT2FIX(OP_STATS_NUM_BUCKETS));
+  rb_define_singleton_method(mStats, "_set_ops_enabled", stats_s_set_ops_enabled, 1);
+  rb_define_singleton_method(mStats, "ops_enabled?", stats_s_ops_enabled_p, 0);
+  rb_define_singleton_method(mStats, "_ops_entries", stats_s_ops_entries, 0);
+  rb_define_singleton_method(mStats, "_reset_ops", stats_s_reset_ops, 0);
+}
@@ -0,0 +1,277 @@
+#include "mxnet_internal.h"
+
+static VALUE cProfilerHandle;
+
+#define CHECK_PROFILER_API(name) do { \
+    if (MXNET_API(name) == NULL) { \
+      rb_raise(rb_eNotImpError, #name " is unavailable in the loaded libmxnet"); \
+    } \
+  } while (0)
+
+typedef struct {
+  ProfileHandle handle;
+  int destroy;
+} mx_profile_handle;
+
+static void
+profile_handle_free(void *ptr)
+{
+  mx_profile_handle *ph = (mx_profile_handle *)ptr;
+  if (ph->handle != NULL && ph->destroy) {
+    MXNET_API(MXProfileDestroyHandle)(ph->handle);
+  }
+  xfree(ph);
+}
+
+static size_t
+profile_handle_memsize(void const *ptr)
+{
+  return sizeof(mx_profile_handle);
+}
+
+static const rb_data_type_t profile_handle_data_type = {
+  "MXNet::Profiler::Handle",
+  {
+    NULL,
+    profile_handle_free,
+    profile_handle_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+profile_handle_wrap(ProfileHandle handle, int destroy)
+{
+  mx_profile_handle *ph;
+  VALUE obj;
+
+  obj = TypedData_Make_Struct(cProfilerHandle, mx_profile_handle, &profile_handle_data_type, ph);
+  ph->handle = handle;
+  ph->destroy = destroy;
+  return obj;
+}
+
+static ProfileHandle
+get_profile_handle(VALUE obj)
+{
+  mx_profile_handle *ph;
+  TypedData_Get_Struct(obj, mx_profile_handle, &profile_handle_data_type, ph);
+  return ph->handle;
+}
+
+/* Returns true if the loaded libmxnet provides the profiler API. */
+static VALUE
+profiler_s_available_p(VALUE mod)
+{
+  return MXNET_API(MXProfileCreateDomain) != NULL ? Qtrue : Qfalse;
+}
+
+/* Sets the profiler configuration.
+ *
+ * @param keys [Array<String>] The names of the parameters.
+ * @param vals [Array<String>] The values of the parameters.
+ */
+static VALUE
+profiler_s_set_config(VALUE mod, VALUE keys, VALUE vals)
+{
+  VALUE keys_str, vals_str;
+  char const **keys_ptr, **vals_ptr;
+  long i, n;
+
+  CHECK_PROFILER_API(MXSetProfilerConfig);
+  keys = rb_check_array_type(keys);
+  vals = rb_check_array_type(vals);
+  n = RARRAY_LEN(keys);
+  if (RARRAY_LEN(vals) != n) {
+    rb_raise(rb_eArgError, "the numbers of keys and values are different");
+  }
+
+  keys_str = rb_str_tmp_new(sizeof(char const *) * n);
+  vals_str = rb_str_tmp_new(sizeof(char const *) * n);
+  keys_ptr = (char const **)RSTRING_PTR(keys_str);
+  vals_ptr = (char const **)RSTRING_PTR(vals_str);
+  for (i = 0; i < n; ++i) {
+    VALUE key = RARRAY_AREF(keys, i);
+    VALUE val = RARRAY_AREF(vals, i);
+    keys_ptr[i] = StringValueCStr(key);
+    vals_ptr[i] = StringValueCStr(val);
+  }
+
+  CHECK_CALL(MXNET_API(MXSetProfilerConfig)((int)n, keys_ptr, vals_ptr));
+
+  RB_GC_GUARD(keys);
+  RB_GC_GUARD(vals);
+  RB_GC_GUARD(keys_str);
+  RB_GC_GUARD(vals_str);
+  return Qnil;
+}
+
+/* Sets the profiler state, 1 for running and 0 for stopped. */
+static VALUE
+profiler_s_set_state(VALUE mod, VALUE state)
+{
+  CHECK_PROFILER_API(MXSetProfilerState);
+  CHECK_CALL(MXNET_API(MXSetProfilerState)(NUM2INT(state)));
+  return Qnil;
+}
+
+/* Pauses or resumes the profiler. */
+static VALUE
+profiler_s_pause(VALUE mod, VALUE paused)
+{
+  CHECK_PROFILER_API(MXProfilePause);
+  CHECK_CALL(MXNET_API(MXProfilePause)(RTEST(paused)));
+  return Qnil;
+}
+
+/* Writes the collected events to the configured file. */
+static VALUE
+profiler_s_dump(VALUE mod, VALUE finished)
+{
+  CHECK_PROFILER_API(MXDumpProfile);
+  CHECK_CALL(MXNET_API(MXDumpProfile)(RTEST(finished)));
+  return Qnil;
+}
+
+/* Returns the aggregate statistics as a printed table. */
+static VALUE
+profiler_s_aggregate_stats(VALUE mod, VALUE reset)
+{
+  char const *out;
+
+  CHECK_PROFILER_API(MXAggregateProfileStatsPrint);
+  CHECK_CALL(MXNET_API(MXAggregateProfileStatsPrint)(&out, RTEST(reset)));
+  return rb_utf8_str_new_cstr(out);
+}
+
+/* Creates a domain.  Domains live until the process exits, because the
+ * objects created in them refer to them.
+ */
+static VALUE
+profiler_handle_s_domain(VALUE klass, VALUE name)
+{
+  ProfileHandle handle;
+
+  CHECK_PROFILER_API(MXProfileCreateDomain);
+  CHECK_CALL(MXNET_API(MXProfileCreateDomain)(StringValueCStr(name), &handle));
+  return profile_handle_wrap(handle, 0);
+}
+
+/* Creates a task, a frame, or a counter in a domain.
+ *
+ * @param kind [:task, :frame, :counter] The kind of the object.
+ * @param domain [Handle] The domain.
+ * @param name [String] The name of the object.
+ */
+static VALUE
+profiler_handle_s_create(VALUE klass, VALUE kind, VALUE domain, VALUE name)
+{
+  ProfileHandle domain_handle, handle;
+  char const *name_cstr;
+  ID kind_id;
+
+  domain_handle = get_profile_handle(domain);
+  name_cstr = StringValueCStr(name);
+  kind_id = SYM2ID(kind);
+  if (kind_id == rb_intern("task")) {
+    CHECK_PROFILER_API(MXProfileCreateTask);
+    CHECK_CALL(MXNET_API(MXProfileCreateTask)(domain_handle, name_cstr, &handle));
+  }
+  else if (kind_id == rb_intern("frame")) {
+    CHECK_PROFILER_API(MXProfileCreateFrame);
+    CHECK_CALL(MXNET_API(MXProfileCreateFrame)(domain_handle, name_cstr, &handle));
+  }
+  else if (kind_id == rb_intern("counter")) {
+    CHECK_PROFILER_API(MXProfileCreateCounter);
+    CHECK_CALL(MXNET_API(MXProfileCreateCounter)(domain_handle, name_cstr, &handle));
+  }
+  else {
+    rb_raise(rb_eArgError, "unknown kind of profiler object: %"PRIsVALUE, kind);
+  }
+
+  RB_GC_GUARD(domain);
+  return profile_handle_wrap(handle, 1);
+}
+
+/* Creates an event, which does not belong to a domain. */
+static VALUE
+profiler_handle_s_event(VALUE klass, VALUE name)
+{
+  ProfileHandle handle;
+
+  CHECK_PROFILER_API(MXProfileCreateEvent);
+  CHECK_CALL(MXNET_API(MXProfileCreateEvent)(StringValueCStr(name), &handle));
+  return profile_handle_wrap(handle, 1);
+}
+
+/* Starts the duration of a task, a frame, or an event. */
+static VALUE
+profiler_handle_start(VALUE obj)
+{
+  CHECK_CALL(MXNET_API(MXProfileDurationStart)(get_profile_handle(obj)));
+  return obj;
+}
+
+/* Stops the duration of a task, a frame, or an event. */
+static VALUE
+profiler_handle_stop(VALUE obj)
+{
+  CHECK_CALL(MXNET_API(MXProfileDurationStop)(get_profile_handle(obj)));
+  return obj;
+}
+
+/* Sets the value of a counter. */
+static VALUE
+profiler_handle_set_counter(VALUE obj, VALUE value)
+{
+  CHECK_CALL(MXNET_API(MXProfileSetCounter)(get_profile_handle(obj), NUM2ULL(value)));
+  return obj;
+}
+
+/* Adds +delta+ to the value of a counter. */
+static VALUE
+profiler_handle_adjust_counter(VALUE obj, VALUE delta)
+{
+  CHECK_CALL(MXNET_API(MXProfileAdjustCounter)(get_profile_handle(obj), NUM2LL(delta)));
+  return obj;
+}
+
+/* Sets an instant marker in a domain.
+ *
+ * @param name [String] The name of the marker.
+ * @param scope ['global', 'process', 'thread', 'task', 'marker'] The scope.
+ */
+static VALUE
+profiler_handle_set_marker(VALUE obj, VALUE name, VALUE scope)
+{
+  CHECK_PROFILER_API(MXProfileSetMarker);
+  CHECK_CALL(MXNET_API(MXProfileSetMarker)(get_profile_handle(obj),
+                                           StringValueCStr(name),
+                                           StringValueCStr(scope)));
+  return obj;
+}
+
+void
+mxnet_init_profiler(void)
+{
+  VALUE mProfiler;
+
+  mProfiler = rb_const_get_at(mxnet_mMXNet, rb_intern("Profiler"));
+  rb_define_singleton_method(mProfiler, "available?", profiler_s_available_p, 0);
+  rb_define_singleton_method(mProfiler, "_set_config", profiler_s_set_config, 2);
+  rb_define_singleton_method(mProfiler, "_set_state", profiler_s_set_state, 1);
+  rb_define_singleton_method(mProfiler, "_pause", profiler_s_pause, 1);
+  rb_define_singleton_method(mProfiler, "_dump", profiler_s_dump, 1);
+  rb_define_singleton_method(mProfiler, "_aggregate_stats", profiler_s_aggregate_stats, 1);
+
+  cProfilerHandle = rb_define_class_under(mProfiler, "Handle", rb_cObject);
+  rb_undef_alloc_func(cProfilerHandle);
+  rb_define_singleton_method(cProfilerHandle, "domain", profiler_handle_s_domain, 1);
+  rb_define_singleton_method(cProfilerHandle, "create", profiler_handle_s_create, 3);
+  rb_define_singleton_method(cProfilerHandle, "event", profiler_handle_s_event, 1);
+  rb_define_method(cProfilerHandle, "start", profiler_handle_start, 0);
+  rb_define_method(cProfilerHandle, "stop", profiler_handle_stop, 0);
+  rb_define_method(cProfilerHandle, "set_counter", profiler_handle_set_counter, 1);
+  rb_define_method(cProfilerHandle, "adjust_counter", profiler_handle_adjust_counter, 1);
+  rb_define_method(cProfilerHandle, "set_marker", profiler_handle_set_marker, 2);
+}
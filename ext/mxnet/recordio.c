@@ -0,0 +1,242 @@
+#include "mxnet_internal.h"
+
+#include <ruby/thread.h>
+
+VALUE mxnet_cRecordIO;
+
+typedef struct {
+  RecordIOHandle handle;
+  int writable;
+} mx_recordio;
+
+static void
+recordio_close_handle(mx_recordio *rio)
+{
+  if (rio->handle != NULL) {
+    if (rio->writable) {
+      MXNET_API(MXRecordIOWriterFree)(rio->handle);
+    }
+    else {
+      MXNET_API(MXRecordIOReaderFree)(rio->handle);
+    }
+    rio->handle = NULL;
+  }
+}
+
+static void
+recordio_free(void *ptr)
+{
+  mx_recordio *rio = (mx_recordio *)ptr;
+  recordio_close_handle(rio);
+  xfree(rio);
+}
+
+static size_t
+recordio_memsize(void const *ptr)
+{
+  return sizeof(mx_recordio);
+}
+
+static const rb_data_type_t recordio_data_type = {
+  "MXNet::RecordIO",
+  {
+    NULL,
+    recordio_free,
+    recordio_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+recordio_allocate(VALUE klass)
+{
+  mx_recordio *rio;
+  return TypedData_Make_Struct(klass, mx_recordio, &recordio_data_type, rio);
+}
+
+static mx_recordio *
+get_recordio(VALUE obj)
+{
+  mx_recordio *rio;
+  TypedData_Get_Struct(obj, mx_recordio, &recordio_data_type, rio);
+  return rio;
+}
+
+static mx_recordio *
+get_opened_recordio(VALUE obj)
+{
+  mx_recordio *rio = get_recordio(obj);
+  if (rio->handle == NULL) {
+    rb_raise(rb_eIOError, "closed RecordIO");
+  }
+  return rio;
+}
+
+static VALUE
+recordio_open(VALUE obj, VALUE uri, VALUE writable)
+{
+  mx_recordio *rio;
+  char const *uri_cstr;
+
+  rio = get_recordio(obj);
+  recordio_close_handle(rio);
+
+  FilePathValue(uri);
+  uri_cstr = StringValueCStr(uri);
+  rio->writable = RTEST(writable);
+  if (rio->writable) {
+    CHECK_CALL(MXNET_API(MXRecordIOWriterCreate)(uri_cstr, &rio->handle));
+  }
+  else {
+    CHECK_CALL(MXNET_API(MXRecordIOReaderCreate)(uri_cstr, &rio->handle));
+  }
+
+  return obj;
+}
+
+static VALUE
+recordio_close(VALUE obj)
+{
+  recordio_close_handle(get_recordio(obj));
+  return Qnil;
+}
+
+static VALUE
+recordio_closed_p(VALUE obj)
+{
+  return get_recordio(obj)->handle == NULL ? Qtrue : Qfalse;
+}
+
+/* Writes a record.
+ *
+ * @param buf [String] The record.
+ */
+static VALUE
+recordio_write(VALUE obj, VALUE buf)
+{
+  mx_recordio *rio;
+
+  rio = get_opened_recordio(obj);
+  if (!rio->writable) {
+    rb_raise(rb_eIOError, "not opened for writing");
+  }
+  StringValue(buf);
+  CHECK_CALL(MXNET_API(MXRecordIOWriterWriteRecord)(rio->handle, RSTRING_PTR(buf), RSTRING_LEN(buf)));
+
+  return Qnil;
+}
+
+struct read_record_args {
+  RecordIOHandle handle;
+  char const *buf;
+  size_t size;
+  int res;
+};
+
+static void *
+recordio_read_record_without_gvl(void *ptr)
+{
+  struct read_record_args *args = (struct read_record_args *)ptr;
+  args->res = MXNET_API(MXRecordIOReaderReadRecord)(args->handle, &args->buf, &args->size);
+  return NULL;
+}
+
+/* Reads the next record.  The disk read runs without the GVL, so readers
+ * in different threads can proceed in parallel.
+ *
+ * @param out [String, nil] A String to be overwritten by the record.
+ *   Passing the same String every time avoids allocating one per record.
+ * @return [String, nil] The record, or nil at the end of the file.
+ */
+static VALUE
+recordio_read(int argc, VALUE *argv, VALUE obj)
+{
+  mx_recordio *rio;
+  struct read_record_args args;
+  VALUE out;
+
+  rb_scan_args(argc, argv, "01", &out);
+
+  rio = get_opened_recordio(obj);
+  if (rio->writable) {
+    rb_raise(rb_eIOError, "not opened for reading");
+  }
+
+  args.handle = rio->handle;
+  args.buf = NULL;
+  args.size = 0;
+  rb_thread_call_without_gvl(recordio_read_record_without_gvl, &args, NULL, NULL);
+  if (args.res != 0) {
+    mxnet_raise_last_error();
+  }
+
+  if (args.buf == NULL) {
+    return Qnil;
+  }
+
+  if (NIL_P(out)) {
+    return rb_str_new(args.buf, (long)args.size);
+  }
+
+  StringValue(out);
+  rb_str_modify(out);
+  rb_str_resize(out, (long)args.size);
+  memcpy(RSTRING_PTR(out), args.buf, args.size);
+  return out;
+}
+
+/* Returns the current position in bytes. */
+static VALUE
+recordio_tell(VALUE obj)
+{
+  mx_recordio *rio;
+  size_t pos;
+
+  rio = get_opened_recordio(obj);
+  if (rio->writable) {
+    CHECK_CALL(MXNET_API(MXRecordIOWriterTell)(rio->handle, &pos));
+  }
+  else {
+    if (MXNET_API(MXRecordIOReaderTell) == NULL) {
+      rb_raise(rb_eNotImpError, "MXRecordIOReaderTell is unavailable in the loaded libmxnet");
+    }
+    CHECK_CALL(MXNET_API(MXRecordIOReaderTell)(rio->handle, &pos));
+  }
+
+  return SIZET2NUM(pos);
+}
+
+/* Moves the reader to the given position in bytes, which should be a
+ * position of a record returned by #tell.
+ */
+static VALUE
+recordio_seek(VALUE obj, VALUE pos)
+{
+  mx_recordio *rio;
+
+  rio = get_opened_recordio(obj);
+  if (rio->writable) {
+    rb_raise(rb_eIOError, "seek is unavailable for writing");
+  }
+  CHECK_CALL(MXNET_API(MXRecordIOReaderSeek)(rio->handle, NUM2SIZET(pos)));
+
+  return obj;
+}
+
+void
+mxnet_init_recordio(void)
+{
+  VALUE cRecordIO;
+
+  cRecordIO = rb_const_get_at(mxnet_mMXNet, rb_intern("RecordIO"));
+  rb_define_alloc_func(cRecordIO, recordio_allocate);
+  rb_define_private_method(cRecordIO, "_open", recordio_open, 2);
+  rb_define_method(cRecordIO, "close", recordio_close, 0);
+  rb_define_method(cRecordIO, "closed?", recordio_closed_p, 0);
+  rb_define_method(cRecordIO, "write", recordio_write, 1);
+  rb_define_method(cRecordIO, "read", recordio_read, -1);
+  rb_define_method(cRecordIO, "tell", recordio_tell, 0);
+  rb_define_method(cRecordIO, "seek", recordio_seek, 1);
+
+  mxnet_cRecordIO = cRecordIO;
+}
@@ -840,6 +840,29 @@ symbol_dup(VALUE obj)
   return mxnet_symbol_new(copy_handle);
 }
 
+/* Gets a new grouped symbol whose outputs are the internal outputs of
+ * this symbol, including the arguments.
+ *
+ * Example:
+ *
+ *     > a = MXNet.var(:a)
+ *     > c = MXNet::Symbol.relu(a + 1)
+ *     > c.get_internals.list_outputs
+ *     [:a, :_plusscalar0_output, :relu0_output]
+ *
+ * @return [MXNet::Symbol] The symbol of all the internal outputs.
+ */
+static VALUE
+symbol_get_internals(VALUE obj)
+{
+  SymbolHandle handle, out_handle;
+
+  handle = mxnet_get_handle(obj);
+  CHECK_CALL(MXNET_API(MXSymbolGetInternals)(handle, &out_handle));
+
+  return mxnet_symbol_new(out_handle);
+}
+
 static inline void
 sdata_extend(VALUE sdata_str, long *sdata_capa, long *sdata_len, VALUE shape, long remaining_count)
 {
@@ -1147,6 +1170,7 @@ mxnet_init_symbol(void)
   rb_define_method(cSymbol, "to_json", symbol_to_json, 0);
   rb_define_method(cSymbol, "bind", symbol_bind, -1);
   rb_define_method(cSymbol, "dup", symbol_dup, 0);
+  rb_define_method(cSymbol, "get_internals", symbol_get_internals, 0);
 
   rb_define_private_method(cSymbol, "set_attributes", symbol_set_attributes, -1);
   rb_define_private_method(cSymbol, "infer_shape_impl", symbol_infer_shape_impl, -1);
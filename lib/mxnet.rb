@@ -17,16 +17,24 @@ module MXNet
   require 'mxnet/autograd'
   require 'mxnet/context'
   require 'mxnet/name/name_manager'
+  require 'mxnet/engine'
   require 'mxnet/executor'
   require 'mxnet/initializer'
   require 'mxnet/io'
+  require 'mxnet/memory'
   require 'mxnet/metric'
   require 'mxnet/ndarray'
   require 'mxnet/ndarray/operation_delegator'
+  require 'mxnet/ndarray/notifier'
+  require 'mxnet/ndarray/batch'
   require 'mxnet/optimizer'
+  require 'mxnet/profiler'
   require 'mxnet/symbol'
   require 'mxnet/symbol/operation_delegator'
+  require 'mxnet/symbol/cost_report'
   require 'mxnet/random'
+  require 'mxnet/recordio'
+  require 'mxnet/stats'
   require 'mxnet/utils'
   require 'mxnet/op_info'
   require 'mxnet.so'
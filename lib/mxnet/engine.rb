@@ -0,0 +1,157 @@
+module MXNet
+  # Threading configuration of the libmxnet execution engine, and the
+  # features libmxnet was built with.
+  #
+  # libmxnet reads the engine type, the numbers of the worker threads and
+  # the OpenMP affinity from environment variables when it is loaded.
+  # Engine.configure sets them from Ruby, so it has to be called before
+  # requiring 'mxnet', which loads libmxnet:
+  #
+  #     require 'mxnet/engine'
+  #     MXNet::Engine.configure(cpu_worker_threads: 2, omp_threads: 8, affinity: :close)
+  #     require 'mxnet'
+  #
+  # The number of OpenMP threads can also be changed afterwards with
+  # Engine.num_omp_threads=.
+  #
+  # Engine.bulk groups consecutive imperative operations into bulk
+  # segments, which the engine schedules as one, to cut the per-operation
+  # scheduling cost of code issuing many small operations:
+  #
+  #     MXNet::Engine.bulk(20) do
+  #       params.each {|p| p.data[0..-1] = p.data - lr * p.grad }
+  #     end
+  #
+  #     MXNet::Engine.feature_enabled?(:mkldnn)  # => true
+  module Engine
+    TYPES = %w[NaiveEngine ThreadedEngine ThreadedEnginePerDevice].freeze
+
+    # The bulk size used by Gluon::Trainer#step and the initialization of
+    # Gluon parameters, the same as the default of the segments of
+    # Executor in training.
+    DEFAULT_BULK_SIZE = 15
+
+    # The environment variables set for each affinity.  OMP_PROC_BIND and
+    # OMP_PLACES are for GNU OpenMP, and KMP_AFFINITY for Intel OpenMP,
+    # which the MKL builds of libmxnet use.
+    AFFINITIES = {
+      close: {'OMP_PROC_BIND' => 'close', 'OMP_PLACES' => 'cores', 'KMP_AFFINITY' => 'granularity=fine,compact,1,0'},
+      spread: {'OMP_PROC_BIND' => 'spread', 'OMP_PLACES' => 'cores', 'KMP_AFFINITY' => 'granularity=fine,scatter'},
+      none: {'OMP_PROC_BIND' => 'false', 'KMP_AFFINITY' => 'disabled'},
+    }.freeze
+
+    class << self
+      # Configures the engine before libmxnet is loaded.
+      #
+      # @param type ['NaiveEngine', 'ThreadedEngine', 'ThreadedEnginePerDevice']
+      #   The engine type.  NaiveEngine runs every operation synchronously
+      #   in the calling thread.
+      # @param cpu_worker_threads [Integer] The number of threads which run
+      #   the operations on CPU.
+      # @param cpu_priority_threads [Integer] The number of threads which
+      #   run the high-priority operations on CPU.
+      # @param omp_threads [Integer] The number of OpenMP threads used by
+      #   an operation.  This can be set after libmxnet is loaded.
+      # @param affinity [:close, :spread, :none] How the OpenMP threads are
+      #   bound to the cores.
+      # @raise [RuntimeError] when an option other than +omp_threads+ is
+      #   given after libmxnet is loaded.
+      def configure(type: nil, cpu_worker_threads: nil, cpu_priority_threads: nil, omp_threads: nil, affinity: nil)
+        if type && !TYPES.include?(type.to_s)
+          raise ArgumentError, "invalid engine type: #{type} (expected one of #{TYPES.join(', ')})"
+        end
+        if affinity && !AFFINITIES.key?(affinity)
+          raise ArgumentError, "invalid affinity: #{affinity.inspect} (expected one of #{AFFINITIES.keys.map(&:inspect).join(', ')})"
+        end
+        if libmxnet_loaded? && (type || cpu_worker_threads || cpu_priority_threads || affinity)
+          raise "the engine must be configured before libmxnet is loaded"
+        end
+
+        ENV['MXNET_ENGINE_TYPE'] = type.to_s if type
+        ENV['MXNET_CPU_WORKER_NTHREADS'] = Integer(cpu_worker_threads).to_s if cpu_worker_threads
+        ENV['MXNET_CPU_PRIORITY_NTHREADS'] = Integer(cpu_priority_threads).to_s if cpu_priority_threads
+        ENV.update(AFFINITIES[affinity]) if affinity
+        if omp_threads
+          if libmxnet_loaded?
+            self.num_omp_threads = omp_threads
+          else
+            ENV['OMP_NUM_THREADS'] = Integer(omp_threads).to_s
+          end
+        end
+        self
+      end
+
+      # Returns the engine type.
+      def type
+        ENV.fetch('MXNET_ENGINE_TYPE', 'ThreadedEnginePerDevice')
+      end
+
+      # Returns the number of threads which run the operations on CPU.
+      def cpu_worker_threads
+        Integer(ENV.fetch('MXNET_CPU_WORKER_NTHREADS', 1))
+      end
+
+      # Returns the number of threads which run the high-priority
+      # operations on CPU.
+      def cpu_priority_threads
+        Integer(ENV.fetch('MXNET_CPU_PRIORITY_NTHREADS', 4))
+      end
+
+      # Returns the number of OpenMP threads set by this module or by
+      # OMP_NUM_THREADS, or nil if libmxnet chooses it.
+      def num_omp_threads
+        @num_omp_threads || (ENV['OMP_NUM_THREADS'] && Integer(ENV['OMP_NUM_THREADS']))
+      end
+
+      # Sets the number of OpenMP threads used by the operations dispatched
+      # from the calling thread.
+      def num_omp_threads=(num_threads)
+        _set_num_omp_threads(Integer(num_threads))
+        @num_omp_threads = Integer(num_threads)
+      end
+
+      # Executes the imperative operations issued by the calling thread in
+      # the block in bulk segments of up to +size+ operations, and restores
+      # the previous bulk size afterwards.  The operations in a segment
+      # are scheduled together, and their results are available when the
+      # segment is complete, or when waited for.
+      #
+      # The block is simply called when the loaded libmxnet does not
+      # support bulk execution.
+      #
+      # @param size [Integer] The maximum number of operations in a
+      #   segment.  0 or 1 disables bulk execution.
+      # @return The value of the block.
+      def bulk(size)
+        return yield unless bulk_available?
+        prev_size = _set_bulk_size(Integer(size))
+        begin
+          yield
+        ensure
+          _set_bulk_size(prev_size)
+        end
+      end
+
+      # Returns the features libmxnet was built with, as a Hash from the
+      # names such as "MKLDNN", "OPENMP" and "INT64_TENSOR_SIZE" to whether
+      # they are enabled.  Requires MXNet 1.5 or later.
+      def features
+        @features ||= _lib_features.to_h.freeze
+      end
+
+      # Returns true if libmxnet was built with the feature +name+.
+      #
+      # @param name [String, Symbol] The name of the feature, in any case.
+      # @raise [ArgumentError] when the feature is unknown to libmxnet.
+      def feature_enabled?(name)
+        features.fetch(name.to_s.upcase) do
+          raise ArgumentError, "unknown feature: #{name}"
+        end
+      end
+
+      private def libmxnet_loaded?
+        defined?(MXNet::LibMXNet) && MXNet::LibMXNet.loaded?
+      end
+    end
+  end
+end
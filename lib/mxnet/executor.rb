@@ -20,5 +20,50 @@ module MXNet
     end
 
     attr_reader :outputs
+
+    # A statistic of an output sampled by the monitor.
+    MonitorResult = Struct.new(:step, :name, :value)
+
+    # Samples a statistic of the outputs of the nodes whose names match
+    # +pattern+ every +interval+ forward passes.
+    #
+    # The statistics are computed by operators on the device of the
+    # executor and buffered natively.  On the other passes, the monitor
+    # only releases the outputs it receives.  Read the buffered results
+    # with #monitor_results.
+    #
+    # libmxnet disables bulk execution of the executor while a monitor is
+    # installed, and a monitor cannot be removed, so it is for debugging.
+    #
+    #     exec.set_monitor(/fc.*_output/, interval: 100, stat: :max_abs)
+    #     ...
+    #     exec.monitor_results.each do |r|
+    #       puts "#{r.step} #{r.name} #{r.value}"
+    #     end
+    #
+    # @param pattern [Regexp, String] The pattern of the output names,
+    #   such as "fc1_output".
+    # @param interval [Integer] The number of forward passes between the
+    #   samples.  The first pass is sampled.
+    # @param stat [:norm, :max_abs, :mean_abs] The statistic.  +:norm+ is
+    #   the L2 norm divided by the square root of the size.
+    def set_monitor(pattern = /.*/, interval: 1, stat: :norm)
+      pattern = Regexp.new(pattern) if pattern.is_a?(String)
+      names = @symbol.get_internals.list_outputs.map(&:to_s).grep(pattern)
+      _set_monitor(names, interval, stat)
+      @monitor_stat = stat
+      self
+    end
+
+    # Takes the statistics sampled since the last call as an Array of
+    # MonitorResult, in the order they were computed.  Waits for the
+    # statistics still computing.
+    def monitor_results
+      _drain_monitor.map do |step, name, stat, size|
+        value = stat.as_scalar
+        value /= Math.sqrt(size) if @monitor_stat == :norm && size > 0
+        MonitorResult.new(step, name, value)
+      end
+    end
   end
 end
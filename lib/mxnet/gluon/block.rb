@@ -78,6 +78,80 @@ module MXNet
       end
     end
 
+    # A handle returned by Block#register_forward_pre_hook and
+    # Block#register_forward_hook, which removes the hook.
+    class HookHandle
+      def initialize(hooks, id)
+        @hooks = hooks
+        @id = id
+      end
+
+      # Removes the hook.
+      def detach
+        @hooks.delete(@id)
+        nil
+      end
+    end
+
+    # Wall time per block measured by Block#profile.
+    class BlockProfile
+      # +total+ and +self_time+ are in seconds; +self_time+ excludes the
+      # time of the child blocks called inside the block.
+      Entry = Struct.new(:name, :calls, :total, :self_time)
+
+      COLUMNS = %i[total self calls name].freeze
+
+      def initialize(entries, iterations)
+        @entries = entries
+        @iterations = iterations
+      end
+
+      attr_reader :entries, :iterations
+
+      # Returns the results as a Hash from the block names to Hashes of
+      # +:calls+, +:total+ and +:self+ in seconds, and their means per
+      # iteration.
+      def to_h
+        @entries.to_h do |e|
+          [e.name, {calls: e.calls, total: e.total, self: e.self_time,
+                    mean: e.total / @iterations, self_mean: e.self_time / @iterations}]
+        end
+      end
+
+      # Returns the results as a printable table.
+      #
+      # ====Parameters
+      #
+      # +sort+:: (symbol, default +:total+)
+      #          The column to sort by in descending order, one of
+      #          +:total+, +:self+ and +:calls+, or +:name+ in ascending
+      #          order.
+      #
+      def table(sort: :total)
+        unless COLUMNS.include?(sort)
+          raise ArgumentError, "invalid column to sort by: #{sort.inspect}"
+        end
+        sorted = case sort
+                 when :name then @entries.sort_by(&:name)
+                 when :self then @entries.sort_by {|e| -e.self_time }
+                 else @entries.sort_by {|e| -e[sort] }
+                 end
+        width = [@entries.map {|e| e.name.length }.max || 0, 5].max
+        lines = [format("%-#{width}s %8s %12s %12s %12s %12s",
+                        'block', 'calls', 'total ms', 'mean ms', 'self ms', 'self mean ms')]
+        sorted.each do |e|
+          lines << format("%-#{width}s %8d %12.3f %12.3f %12.3f %12.3f",
+                          e.name, e.calls, 1000 * e.total, 1000 * e.total / @iterations,
+                          1000 * e.self_time, 1000 * e.self_time / @iterations)
+        end
+        lines.join("\n")
+      end
+
+      def to_s
+        table
+      end
+    end
+
     # Base class for all neural network layers and models.  Your models should
     # be subclasses of this class.
     #
@@ -130,6 +204,9 @@ module MXNet
         @children = {}
         @reg_params = {}
         @attributes = {}
+        @forward_pre_hooks = {}
+        @forward_hooks = {}
+        @next_hook_id = 0
       end
 
       def inspect
@@ -379,8 +456,127 @@ module MXNet
       end
 
       # Calls #forward. Only accepts positional arguments.
+      #
+      # While MXNet::Profiler is running, the call is recorded as a span
+      # named after the block.
       def call(*args)
-        forward(*args)
+        MXNet::Profiler.span(name, category: 'block') do
+          @forward_pre_hooks.each_value {|hook| hook.(self, args) } unless @forward_pre_hooks.empty?
+          out = forward(*args)
+          @forward_hooks.each_value {|hook| hook.(self, args, out) } unless @forward_hooks.empty?
+          out
+        end
+      end
+
+      # Registers a hook called with the block and the input arguments
+      # before #forward.
+      #
+      # ====Parameters
+      #
+      # +hook+:: (proc) The hook, or the block given.
+      #
+      # ====Returns
+      #
+      # A HookHandle to remove the hook.
+      #
+      def register_forward_pre_hook(hook = nil, &block)
+        add_hook(@forward_pre_hooks, hook || block)
+      end
+
+      # Registers a hook called with the block, the input arguments and
+      # the output after #forward.
+      #
+      # ====Parameters
+      #
+      # +hook+:: (proc) The hook, or the block given.
+      #
+      # ====Returns
+      #
+      # A HookHandle to remove the hook.
+      #
+      def register_forward_hook(hook = nil, &block)
+        add_hook(@forward_hooks, hook || block)
+      end
+
+      private def add_hook(hooks, hook)
+        raise ArgumentError, "no hook given" unless hook
+        # Each registration has its own key, so that registering a hook
+        # twice calls it twice, and a handle removes one registration.
+        id = (@next_hook_id += 1)
+        hooks[id] = hook
+        HookHandle.new(hooks, id)
+      end
+
+      # Measures the wall time of this block and each of its descendants
+      # by calling this block with +input+.
+      #
+      # Operators run asynchronously, so while profiling each block waits
+      # for its inputs before it starts and for its outputs before it
+      # finishes.  Calls outside of #profile are not affected.  The
+      # descendants of an active HybridBlock run in its CachedOp and are
+      # not measured separately.
+      #
+      # ====Parameters
+      #
+      # +input+::      (NDArray or array of NDArrays) The input.
+      # +iterations+:: (integer, default 10) The number of measured calls.
+      # +warmup+::     (integer, default 1) The number of calls before
+      #                measuring.
+      #
+      # ====Returns
+      #
+      # A BlockProfile, whose #table prints the results and #to_h returns
+      # them as a Hash.
+      #
+      #     puts net.profile(MXNet::NDArray.ones([32, 784]), iterations: 20).table(sort: :self)
+      #
+      def profile(input, iterations: 10, warmup: 1)
+        inputs = input.is_a?(Array) ? input : [input]
+        warmup.times { wait_outputs(call(*inputs)) }
+
+        entries = {}.compare_by_identity
+        stack = []
+        handles = []
+        each_descendant do |blk|
+          handles << blk.register_forward_pre_hook do |b, args|
+            wait_outputs(args)
+            stack << [b, MXNet::Stats.clock, 0.0]
+          end
+          handles << blk.register_forward_hook do |b, _, out|
+            wait_outputs(out)
+            _, start, children = stack.pop
+            elapsed = MXNet::Stats.clock - start
+            stack.last[2] += elapsed unless stack.empty?
+            entry = (entries[b] ||= BlockProfile::Entry.new(b.name, 0, 0.0, 0.0))
+            entry.calls += 1
+            entry.total += elapsed
+            entry.self_time += elapsed - children
+          end
+        end
+        begin
+          iterations.times { call(*inputs) }
+        ensure
+          handles.each(&:detach)
+        end
+        BlockProfile.new(entries.values, iterations)
+      end
+
+      # Yields this block and its descendants once each.
+      protected def each_descendant(seen = {}.compare_by_identity, &block)
+        return if seen.key?(self)
+        seen[self] = true
+        yield self
+        @children.each_value {|child| child.each_descendant(seen, &block) }
+      end
+
+      private def wait_outputs(out)
+        case out
+        when MXNet::NDArray
+          out.wait_to_read
+        when Array
+          out.each {|o| wait_outputs(o) }
+        end
+        out
       end
     end
 
@@ -527,6 +723,26 @@ module MXNet
         infer_shape(*args)
       end
 
+      # Estimates the cost of a forward pass of the cached graph with
+      # inputs of the shapes of +args+.  See Symbol#cost_report.
+      #
+      # ====Parameters
+      #
+      # +args+::  (array of NDArray) Input tensors.
+      # +dtype+:: (symbol, default +:float32+)
+      #           The dtype used for the byte sizes.
+      #
+      # ====Returns
+      #
+      # Symbol::CostReport
+      #
+      def cost_report(*args, dtype: :float32)
+        inputs, output = _get_graph(*args)
+        args, _ = _flatten(args)
+        input_shapes = inputs.zip(args).map { |i, j| [i.name.to_sym, j.shape] }.to_h
+        output.cost_report(dtype: dtype, **input_shapes)
+      end
+
       private
 
       # Infer attributes.
@@ -5,6 +5,15 @@ module MXNet
   end
 end
 
+require_relative 'data/batch_transforms'
+require_relative 'data/batchify'
 require_relative 'data/data_loader'
 require_relative 'data/dataset'
+require_relative 'data/cached_dataset'
+require_relative 'data/iterable_dataset'
+require_relative 'data/mmap_dataset'
+require_relative 'data/record_file_dataset'
+require_relative 'data/text_dataset'
+require_relative 'data/vision/image_folder_dataset'
 require_relative 'data/vision/mnist'
+require_relative 'data/vision/transforms'
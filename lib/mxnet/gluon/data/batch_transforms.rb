@@ -0,0 +1,184 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # Transforms applied by DataLoader to whole collated batches.
+  #
+  # Each transform issues a fixed number of NDArray operations per batch,
+  # however large the batch is, instead of a few operations per sample as
+  # Dataset#transform does.  Samples can thus stay compact (e.g. uint8)
+  # until they are collated.
+  #
+  # When a batch is an Array, such as <tt>[data, label]</tt>, a transform
+  # is applied to its first element, and the rest is passed through.
+  #
+  #     transform = MXNet::Gluon::Data::BatchTransforms::Compose.new(
+  #       MXNet::Gluon::Data::BatchTransforms::RandomFlip.new(axis: 3),
+  #       MXNet::Gluon::Data::BatchTransforms::Cast.new(:float32),
+  #       MXNet::Gluon::Data::BatchTransforms::Normalize.new(0.13, 0.31)
+  #     )
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 64, batch_transform: transform)
+  #
+  module BatchTransforms
+    # Base class for batch transforms.  Subclasses define #forward, which
+    # receives and returns a batch NDArray.
+    class BatchTransform
+      def call(batch)
+        if batch.is_a?(Array)
+          [forward(batch[0]), *batch[1..-1]]
+        else
+          forward(batch)
+        end
+      end
+
+      def to_proc
+        method(:call).to_proc
+      end
+
+      def forward(data)
+        raise NotImplementedError
+      end
+    end
+
+    # Applies transforms in order.
+    class Compose < BatchTransform
+      def initialize(*transforms)
+        @transforms = transforms
+      end
+
+      def call(batch)
+        @transforms.inject(batch) {|b, t| t.(b) }
+      end
+
+      def forward(data)
+        call(data)
+      end
+    end
+
+    # Casts a batch to +dtype+.
+    class Cast < BatchTransform
+      def initialize(dtype = :float32)
+        @dtype = dtype
+      end
+
+      def forward(data)
+        return data if data.dtype == @dtype
+        MXNet::NDArray.cast(data, dtype: @dtype)
+      end
+    end
+
+    # Converts a batch of images in NHWC layout with values in [0, 255],
+    # such as uint8, into float32 NCHW with values in [0, 1).
+    class ToTensor < BatchTransform
+      def forward(data)
+        data = MXNet::NDArray.cast(data, dtype: :float32)
+        MXNet::NDArray.transpose(data, axes: [0, 3, 1, 2]) / 255.0
+      end
+    end
+
+    # Normalizes a batch with per-channel mean and standard deviation:
+    #
+    #     out[:, i, ...] = (data[:, i, ...] - mean[i]) / std[i]
+    #
+    # ====Parameters
+    #
+    # +mean+:: (float or array of floats)
+    #          Mean of each channel.
+    # +std+::  (float or array of floats)
+    #          Standard deviation of each channel.
+    # +axis+:: (integer, default 1)
+    #          The channel axis.
+    #
+    class Normalize < BatchTransform
+      def initialize(mean, std, axis: 1)
+        @mean = Array(mean).map(&:to_f)
+        @std = Array(std).map(&:to_f)
+        @axis = axis
+        @params = {}
+      end
+
+      def forward(data)
+        data = MXNet::NDArray.cast(data, dtype: :float32) unless data.dtype == :float32
+        if @mean.length == 1 && @std.length == 1
+          return (data - @mean[0]) / @std[0]
+        end
+        scale, shift = params(data)
+        data * scale + shift
+      end
+
+      # The scale and the shift broadcast along the channel axis, kept for
+      # each context and rank.
+      private def params(data)
+        key = [data.context, data.ndim]
+        @params[key] ||= begin
+          channels = [@mean.length, @std.length].max
+          mean = @mean.length == 1 ? @mean * channels : @mean
+          std = @std.length == 1 ? @std * channels : @std
+          shape = Array.new(data.ndim, 1)
+          shape[@axis] = channels
+          scale = std.map {|s| 1.0 / s }
+          shift = mean.zip(std).map {|m, s| -m / s }
+          [scale, shift].map {|v| MXNet::NDArray.array(v, ctx: data.context).reshape(shape) }
+        end
+      end
+    end
+
+    # Flips each sample along +axis+ with probability +p+.  The flip is
+    # decided per sample, and computed with one +reverse+ and one +where+
+    # for the whole batch.
+    #
+    # ====Parameters
+    #
+    # +axis+:: (integer, default 3)
+    #          The axis to flip, which is the width of NCHW images.
+    # +p+::    (float, default 0.5)
+    #          The probability to flip.
+    #
+    class RandomFlip < BatchTransform
+      def initialize(axis: 3, p: 0.5)
+        @axis = axis
+        @p = p
+      end
+
+      def forward(data)
+        mask = MXNet::NDArray::Random.uniform(shape: [data.shape[0]], ctx: data.context) < @p
+        MXNet::NDArray.where(mask, MXNet::NDArray.reverse(data, axis: @axis), data)
+      end
+    end
+
+    # Crops a random window of +size+ from a batch of images.  One window
+    # is chosen per batch, so the crop is a single +slice+.
+    #
+    # ====Parameters
+    #
+    # +size+::   (integer or [height, width])
+    #            The size of the window.
+    # +layout+:: ('NCHW' or 'NHWC', default 'NCHW')
+    #            The layout of the batch.
+    #
+    class RandomCrop < BatchTransform
+      def initialize(size, layout: 'NCHW')
+        @height, @width = size.is_a?(Array) ? size : [size, size]
+        unless %w[NCHW NHWC].include?(layout)
+          raise ArgumentError, "unsupported layout: #{layout}"
+        end
+        @h_axis = layout.index('H')
+        @w_axis = layout.index('W')
+      end
+
+      def forward(data)
+        shape = data.shape
+        h, w = shape[@h_axis], shape[@w_axis]
+        if h < @height || w < @width
+          raise ArgumentError, "crop size #{[@height, @width]} exceeds image size #{[h, w]}"
+        end
+        y = rand(h - @height + 1)
+        x = rand(w - @width + 1)
+        b = Array.new(shape.length, 0)
+        e = shape.dup
+        b[@h_axis], e[@h_axis] = y, y + @height
+        b[@w_axis], e[@w_axis] = x, x + @width
+        MXNet::NDArray.slice(data, begin: b, end: e)
+      end
+    end
+  end
+end
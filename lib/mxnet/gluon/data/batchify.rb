@@ -0,0 +1,101 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # Batchify functions, which collate a list of samples into a batch and
+  # can be passed to DataLoader as +batchify_fn+.
+  #
+  #     batchify_fn = MXNet::Gluon::Data::Batchify::Tuple.new(
+  #       MXNet::Gluon::Data::Batchify::Pad.new(pad_val: 0),
+  #       MXNet::Gluon::Data::Batchify::Stack.new
+  #     )
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_sampler: sampler, batchify_fn: batchify_fn)
+  #
+  module Batchify
+    # Stacks samples of the same shape.
+    class Stack
+      def initialize(dtype: nil)
+        @dtype = dtype
+      end
+
+      def call(data)
+        if data[0].is_a?(MXNet::NDArray)
+          out = MXNet::NDArray.stack(*data)
+          @dtype && out.dtype != @dtype ? MXNet::NDArray.cast(out, dtype: @dtype) : out
+        else
+          MXNet::NDArray.array(data, dtype: @dtype || (data.flatten.all?(Integer) ? :int32 : :float32))
+        end
+      end
+
+      def to_proc
+        method(:call).to_proc
+      end
+    end
+
+    # Pads samples of different lengths along their first axis up to the
+    # longest one in the batch, and stacks them.
+    #
+    # The batch is assembled in host memory and uploaded with one copy,
+    # regardless of the batch size.
+    #
+    # ====Parameters
+    #
+    # +pad_val+::    (number, default 0)
+    #                The padding value.
+    # +dtype+::      (symbol, optional)
+    #                The dtype of the batch.  Defaults to the dtype of
+    #                NDArray samples, or +:float32+ for Array samples.
+    # +ret_length+:: (boolean, default false)
+    #                Whether to also return the lengths of the samples as
+    #                an int32 NDArray.
+    #
+    class Pad
+      def initialize(pad_val: 0, dtype: nil, ret_length: false)
+        @pad_val = pad_val
+        @dtype = dtype
+        @ret_length = ret_length
+      end
+
+      def call(data)
+        first = data[0]
+        if first.is_a?(MXNet::NDArray)
+          dtype = @dtype || first.dtype
+          data = data.map {|x| x.dtype == dtype ? x : MXNet::NDArray.cast(x, dtype: dtype) }
+          lengths = data.map {|x| x.shape[0] }
+          shape = [data.length, lengths.max, *first.shape[1..-1]]
+          ctx = first.context
+        else
+          dtype = @dtype || :float32
+          lengths = data.map(&:length)
+          shape = [data.length, lengths.max]
+          ctx = MXNet.cpu
+        end
+        out = MXNet::NDArray.empty(shape, dtype: dtype, ctx: ctx)
+        MXNet::NDArray._pad_stack(out, data, @pad_val)
+        return out unless @ret_length
+        [out, MXNet::NDArray.array(lengths, dtype: :int32)]
+      end
+
+      def to_proc
+        method(:call).to_proc
+      end
+    end
+
+    # Applies a batchify function to each field of samples.
+    class Tuple
+      def initialize(*fns)
+        @fns = fns
+      end
+
+      def call(data)
+        unless data[0].length == @fns.length
+          raise ArgumentError, "samples have #{data[0].length} fields, but #{@fns.length} functions are given"
+        end
+        @fns.each_with_index.map {|fn, i| fn.(data.map {|x| x[i] }) }
+      end
+
+      def to_proc
+        method(:call).to_proc
+      end
+    end
+  end
+end
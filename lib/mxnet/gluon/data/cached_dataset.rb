@@ -0,0 +1,195 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # A dataset that keeps the samples of another dataset once they are
+  # computed, so that deterministic preprocessing runs only in the first
+  # epoch.  Created by Dataset#cache.
+  #
+  # Each field of the samples is stored in one contiguous store of shape
+  # <tt>[length, *sample_shape]</tt>, which is filled slot by slot during
+  # the first pass.  Storing a sample takes a lock, while reading a stored
+  # one does not, so the dataset can be shared by threads.  #get_batch
+  # gathers a batch from the stores with one operation per field, and
+  # DataLoader uses it instead of collating samples.
+  #
+  # The storage is either
+  #
+  # +:memory+:: NDArrays in the CPU memory.  Batches are gathered by
+  #             +take+.
+  # +:mmap+::   A raw tensor file at +path+ (see MmapDataset).  Samples are
+  #             written into a temporary file during the first pass, and
+  #             read back from it until it is complete and renamed to
+  #             +path+.  If +path+ already
+  #             exists and has the same length, it is used without
+  #             recomputing the samples; delete it to rebuild.
+  #
+  # All the samples must have the same structure, and each field must be
+  # an NDArray of the same shape and dtype, or a number.  A field of
+  # numbers is stored as int32 if the first number stored is an Integer,
+  # and as float32 otherwise.
+  #
+  #     dataset = MXNet::Gluon::Data::Vision::MNIST.new.transform_first {|x| x.as_type(:float32) / 255 }
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset.cache, batch_size: 100, shuffle: true)
+  #
+  class CachedDataset < Dataset
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +dataset+:: (Dataset)
+    #             The source dataset.
+    # +storage+:: (+:memory+ or +:mmap+, default +:memory+)
+    #             Where to store the samples.
+    # +path+::    (string)
+    #             The file for +:mmap+ storage.
+    #
+    def initialize(dataset, storage: :memory, path: nil)
+      super()
+      unless [:memory, :mmap].include?(storage)
+        raise ArgumentError, "storage must be either :memory or :mmap"
+      end
+      if storage == :mmap && path.nil?
+        raise ArgumentError, "path must be specified for :mmap storage"
+      end
+      @dataset = dataset
+      @storage = storage
+      @path = path
+      @length = dataset.length
+      @filled = "\0".b * @length
+      @num_filled = 0
+      @stores = nil
+      @mutex = Mutex.new
+      if storage == :mmap && File.file?(path)
+        mapped = MmapDataset.new(path)
+        if mapped.length == @length
+          @mapped = mapped
+        else
+          mapped.close
+        end
+      end
+    end
+
+    attr_reader :storage, :path
+
+    def length
+      @length
+    end
+
+    # Returns whether every sample has been stored.
+    def complete?
+      !@mapped.nil? || (@storage == :memory && @num_filled == @length)
+    end
+
+    def [](idx)
+      idx += @length if idx < 0
+      unless 0 <= idx && idx < @length
+        raise IndexError, "index #{idx} is out of range for #{@length} samples"
+      end
+      mapped = @mapped
+      return mapped[idx] if mapped
+      return read_stored(idx) if @filled.getbyte(idx) == 1
+      fill(idx)
+    end
+
+    # Stores all the samples not stored yet.  A sampler that skips samples
+    # (e.g. with <tt>last_batch: :discard</tt>) may leave some unstored
+    # after the first epoch.
+    def materialize
+      @length.times {|i| fill(i) unless @filled.getbyte(i) == 1 } unless @mapped
+      self
+    end
+
+    # Reads the samples at the given indices into one NDArray per field.
+    # Samples not stored yet are computed and stored first.
+    #
+    # ====Parameters
+    #
+    # +indices+:: (array of integers)
+    #             Sample indices.
+    #
+    def get_batch(indices)
+      mapped = @mapped
+      return mapped.get_batch(indices) if mapped
+      indices.each {|i| fill(i) unless @filled.getbyte(i) == 1 }
+      # Filling the last missing sample completes the file.
+      return (@mapped || @partial).get_batch(indices) if @storage == :mmap
+      index_nd = MXNet::NDArray.array(indices, dtype: :int32)
+      items = @stores.map {|store| store.take(index_nd) }
+      @multi ? items : items[0]
+    end
+
+    private def read_stored(idx)
+      # The temporary file stays mapped after it is renamed.
+      return @partial[idx] if @storage == :mmap
+      items = @stores.each_with_index.map do |store, i|
+        @scalar_dtypes[i] ? store[idx].as_scalar : store[idx]
+      end
+      @multi ? items : items[0]
+    end
+
+    # Computes a sample and stores it.  The sample is computed without the
+    # lock, so two threads may compute the same sample, but only the first
+    # one counts it.
+    private def fill(idx)
+      sample = @dataset[idx]
+      @mutex.synchronize { store(idx, sample) }
+      sample
+    end
+
+    private def store(idx, sample)
+      values = sample.is_a?(Array) ? sample : [sample]
+      @multi = sample.is_a?(Array) if @multi.nil?
+      if @storage == :memory
+        unless @stores
+          @scalar_dtypes = values.map {|v| scalar_dtype(v) }
+          @stores = values.map.with_index {|v, i| new_store(v, @scalar_dtypes[i]) }
+        end
+        @stores.each_with_index do |store, i|
+          if @scalar_dtypes[i] == :int32 && !values[i].is_a?(Integer)
+            raise ArgumentError, "field #{i} of sample #{idx} is not an Integer, " +
+                                 "but the field is stored as int32"
+          end
+          store[idx] = values[i]
+        end
+      else
+        unless @writer
+          @writer = MmapDataset::Writer.new(@path, @length, sample)
+          @partial = @writer.reader
+        end
+        @writer.write(idx, sample)
+      end
+      if @filled.getbyte(idx) == 0
+        @filled.setbyte(idx, 1)
+        @num_filled += 1
+        finish if @num_filled == @length
+      end
+    end
+
+    # Returns the dtype of the store of a field of numbers, which is fixed
+    # by the first value stored, or nil for a field of NDArrays.
+    private def scalar_dtype(value)
+      case value
+      when Integer then :int32
+      when Numeric then :float32
+      end
+    end
+
+    private def new_store(value, scalar_dtype)
+      case value
+      when MXNet::NDArray
+        MXNet::NDArray.empty([@length, *value.shape], dtype: value.dtype, ctx: MXNet.cpu)
+      when Numeric
+        MXNet::NDArray.empty([@length], dtype: scalar_dtype, ctx: MXNet.cpu)
+      else
+        raise ArgumentError, "unsupported type of sample field: #{value.class}"
+      end
+    end
+
+    private def finish
+      return unless @storage == :mmap
+      @writer.close
+      @writer = nil
+      @mapped = MmapDataset.new(@path)
+    end
+  end
+end
@@ -11,9 +11,11 @@ module MXNet
         #
         # ====Parameters
         #
-        # +dataset+::    (Dataset, NDArray or array)
+        # +dataset+::    (Dataset, IterableDataset, NDArray or array)
         #                Source. Note that instances of NDArray and
-        #                Array can be used directly.
+        #                Array can be used directly.  An IterableDataset
+        #                is read in order and batched as it streams,
+        #                without a sampler.
         # +shuffle+::    (boolean)
         #                Whether or not to shuffle the samples.
         # +batch_size+:: (integer)
@@ -27,15 +29,47 @@ module MXNet
         #                +:discard+, the last batch will be discarded.
         #                If +:rollover+, the remaining elements will
         #                be rolled over to the next iteration.
+        # +batch_transform+:: (callable, optional)
+        #                     Applied to each collated batch before it
+        #                     is returned, e.g. a transform in
+        #                     BatchTransforms.
+        # +shuffle_buffer+:: (integer, optional)
+        #                    For an IterableDataset, the size of the
+        #                    buffer through which samples are shuffled.
+        #                    Required if +shuffle+ is true.
+        # +trim_pool+:: (boolean, default false)
+        #               Whether to release the memory cached in the
+        #               CPU storage pool after each epoch.  See
+        #               Memory.release_cached.
         #
         def initialize(dataset, batch_size: nil, shuffle: false, sampler: nil,
                        last_batch: nil, batch_sampler: nil, batchify_fn: nil,
-                       num_workers: 0)
+                       batch_transform: nil, shuffle_buffer: nil, num_workers: 0,
+                       trim_pool: false)
           @dataset = dataset
+          @trim_pool = trim_pool
           @pin_memory = false  # TODO
           @thread_pool = false  # TODO
 
-          if batch_sampler.nil?
+          if dataset.is_a?(IterableDataset)
+            unless batch_size
+              raise ArgumentError, "batch_size must be specified for IterableDataset"
+            end
+            if sampler || batch_sampler
+              raise ArgumentError, "IterableDataset cannot be used with a sampler"
+            end
+            unless [nil, :keep, :discard].include?(last_batch)
+              raise ArgumentError, "last_batch must be either :keep or :discard for IterableDataset"
+            end
+            if shuffle && shuffle_buffer.nil?
+              raise ArgumentError, "shuffle_buffer must be specified to shuffle IterableDataset"
+            end
+            @dataset = dataset.shuffle(shuffle_buffer) if shuffle_buffer
+            @batch_size = batch_size
+            @last_batch = last_batch || :keep
+          elsif shuffle_buffer
+            raise ArgumentError, "shuffle_buffer is only for IterableDataset"
+          elsif batch_sampler.nil?
             unless batch_size
               raise ArgumentError, "batch_size must be specified unless " +
                     "batch_sampler is specified"
@@ -60,7 +94,11 @@ module MXNet
           end
 
           @batch_sampler = batch_sampler
+          @batch_transform = batch_transform
           @num_workers = [num_workers, 0].max
+          # Datasets that can read a whole batch at once (e.g. MmapDataset)
+          # skip per-sample collation unless batchify_fn is given.
+          @dataset_batch = batchify_fn.nil? && @dataset.respond_to?(:get_batch)
           if batchify_fn.nil?
             if num_workers > 0
               # @batchify_fn = method(:default_mp_batchify_fn)
@@ -76,10 +114,20 @@ module MXNet
         def each
           return enum_for unless block_given?
 
-          if @num_workers == 0
+          if @batch_sampler.nil?
+            each_streaming_batch {|ret| yield ret }
+          elsif @num_workers == 0
             @batch_sampler.each do |batch|
-              data = batch.map {|i| @dataset[i] }
-              ret = @batchify_fn.(data)
+              ret = MXNet::Stats.time(:batch_wait) do
+                MXNet::Profiler.span('DataLoader#batch', category: 'data') do
+                  if @dataset_batch
+                    MXNet::Stats.time(:batchify) { transform_batch(@dataset.get_batch(batch)) }
+                  else
+                    data = batch.map {|i| @dataset[i] }
+                    MXNet::Stats.time(:batchify) { transform_batch(@batchify_fn.(data)) }
+                  end
+                end
+              end
               if @pin_memory
                 # TODO: pin_memory
               end
@@ -88,14 +136,47 @@ module MXNet
           else
             raise NotImplementedError, "TODO: support multiple workers"
           end
+          MXNet::Memory.release_cached(gc: true) if @trim_pool
         end
 
         def length
+          if @batch_sampler.nil?
+            raise TypeError, "the length of a DataLoader over IterableDataset is unknown"
+          end
           @batch_sampler.length
         end
 
         private
 
+        # Batches samples of an IterableDataset as they arrive.  Only the
+        # current batch is held besides what the dataset buffers.
+        def each_streaming_batch
+          data = []
+          start = MXNet::Stats.clock if MXNet::Stats.enabled?
+          @dataset.each do |sample|
+            data << sample
+            next if data.length < @batch_size
+            ret = MXNet::Profiler.span('DataLoader#batch', category: 'data') do
+              MXNet::Stats.time(:batchify) { transform_batch(@batchify_fn.(data)) }
+            end
+            MXNet::Stats.record(:batch_wait, MXNet::Stats.clock - start) if start
+            yield ret
+            start = MXNet::Stats.clock if MXNet::Stats.enabled?
+            data = []
+          end
+          unless data.empty? || @last_batch == :discard
+            ret = MXNet::Profiler.span('DataLoader#batch', category: 'data') do
+              MXNet::Stats.time(:batchify) { transform_batch(@batchify_fn.(data)) }
+            end
+            MXNet::Stats.record(:batch_wait, MXNet::Stats.clock - start) if start
+            yield ret
+          end
+        end
+
+        def transform_batch(ret)
+          @batch_transform ? @batch_transform.(ret) : ret
+        end
+
         # Collate data into batch.
         def default_batchify_fn(data)
           case data[0]
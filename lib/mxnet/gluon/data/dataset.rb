@@ -1,4 +1,5 @@
 require 'mxnet/gluon/data'
+require 'json'
 
 module MXNet::Gluon::Data
   class Dataset
@@ -31,6 +32,20 @@ module MXNet::Gluon::Data
     def transform_first(lazy: true)
       transform(lazy: lazy) {|x, *rest| [yield(x), *rest] }
     end
+
+    # Returns a CachedDataset, which stores the samples of this dataset
+    # during the first pass and serves later epochs from the store.
+    #
+    # ====Parameters
+    #
+    # +storage+:: (+:memory+ or +:mmap+, default +:memory+)
+    #             Where to store the samples.
+    # +path+::    (string)
+    #             The file for +:mmap+ storage.
+    #
+    def cache(storage: :memory, path: nil)
+      CachedDataset.new(self, storage: storage, path: path)
+    end
   end
 
   class SimpleDataset < Dataset
@@ -75,8 +90,16 @@ module MXNet::Gluon::Data
     end
   end
 
+  # Base class for datasets downloaded under +root+.
+  #
+  # Subclasses load +@data+ and +@label+ in #_get_data.  When a subclass
+  # defines #_cache_key, the decoded +@data+ and +@label+ are also saved
+  # under +root+ by NDArray.save, along with a sidecar JSON file holding the
+  # key.  While the key matches, later instances load the cache instead of
+  # calling #_get_data, so the source files are neither re-hashed nor
+  # decoded again.
   class DownloadedDataset < Dataset
-    def initialize(root:, transform:)
+    def initialize(root:, transform:, cache: true)
       super()
       @transform = transform
       @data = nil
@@ -84,11 +107,23 @@ module MXNet::Gluon::Data
       root = File.expand_path(root)
       @root = -root
       FileUtils.mkdir_p(root) unless File.directory?(root)
-      _get_data
+      if cache && _cache_key
+        unless _load_cache
+          _get_data
+          _save_cache
+        end
+      else
+        _get_data
+      end
     end
 
     attr_reader :root
 
+    # The path of the decoded cache, which can be read by NDArray.load.
+    def cache_path
+      File.join(@root, "#{_cache_name}.nd")
+    end
+
     def length
       @label.length
     end
@@ -104,5 +139,78 @@ module MXNet::Gluon::Data
     private def _get_data
       raise NotImplementedError
     end
+
+    # Returns a String identifying the source of the data, such as the
+    # hashes of the source files, or +nil+ to disable caching.  The default
+    # key is made of the names, sizes and mtimes of #_source_files.
+    private def _cache_key
+      _source_files.sort.map {|path|
+        stat = File.stat(path)
+        "#{File.basename(path)}:#{stat.size}:#{stat.mtime.to_i}"
+      }.join(';')
+    end
+
+    # Returns the paths of the downloaded files the data is decoded from.
+    # The default is the regular files under root, except the decoded
+    # caches.
+    private def _source_files
+      Dir.children(@root).map {|name| File.join(@root, name) }.select do |path|
+        File.file?(path) && !path.match?(/\.nd(?:\.json|\.tmp\d+)?\z/)
+      end
+    end
+
+    private def _cache_name
+      self.class.name.split('::').last.downcase
+    end
+
+    private def _load_cache
+      sidecar = "#{cache_path}.json"
+      return false unless File.file?(cache_path) && File.file?(sidecar)
+      meta = JSON.parse(::IO.read(sidecar))
+      return false unless meta.is_a?(Hash) && meta['types'].is_a?(Hash)
+      return false unless meta['key'] == _cache_key && meta['size'] == File.size(cache_path)
+      types = meta['types'].values_at('data', 'label')
+      return false unless types.all? {|type| type.is_a?(String) }
+      loaded = MXNet::NDArray.load(cache_path)
+      return false unless loaded.is_a?(Hash) && loaded.key?('data') && loaded.key?('label')
+      @data = _restore_cached(loaded['data'], types[0])
+      @label = _restore_cached(loaded['label'], types[1])
+      true
+    rescue JSON::ParserError, SystemCallError, MXNet::Error
+      false
+    end
+
+    private def _save_cache
+      require 'mxnet/narray_helper'
+      arrays = {'data' => @data, 'label' => @label}
+      types = arrays.map {|k, v| [k, v.class.name] }.to_h
+      arrays.transform_values! do |v|
+        case v
+        when MXNet::NDArray
+          v
+        when ::Numo::NArray
+          dtype = MXNet::NArrayHelper::MXNET_DTYPE_TO_NUMO.key(v.class)
+          return false unless dtype
+          MXNet::NArrayHelper.to_ndarray(v, ctx: MXNet.cpu, dtype: dtype)
+        else
+          return false
+        end
+      end
+      tmp_path = "#{cache_path}.tmp#{Process.pid}"
+      MXNet::NDArray.save(tmp_path, arrays)
+      File.rename(tmp_path, cache_path)
+      meta = {key: _cache_key, size: File.size(cache_path), types: types}
+      ::IO.write("#{cache_path}.json", JSON.generate(meta))
+      true
+    rescue SystemCallError, MXNet::Error
+      File.unlink(tmp_path) if tmp_path && File.exist?(tmp_path)
+      false
+    end
+
+    private def _restore_cached(ndarray, type)
+      return ndarray unless type.start_with?('Numo::')
+      require 'mxnet/narray_helper'
+      ndarray.to_narray
+    end
   end
 end
@@ -0,0 +1,166 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # Base class for datasets that can only be read sequentially, such as
+  # streams and sharded files.  Subclasses define #each.
+  #
+  # DataLoader reads an IterableDataset in order and batches the samples
+  # as they arrive, without a sampler.
+  #
+  #     sources = Dir['logs/part-*'].map {|path| File.foreach(path) }
+  #     dataset = MXNet::Gluon::Data::InterleavedDataset.new(sources, num_threads: 4)
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 256, shuffle_buffer: 10_000,
+  #                                                 batchify_fn: ->(lines) { parse(lines) })
+  #
+  class IterableDataset
+    include Enumerable
+
+    # Wraps an Enumerable, e.g. an Enumerator over a stream.
+    def self.from(enumerable)
+      EnumerableDataset.new(enumerable)
+    end
+
+    def each
+      raise NotImplementedError
+    end
+
+    # Returns a dataset that shuffles this one through a buffer of
+    # +buffer_size+ samples.  See ShuffledDataset.
+    def shuffle(buffer_size, seed: nil)
+      ShuffledDataset.new(self, buffer_size, seed: seed)
+    end
+
+    # Returns a dataset that applies the given block to each sample.
+    def transform(&fn)
+      EnumerableDataset.new(lazy.map(&fn))
+    end
+  end
+
+  # An IterableDataset over an Enumerable.
+  class EnumerableDataset < IterableDataset
+    def initialize(enumerable)
+      @enumerable = enumerable
+    end
+
+    def each(&block)
+      return enum_for unless block_given?
+      @enumerable.each(&block)
+      self
+    end
+  end
+
+  # Shuffles a stream through a bounded buffer.  The first +buffer_size+
+  # samples fill the buffer, and then each new sample replaces a randomly
+  # chosen one, which is yielded.  At most +buffer_size+ samples are held
+  # at a time; a larger buffer gives a more uniform shuffle.
+  class ShuffledDataset < IterableDataset
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +dataset+::     (IterableDataset or Enumerable)
+    #                 The source stream.
+    # +buffer_size+:: (integer)
+    #                 The size of the shuffle buffer.
+    # +seed+::        (integer, optional)
+    #                 The seed of the shuffle.  Every #each starts over
+    #                 from the seed when given.
+    #
+    def initialize(dataset, buffer_size, seed: nil)
+      raise ArgumentError, "buffer_size must be positive" unless buffer_size > 0
+      @dataset = dataset
+      @buffer_size = buffer_size
+      @seed = seed
+    end
+
+    attr_reader :buffer_size
+
+    def each
+      return enum_for unless block_given?
+      rng = @seed ? ::Random.new(@seed) : ::Random.new
+      buffer = []
+      @dataset.each do |sample|
+        if buffer.length < @buffer_size
+          buffer << sample
+        else
+          j = rng.rand(@buffer_size)
+          yield buffer[j]
+          buffer[j] = sample
+        end
+      end
+      buffer.shuffle!(random: rng)
+      buffer.each {|sample| yield sample }
+      self
+    end
+  end
+
+  # Reads multiple sources on background threads and yields their samples
+  # interleaved in the order they arrive.
+  #
+  # Source +i+ is read by thread <tt>i % num_threads</tt>, and the threads
+  # push samples into one queue of +prefetch+ samples, so at most
+  # +prefetch+ samples are in flight.  Sources are typically Enumerators
+  # over IO, such as <tt>File.foreach(path)</tt>, whose reads release the
+  # GVL.  An exception raised in a source is re-raised by #each.
+  class InterleavedDataset < IterableDataset
+    DONE = Object.new.freeze
+    private_constant :DONE
+
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +sources+::     (array of Enumerables)
+    #                 The sources, each of which responds to #each.
+    # +num_threads+:: (integer, default the number of sources)
+    #                 The number of reading threads.
+    # +prefetch+::    (integer, default 256)
+    #                 The capacity of the queue between the threads and
+    #                 the consumer.
+    #
+    def initialize(sources, num_threads: nil, prefetch: 256)
+      @sources = sources.to_a
+      @num_threads = [[num_threads || @sources.length, @sources.length].min, 1].max
+      @prefetch = prefetch
+    end
+
+    def each
+      return enum_for unless block_given?
+      return self if @sources.empty?
+      queue = SizedQueue.new(@prefetch)
+      threads = Array.new(@num_threads) do |t|
+        Thread.new do
+          begin
+            @sources.each_with_index do |source, i|
+              next unless i % @num_threads == t
+              source.each {|sample| queue.push([sample]) }
+            end
+            queue.push(DONE)
+          rescue ClosedQueueError
+          rescue Exception => e
+            queue.push(e) rescue nil
+          end
+        end
+      end
+      running = threads.length
+      while running > 0
+        item = queue.pop
+        case item
+        when DONE
+          running -= 1
+        when Exception
+          raise item
+        else
+          yield item[0]
+        end
+      end
+      self
+    ensure
+      if queue
+        queue.close
+        queue.clear
+        threads.each {|thread| thread.kill.join }
+      end
+    end
+  end
+end
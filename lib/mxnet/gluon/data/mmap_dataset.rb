@@ -0,0 +1,303 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # A dataset of fixed-shape records stored in a raw tensor file, which is
+  # read through mmap.  Opening the file costs only the header parse, and
+  # the resident memory is bounded by the pages actually touched.
+  #
+  # The file consists of a header followed by one payload region per field.
+  # All integers are little-endian.
+  #
+  #     offset  size  content
+  #     0       8     magic "MXRAWDS\0"
+  #     8       4     version (1)
+  #     12      4     number of fields
+  #     16      8     number of records
+  #     24      ...   field descriptors
+  #
+  # Each field descriptor is
+  #
+  #     4       dtype id (see MXNet::DType)
+  #     4       ndim
+  #     8       record stride in bytes
+  #     8       payload offset in bytes
+  #     4*ndim  shape of a record
+  #
+  # and the i-th record of a field is the +stride+ bytes at
+  # <tt>offset + i * stride</tt>.  Payload regions are aligned to
+  # PAYLOAD_ALIGNMENT bytes.
+  #
+  # A sample of a dataset with one field is an NDArray, and a sample of a
+  # dataset with multiple fields is an Array of them.  A field with an empty
+  # shape holds scalars, which are returned as Ruby numbers.
+  #
+  #     MXNet::Gluon::Data::MmapDataset.write('mnist-train.raw', MXNet::Gluon::Data::Vision::MNIST.new)
+  #     dataset = MXNet::Gluon::Data::MmapDataset.new('mnist-train.raw')
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 100, shuffle: true)
+  #
+  class MmapDataset < Dataset
+    MAGIC = "MXRAWDS\0".b.freeze
+    VERSION = 1
+    PAYLOAD_ALIGNMENT = 4096
+
+    PACK_FORMATS = {
+      float32: 'e',
+      float64: 'E',
+      uint8: 'C',
+      int32: 'l<',
+      int8: 'c',
+      int64: 'q<',
+    }.freeze
+
+    Field = Struct.new(:dtype, :shape, :stride, :offset)
+
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +path+:: (string)
+    #          Path to a file written by MmapDataset.write.
+    #
+    def initialize(path)
+      super()
+      @file = MXNet::MappedFile.new(path)
+      read_header
+    end
+
+    attr_reader :fields
+
+    def path
+      @file.path
+    end
+
+    def length
+      @length
+    end
+
+    def [](idx)
+      idx = normalize_index(idx)
+      items = @fields.map {|field| read_record(field, idx) }
+      items.length == 1 ? items[0] : items
+    end
+
+    # Reads the records at the given indices into one NDArray per field,
+    # uploading them straight from the mapping.  DataLoader uses this
+    # instead of collating samples one by one.
+    #
+    # ====Parameters
+    #
+    # +indices+:: (array of integers)
+    #             Sample indices.  Negative indices count from the end.
+    #
+    def get_batch(indices)
+      indices = indices.map {|idx| normalize_index(idx) }
+      items = @fields.map do |field|
+        out = MXNet::NDArray.empty([indices.length, *field.shape], dtype: field.dtype)
+        @file.copy_to(out, field.offset, field.stride, indices)
+      end
+      items.length == 1 ? items[0] : items
+    end
+
+    def close
+      @file.close
+    end
+
+    private def normalize_index(idx)
+      idx += @length if idx < 0
+      unless 0 <= idx && idx < @length
+        raise IndexError, "index #{idx} is out of range for #{@length} records"
+      end
+      idx
+    end
+
+    private def read_record(field, idx)
+      if field.shape.empty?
+        bytes = @file.read(field.offset + idx * field.stride, field.stride)
+        bytes.unpack1(PACK_FORMATS.fetch(field.dtype))
+      else
+        out = MXNet::NDArray.empty(field.shape, dtype: field.dtype)
+        @file.copy_to(out, field.offset, field.stride, [idx])
+      end
+    end
+
+    private def read_header
+      if @file.size < 24 || @file.read(0, 8) != MAGIC
+        raise ArgumentError, "#{path} is not a raw tensor dataset"
+      end
+      version, num_fields, @length = @file.read(8, 16).unpack('L<L<Q<')
+      unless version == VERSION
+        raise ArgumentError, "unsupported version of raw tensor dataset: #{version}"
+      end
+      pos = 24
+      @fields = Array.new(num_fields) do
+        dtype_id, ndim, stride, offset = @file.read(pos, 24).unpack('l<L<Q<Q<')
+        shape = @file.read(pos + 24, 4 * ndim).unpack('L<*')
+        pos += 24 + 4 * ndim
+        Field.new(MXNet::DType.id2name(dtype_id), shape, stride, offset)
+      end
+    end
+
+    # Converts a dataset into the raw tensor format.  Samples are fetched and
+    # written one by one, so the dataset never has to fit in memory.  The
+    # dtype and shape of each field are taken from the first sample.
+    #
+    # ====Parameters
+    #
+    # +path+::    (string)
+    #             Path of the output file.
+    # +dataset+:: (Dataset)
+    #             The source dataset.
+    # +dtypes+::  (array of symbols, optional)
+    #             The dtype of each field.  By default NDArrays and
+    #             Numo::NArrays keep their own dtypes, Integers are stored
+    #             as int32 and Floats as float32.
+    #
+    # Raises ArgumentError if +dataset+ is empty, as there is no sample to
+    # take the fields from.
+    #
+    def self.write(path, dataset, dtypes: nil)
+      if dataset.length == 0
+        raise ArgumentError, "cannot write an empty dataset"
+      end
+      Writer.new(path, dataset.length, dataset[0], dtypes: dtypes).tap do |writer|
+        begin
+          dataset.length.times {|i| writer.write(i, dataset[i]) }
+        rescue Exception
+          writer.abort
+          raise
+        end
+        writer.close
+      end
+      path
+    end
+
+    # Writes records into a raw tensor file.
+    #
+    # The file is written to a temporary path, and renamed to +path+ when
+    # closed.
+    class Writer
+      def initialize(path, length, sample, dtypes: nil)
+        @path = path
+        @tmp_path = "#{path}.tmp#{Process.pid}"
+        @length = length
+        values = sample.is_a?(Array) ? sample : [sample]
+        dtypes ||= []
+        @fields = values.map.with_index do |value, i|
+          dtype = (dtypes[i] || infer_dtype(value)).to_sym
+          unless MXNet::DType.available?(dtype)
+            raise ArgumentError, "invalid dtype: #{dtype}"
+          end
+          shape = infer_shape(value)
+          stride = shape.inject(1, :*) * dtype_size(dtype)
+          Field.new(dtype, shape, stride, nil)
+        end
+        header_size = 24 + @fields.sum {|f| 24 + 4 * f.shape.length }
+        offset = align(header_size)
+        @fields.each do |field|
+          field.offset = offset
+          offset = align(offset + field.stride * length)
+        end
+        @io = File.open(@tmp_path, 'wb')
+        @io.write(header)
+        @io.truncate(offset)
+      end
+
+      # Returns an MmapDataset reading the records written so far.  The
+      # mapping stays valid after the file is renamed by #close.
+      def reader
+        @io.flush
+        MmapDataset.new(@tmp_path)
+      end
+
+      # Writes the +idx+-th sample.
+      def write(idx, sample)
+        values = @fields.length == 1 ? [sample] : sample
+        unless values.is_a?(Array) && values.length == @fields.length
+          raise ArgumentError, "sample #{idx} does not have #{@fields.length} fields"
+        end
+        @fields.zip(values) do |field, value|
+          bytes = to_bytes(value, field.dtype)
+          unless bytes.bytesize == field.stride
+            raise ArgumentError,
+                  "sample #{idx} has #{bytes.bytesize} bytes " +
+                  "(expected #{field.stride} bytes for #{field.dtype} #{field.shape})"
+          end
+          @io.pwrite(bytes, field.offset + idx * field.stride)
+        end
+      end
+
+      def close
+        @io.close
+        File.rename(@tmp_path, @path)
+      end
+
+      def abort
+        @io.close unless @io.closed?
+        File.unlink(@tmp_path) if File.exist?(@tmp_path)
+      end
+
+      private def header
+        [MAGIC, VERSION, @fields.length, @length].pack('a8L<L<Q<').tap do |s|
+          @fields.each do |field|
+            dtype_id = MXNet::DType.name2id(field.dtype)
+            s << [dtype_id, field.shape.length, field.stride, field.offset].pack('l<L<Q<Q<')
+            s << field.shape.pack('L<*')
+          end
+        end
+      end
+
+      private def align(offset)
+        (offset + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT
+      end
+
+      private def dtype_size(dtype)
+        dtype == :float16 ? 2 : [0].pack(PACK_FORMATS.fetch(dtype)).bytesize
+      end
+
+      private def infer_dtype(value)
+        case value
+        when MXNet::NDArray
+          value.dtype
+        when Integer
+          :int32
+        when Float
+          :float32
+        else
+          require 'mxnet/narray_helper'
+          if value.is_a?(::Numo::NArray)
+            pair = MXNet::NArrayHelper::MXNET_DTYPE_TO_NUMO.find {|_, klass| klass && value.is_a?(klass) }
+            return pair[0] if pair
+          end
+          raise ArgumentError, "unsupported type of sample field: #{value.class}"
+        end
+      end
+
+      private def infer_shape(value)
+        case value
+        when Numeric
+          []
+        else
+          value.shape.to_a
+        end
+      end
+
+      private def to_bytes(value, dtype)
+        case value
+        when Numeric
+          [value].pack(PACK_FORMATS.fetch(dtype))
+        else
+          require 'mxnet/narray_helper'
+          numo_class = MXNet::NArrayHelper::MXNET_DTYPE_TO_NUMO[dtype]
+          unless numo_class
+            raise ArgumentError, "writing #{dtype} fields is unsupported"
+          end
+          if value.is_a?(MXNet::NDArray)
+            value = value.as_type(dtype) unless value.dtype == dtype
+            value = value.to_narray
+          end
+          numo_class.cast(value).to_binary
+        end
+      end
+    end
+  end
+end
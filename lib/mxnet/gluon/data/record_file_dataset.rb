@@ -0,0 +1,100 @@
+require 'mxnet/gluon/data'
+require 'mxnet/recordio'
+
+module MXNet::Gluon::Data
+  # A dataset wrapping over a RecordIO file.  Each sample is the raw
+  # record as a String.
+  #
+  # Random access goes through the index file written next to the record
+  # file (+foo.rec+ and +foo.idx+).  Every thread, and every process after
+  # fork, opens its own reader, so that the dataset can be shared by
+  # DataLoader workers.  Call #close to close the readers of all threads.
+  #
+  #     dataset = MXNet::Gluon::Data::RecordFileDataset.new('train.rec')
+  #     header, image = MXNet::RecordIO.unpack(dataset[0])
+  #
+  class RecordFileDataset < Dataset
+    # The thread variable holding the readers of the current thread, keyed
+    # by the token of each dataset.
+    READERS_KEY = :__mxnet_record_file_dataset_readers__
+
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +filename+:: (string)
+    #              Path to the RecordIO file.  The index file is the same
+    #              path with the extension replaced with ".idx".
+    #
+    def initialize(filename)
+      super()
+      @filename = filename
+      @idx_file = File.join(File.dirname(filename), File.basename(filename, '.*') + '.idx')
+      @mutex = Mutex.new
+      @readers = {}
+      @pid = Process.pid
+      @token = Object.new
+      @closed = false
+      @keys = reader.keys
+    end
+
+    attr_reader :filename, :idx_file
+
+    # Closes the readers opened by all threads.
+    def close
+      @mutex.synchronize do
+        next if @closed
+        @closed = true
+        @readers.each do |thread, rec|
+          thread.thread_variable_get(READERS_KEY)&.delete(@token)
+          rec.close
+        end
+        @readers.clear
+      end
+      nil
+    end
+
+    def closed?
+      @closed
+    end
+
+    def length
+      @keys.length
+    end
+
+    def [](idx)
+      reader.read_idx(@keys.fetch(idx))
+    end
+
+    # Returns the reader of the current thread, which is kept in a thread
+    # variable so that the common path takes no lock.  The readers of dead
+    # threads are closed when a new reader is opened.  The token, unlike
+    # object_id, is never reused while a thread holds a reader for it.
+    private def reader
+      readers = Thread.current.thread_variable_get(READERS_KEY)
+      pid, rec = readers[@token] if readers
+      return rec if pid == Process.pid && !@closed
+      @mutex.synchronize do
+        raise IOError, 'closed dataset' if @closed
+        unless @pid == Process.pid
+          # Readers inherited through fork share file offsets with the parent.
+          @readers.each_value(&:close)
+          @readers.clear
+          @pid = Process.pid
+        end
+        @readers.delete_if do |thread, r|
+          next false if thread.alive?
+          r.close
+          true
+        end
+        rec = @readers[Thread.current] = MXNet::IndexedRecordIO.new(@idx_file, @filename, 'r')
+      end
+      unless readers
+        readers = {}.compare_by_identity
+        Thread.current.thread_variable_set(READERS_KEY, readers)
+      end
+      readers[@token] = [Process.pid, rec]
+      rec
+    end
+  end
+end
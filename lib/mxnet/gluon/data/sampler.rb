@@ -137,6 +137,239 @@ module MXNet
           end
         end
       end
+
+      # Samples elements from [0, length) in a pseudo-random order without
+      # materializing the permutation, and optionally splits them into
+      # disjoint shards for data-parallel training.
+      #
+      # The permutation is a keyed Feistel network over the smallest
+      # power-of-four domain covering +length+, with cycle-walking to stay
+      # inside [0, length), so memory usage is constant.  The keys are
+      # derived from +seed+ and the epoch number, which makes every epoch
+      # reproducible and different from the others.  Shard +shard_id+
+      # takes every +num_shards+-th position of the permutation, so shards
+      # of the same epoch are disjoint and cover all the samples.
+      #
+      #     sampler = MXNet::Gluon::Data::ShardedRandomSampler.new(
+      #       dataset.length, num_shards: num_workers, shard_id: rank, seed: 42)
+      #
+      class ShardedRandomSampler < Sampler
+        ROUNDS = 4
+
+        # Creates a new instance.
+        #
+        # ====Parameters
+        #
+        # +length+::     (integer)
+        #                Length of the sequence.
+        # +num_shards+:: (integer, default 1)
+        #                The number of shards.
+        # +shard_id+::   (integer, default 0)
+        #                The shard to sample, in [0, num_shards).
+        # +seed+::       (integer, default 0)
+        #                The seed shared by all the shards.
+        # +epoch+::      (integer, default 0)
+        #                The epoch of the first #each.
+        #
+        def initialize(length, num_shards: 1, shard_id: 0, seed: 0, epoch: 0)
+          unless num_shards >= 1 && 0 <= shard_id && shard_id < num_shards
+            raise ArgumentError, "shard_id must be in [0, #{num_shards})"
+          end
+          @total = length
+          @num_shards = num_shards
+          @shard_id = shard_id
+          @seed = seed
+          @epoch = epoch
+          bits = [length - 1, 1].max.bit_length
+          @half_bits = (bits + 1) / 2
+          @half_mask = (1 << @half_bits) - 1
+        end
+
+        attr_reader :num_shards, :shard_id, :seed
+
+        # The epoch of the next #each, which is incremented by every #each.
+        # Set it to resume or replay an epoch.
+        attr_accessor :epoch
+
+        def length
+          @shard_id < @total ? (@total - @shard_id - 1) / @num_shards + 1 : 0
+        end
+
+        def each
+          return enum_for unless block_given?
+          keys = round_keys(@epoch)
+          @epoch += 1
+          pos = @shard_id
+          while pos < @total
+            yield permute(pos, keys)
+            pos += @num_shards
+          end
+        end
+
+        # Returns the sample at position +pos+ of the permutation of
+        # +epoch+, across all the shards.
+        def permutation(pos, epoch: @epoch)
+          unless 0 <= pos && pos < @total
+            raise IndexError, "position #{pos} is out of range for #{@total} samples"
+          end
+          permute(pos, round_keys(epoch))
+        end
+
+        private def round_keys(epoch)
+          rng = ::Random.new((@seed << 32) ^ epoch)
+          Array.new(ROUNDS) { rng.rand(1 << 32) }
+        end
+
+        private def permute(x, keys)
+          loop do
+            x = feistel(x, keys)
+            return x if x < @total
+          end
+        end
+
+        private def feistel(x, keys)
+          mask = @half_mask
+          l = x >> @half_bits
+          r = x & mask
+          i = 0
+          while i < ROUNDS
+            h = ((r ^ keys[i]) * 0x45d9f3b) & 0xffffffff
+            h = (((h >> 16) ^ h) * 0x45d9f3b) & 0xffffffff
+            l, r = r, (l ^ (h >> 16) ^ h) & mask
+            i += 1
+          end
+          (l << @half_bits) | r
+        end
+      end
+
+      # Groups samples of similar lengths into the same mini-batches, so
+      # that batches of variable-length sequences need little padding.
+      #
+      # Each sample is put in the bucket with the smallest key not less
+      # than its length, and every bucket is split into batches.  With
+      # +shuffle+, samples are shuffled within each bucket, and batches
+      # are shuffled across buckets.
+      #
+      #     lengths = dataset.map {|seq, _| seq.length }
+      #     sampler = MXNet::Gluon::Data::FixedBucketSampler.new(lengths, 32, num_buckets: 8, shuffle: true)
+      #     puts sampler.stats
+      #
+      class FixedBucketSampler < Sampler
+        # Creates a new instance.
+        #
+        # ====Parameters
+        #
+        # +lengths+::     (array of integers)
+        #                 Length of each sample.
+        # +batch_size+::  (integer)
+        #                 Size of mini-batch.
+        # +num_buckets+:: (integer, default 10)
+        #                 The number of buckets, whose keys are spaced
+        #                 evenly between the minimum and the maximum
+        #                 length.  Ignored if +bucket_keys+ is given.
+        # +bucket_keys+:: (array of integers, optional)
+        #                 The maximum length of each bucket.
+        # +shuffle+::     (boolean, default false)
+        #                 Whether to shuffle samples and batches.
+        # +last_batch+::  (+:keep+, +:discard+)
+        #                 Whether to keep or discard the last incomplete
+        #                 batch of each bucket.
+        #
+        def initialize(lengths, batch_size, num_buckets: 10, bucket_keys: nil,
+                       shuffle: false, last_batch: :keep)
+          unless [:keep, :discard].include?(last_batch)
+            raise ArgumentError, 'last_batch must be either :keep or :discard'
+          end
+          @lengths = lengths.to_a
+          @batch_size = batch_size
+          @shuffle = shuffle
+          @last_batch = last_batch
+          @bucket_keys = (bucket_keys || default_bucket_keys(num_buckets)).sort.uniq
+          if !@lengths.empty? && @lengths.max > @bucket_keys.last
+            raise ArgumentError, "the largest bucket key #{@bucket_keys.last} is " +
+                  "less than the maximum length #{@lengths.max}"
+          end
+          @buckets = Array.new(@bucket_keys.length) { [] }
+          @lengths.each_with_index do |len, i|
+            @buckets[@bucket_keys.bsearch_index {|key| key >= len }] << i
+          end
+        end
+
+        attr_reader :bucket_keys
+
+        def length
+          @buckets.sum {|bucket| num_batches(bucket.length) }
+        end
+
+        def each
+          return enum_for unless block_given?
+          batches = []
+          @buckets.each do |bucket|
+            bucket = bucket.shuffle if @shuffle
+            bucket.each_slice(@batch_size) do |batch|
+              next if batch.length < @batch_size && @last_batch == :discard
+              batches << batch
+            end
+          end
+          batches.shuffle! if @shuffle
+          batches.each {|batch| yield batch }
+        end
+
+        # Returns the statistics of the buckets as a Stats.  The padding
+        # efficiency is the ratio of the real elements to the padded
+        # elements when every sample is padded to its bucket key.  Pad
+        # pads a batch only to its longest sample, so the actual
+        # efficiency is at least this.
+        def stats
+          total_real = total_padded = 0
+          efficiencies = @buckets.each_with_index.map do |bucket, i|
+            real = bucket.sum {|j| @lengths[j] }
+            padded = @bucket_keys[i] * bucket.length
+            total_real += real
+            total_padded += padded
+            padded.zero? ? 1.0 : real.fdiv(padded)
+          end
+          Stats.new(@lengths.length, @batch_size, @bucket_keys,
+                    @buckets.map(&:length), @buckets.map {|b| num_batches(b.length) },
+                    length, total_padded.zero? ? 1.0 : total_real.fdiv(total_padded),
+                    efficiencies)
+        end
+
+        # Statistics of the buckets returned by FixedBucketSampler#stats.
+        # +padding_efficiency+ is overall, and the members starting with
+        # +bucket_+ are per bucket.  #to_s is a printable report.
+        Stats = Struct.new(:num_samples, :batch_size, :bucket_keys, :bucket_sizes,
+                           :bucket_num_batches, :num_batches, :padding_efficiency,
+                           :bucket_padding_efficiency) do
+          def to_s
+            lines = ["FixedBucketSampler: #{num_samples} samples, " +
+                     "#{num_batches} batches, batch_size=#{batch_size}, " +
+                     "padding efficiency #{'%.1f%%' % (100 * padding_efficiency)}"]
+            lines << '  key     size  batches  efficiency'
+            bucket_keys.each_with_index do |key, i|
+              lines << '  %-6d %5d %8d %10.1f%%' % [key, bucket_sizes[i], bucket_num_batches[i],
+                                                   100 * bucket_padding_efficiency[i]]
+            end
+            lines.join("\n")
+          end
+        end
+
+        private def num_batches(size)
+          if @last_batch == :discard
+            size.div(@batch_size)
+          else
+            (size + @batch_size - 1).div(@batch_size)
+          end
+        end
+
+        private def default_bucket_keys(num_buckets)
+          return [0] if @lengths.empty?
+          min, max = @lengths.minmax
+          step = [(max - min).fdiv(num_buckets), 1].max
+          keys = (1..num_buckets).map {|i| (min + step * i).ceil }
+          (keys.select {|key| key < max } + [max]).uniq
+        end
+      end
     end
   end
 end
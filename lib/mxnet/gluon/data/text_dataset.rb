@@ -0,0 +1,200 @@
+require 'mxnet/gluon/data'
+require 'etc'
+
+module MXNet::Gluon::Data
+  # A dataset of the lines of a text file.  Each sample is a line without
+  # its line terminator; blank lines are skipped.
+  #
+  # The file is read through mmap, and the offsets of its lines are
+  # indexed in one pass when the dataset is opened.  The index is saved
+  # beside the file as <tt>"#{filename}.lineidx"</tt>, and reused while the
+  # size and the modification time of the file are unchanged.  Random
+  # access goes through the index, so memory usage does not depend on the
+  # size of the file.
+  #
+  class TextLineDataset < Dataset
+    INDEX_MAGIC = "MXLNIDX\0".b.freeze
+    INDEX_VERSION = 1
+    INDEX_HEADER_SIZE = 40
+
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +filename+::    (string)
+    #                 Path to the text file.
+    # +skip_header+:: (boolean, default false)
+    #                 Whether to skip the first non-blank line.
+    # +index_path+::  (string or false, optional)
+    #                 Path of the line index.  If false, the index is
+    #                 built in memory and not saved.
+    #
+    def initialize(filename, skip_header: false, index_path: nil)
+      super()
+      @filename = filename
+      @file = MXNet::MappedFile.new(filename)
+      @index_path = index_path.nil? ? "#{filename}.lineidx" : index_path
+      @index = load_index || build_index
+      @skip = skip_header ? 1 : 0
+      @length = [@index.bytesize / 8 - @skip, 0].max
+    end
+
+    attr_reader :filename, :index_path
+
+    def length
+      @length
+    end
+
+    def [](idx)
+      @file.read_line(line_offset(idx)).force_encoding(Encoding::UTF_8)
+    end
+
+    def close
+      @file.close
+    end
+
+    # Returns the position of the +idx+-th sample in the line index.
+    private def line_number(idx)
+      idx += @length if idx < 0
+      unless 0 <= idx && idx < @length
+        raise IndexError, "index #{idx} is out of range for #{@length} lines"
+      end
+      idx + @skip
+    end
+
+    private def line_offset(idx)
+      @index.byteslice(8 * line_number(idx), 8).unpack1('Q')
+    end
+
+    private def index_stamp
+      stat = File.stat(@filename)
+      [stat.size, stat.mtime.tv_sec, stat.mtime.tv_nsec]
+    end
+
+    private def load_index
+      return nil unless @index_path && File.file?(@index_path)
+      File.open(@index_path, 'rb') do |io|
+        header = io.read(INDEX_HEADER_SIZE)
+        return nil unless header && header.bytesize == INDEX_HEADER_SIZE
+        magic, version, _, size, sec, nsec = header.unpack('a8L<L<Q<q<Q<')
+        return nil unless magic == INDEX_MAGIC && version == INDEX_VERSION
+        return nil unless [size, sec, nsec] == index_stamp
+        io.read || ''.b
+      end
+    rescue SystemCallError
+      nil
+    end
+
+    private def build_index
+      index = @file.line_index
+      save_index(index) if @index_path
+      index
+    end
+
+    private def save_index(index)
+      header = [INDEX_MAGIC, INDEX_VERSION, 0, *index_stamp].pack('a8L<L<Q<q<Q<')
+      tmp_path = "#{@index_path}.tmp#{Process.pid}"
+      File.open(tmp_path, 'wb') do |io|
+        io.write(header)
+        io.write(index)
+      end
+      File.rename(tmp_path, @index_path)
+    rescue SystemCallError
+      # The index is only a cache; a read-only directory is not an error.
+      File.unlink(tmp_path) if tmp_path && File.exist?(tmp_path)
+    end
+  end
+
+  # A dataset of numeric delimited text, such as CSV and TSV files.
+  #
+  # A sample is an NDArray of the data columns of a line, or a pair of
+  # NDArrays when +label_columns+ is given.  Empty fields are read as NaN,
+  # and raise ArgumentError for an integer dtype.
+  # Quoted fields are accepted as long as they do not contain the
+  # delimiter.
+  #
+  # #get_batch parses the lines of a batch on native threads straight into
+  # the batch buffer, and DataLoader uses it instead of collating samples.
+  #
+  #     dataset = MXNet::Gluon::Data::CSVDataset.new('clicks.tsv', delimiter: "\t",
+  #                                                  label_columns: [0], skip_header: true)
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 1024, shuffle: true)
+  #
+  class CSVDataset < TextLineDataset
+    # Creates a new instance.
+    #
+    # ====Parameters
+    #
+    # +filename+::      (string)
+    #                   Path to the file.
+    # +delimiter+::     (string, default ",")
+    #                   The field delimiter, a single byte.
+    # +data_columns+::  (array of integers, optional)
+    #                   Zero-based numbers of the data columns.  By default,
+    #                   all the columns but the label columns.
+    # +label_columns+:: (array of integers, optional)
+    #                   Zero-based numbers of the label columns.
+    # +dtype+::         (symbol, default :float32)
+    #                   The dtype of the data.
+    # +label_dtype+::   (symbol, default +dtype+)
+    #                   The dtype of the label.
+    # +skip_header+::   (boolean, default false)
+    #                   Whether to skip the first non-blank line.
+    # +num_threads+::   (integer, optional)
+    #                   The number of threads parsing a batch.  Defaults to
+    #                   the number of processors.
+    # +index_path+::    (string or false, optional)
+    #                   See TextLineDataset.new.
+    #
+    def initialize(filename, delimiter: ',', data_columns: nil, label_columns: nil,
+                   dtype: :float32, label_dtype: nil, skip_header: false,
+                   num_threads: nil, index_path: nil)
+      super(filename, skip_header: skip_header, index_path: index_path)
+      @delimiter = delimiter.b
+      unless @delimiter.bytesize == 1
+        raise ArgumentError, "delimiter must be a single byte: #{delimiter.inspect}"
+      end
+      @label_columns = label_columns && Array(label_columns)
+      @data_columns = data_columns ? Array(data_columns) : infer_data_columns
+      @dtype = dtype.to_sym
+      @label_dtype = (label_dtype || dtype).to_sym
+      @num_threads = num_threads || Etc.nprocessors
+    end
+
+    attr_reader :data_columns, :label_columns, :delimiter
+
+    def [](idx)
+      items = get_rows([line_number(idx)]).map {|x| x.reshape([x.shape[1]]) }
+      items.length == 1 ? items[0] : items
+    end
+
+    # Parses the lines at the given indices into NDArrays of shape
+    # <tt>[indices.length, columns.length]</tt>.
+    #
+    # ====Parameters
+    #
+    # +indices+:: (array of integers)
+    #             Sample indices.
+    #
+    def get_batch(indices)
+      items = get_rows(indices.map {|idx| line_number(idx) })
+      items.length == 1 ? items[0] : items
+    end
+
+    private def get_rows(rows)
+      fields = [[@data_columns, @dtype]]
+      fields << [@label_columns, @label_dtype] if @label_columns
+      fields.map do |columns, dtype|
+        out = MXNet::NDArray.empty([rows.length, columns.length], dtype: dtype)
+        @file.parse_lines(out, @index, rows, columns, @delimiter, @num_threads)
+      end
+    end
+
+    private def infer_data_columns
+      return [] if @index.empty?
+      first = @file.read_line(@index.unpack1('Q'))
+      num_columns = first.count(@delimiter) + 1
+      (0...num_columns).to_a - (@label_columns || [])
+    end
+  end
+end
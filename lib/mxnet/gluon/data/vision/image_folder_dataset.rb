@@ -0,0 +1,130 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  module Vision
+    # A dataset of images arranged in a folder per class:
+    #
+    #     root/car/0001.jpg
+    #     root/car/xxxa.png
+    #     root/bus/123.jpg
+    #
+    # Each sample is a pair of a decoded HWC uint8 image and its label, the
+    # index of its folder in #synsets.
+    #
+    # +transform+ is either a callable taking an image and a label, or a
+    # Vision::Transforms transform, which is applied to the image only.
+    # With a Transforms::Compose that starts with Resize or
+    # RandomResizedCrop, followed only by ToTensor and Normalize, #get_batch
+    # decodes, crops and resizes the images of a batch in one native call
+    # without the GVL, and runs the rest of the transforms on the whole
+    # NHWC batch, which ToTensor turns into NCHW float32.
+    # DataLoader uses #get_batch instead of collating samples.
+    #
+    #     transform = MXNet::Gluon::Data::Vision::Transforms::Compose.new(
+    #       MXNet::Gluon::Data::Vision::Transforms::RandomResizedCrop.new(224),
+    #       MXNet::Gluon::Data::Vision::Transforms::ToTensor.new
+    #     )
+    #     dataset = MXNet::Gluon::Data::Vision::ImageFolderDataset.new('train', transform: transform)
+    #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 64, shuffle: true)
+    #
+    class ImageFolderDataset < Dataset
+      EXTENSIONS = %w[.jpg .jpeg .png .bmp].freeze
+
+      # Creates a new instance.
+      #
+      # ====Parameters
+      #
+      # +root+::      (string)
+      #               Path to the root folder.
+      # +flag+::      (integer, default 1)
+      #               1 to decode images in RGB, 0 in grayscale.
+      # +transform+:: (callable or transform, optional)
+      #               The transform of samples.
+      #
+      def initialize(root, flag: 1, transform: nil)
+        super()
+        @root = File.expand_path(root)
+        @flag = flag
+        @transform = transform
+        @plan = native_plan(transform)
+        list_images
+      end
+
+      attr_reader :synsets, :items
+
+      def length
+        @items.length
+      end
+
+      def [](idx)
+        path, label = @items.fetch(idx)
+        img = decode(File.binread(path))
+        if @transform.nil?
+          [img, label]
+        elsif image_transform?(@transform)
+          [@transform.(img), label]
+        else
+          @transform.(img, label)
+        end
+      end
+
+      # Reads the images at the given indices as a batch.
+      #
+      # ====Parameters
+      #
+      # +indices+:: (array of integers)
+      #             Sample indices.
+      #
+      def get_batch(indices)
+        items = indices.map {|i| @items.fetch(i) }
+        label = MXNet::NDArray.array(items.map(&:last), dtype: :int32)
+        unless @plan
+          data = indices.map {|i| self[i][0] }
+          return [MXNet::NDArray.stack(*data), label]
+        end
+        resize, rest = @plan
+        buffers = items.map {|path, _| File.binread(path) }
+        out = MXNet::NDArray.empty([items.length, resize.height, resize.width, @flag == 0 ? 1 : 3],
+                                   dtype: :uint8, ctx: MXNet.cpu)
+        crops = resize.respond_to?(:random_params) ? items.map { resize.random_params } : nil
+        MXNet::Image._decode_batch(buffers, out, crops, resize.interpolation)
+        [rest.inject(out) {|x, t| t.(x) }, label]
+      end
+
+      private def decode(buf)
+        raw = MXNet::Image._from_buffer(buf)
+        MXNet::NDArray::Internal._cvimdecode(raw, flag: @flag, to_rgb: true)
+      end
+
+      private def image_transform?(transform)
+        transform.is_a?(Transforms::Transform)
+      end
+
+      # Returns [resize, batch_transforms] if the transform can run on
+      # batches, or nil.
+      private def native_plan(transform)
+        return nil unless transform && image_transform?(transform)
+        list = transform.is_a?(Transforms::Compose) ? transform.transforms : [transform]
+        return nil unless list[0].is_a?(Transforms::Resize)
+        rest = list[1..-1]
+        return nil unless rest.all? {|t| t.respond_to?(:batch_transform) }
+        [list[0], rest.map(&:batch_transform)]
+      end
+
+      private def list_images
+        @synsets = []
+        @items = []
+        Dir.children(@root).sort.each do |folder|
+          path = File.join(@root, folder)
+          next unless File.directory?(path)
+          label = @synsets.length
+          @synsets << folder
+          Dir.children(path).sort.each do |filename|
+            next unless EXTENSIONS.include?(File.extname(filename).downcase)
+            @items << [File.join(path, filename), label]
+          end
+        end
+      end
+    end
+  end
+end
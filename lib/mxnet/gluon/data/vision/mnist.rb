@@ -8,7 +8,7 @@ module MXNet::Gluon::Data
   module Vision
     class MNIST < DownloadedDataset
       def initialize(root: File.join('~', '.mxnet', 'datasets', 'mnist'),
-                     train: true, transform: nil)
+                     train: true, transform: nil, cache: true)
         @train = train
         @train_data = ['train-images-idx3-ubyte.gz',
                        '6c95f4b05d2bf285e1bfb0e7960c31bd3b3f8a7d']
@@ -19,11 +19,20 @@ module MXNet::Gluon::Data
         @test_label = ['t10k-labels-idx1-ubyte.gz',
                        '763e7fa3757d93b0cdec073cef058b2004252c17']
         @namespace = 'mnist'
-        super(root: root, transform: transform)
+        super(root: root, transform: transform, cache: cache)
       end
 
       attr_reader :train
 
+      private def _cache_name
+        "#{@namespace}-#{@train ? 'train' : 'test'}"
+      end
+
+      private def _cache_key
+        data, label = @train ? [@train_data, @train_label] : [@test_data, @test_label]
+        "#{data[1]}:#{label[1]}"
+      end
+
       private def _get_data
         if @train
           data, label = @train_data, @train_label
@@ -0,0 +1,142 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  module Vision
+    # Image transforms built on libmxnet's image operators.
+    #
+    # A transform takes an image NDArray, in HWC layout until ToTensor and
+    # CHW after it.  ImageFolderDataset runs a Compose that starts with
+    # Resize or RandomResizedCrop, followed only by ToTensor and Normalize,
+    # on whole batches: images are decoded, cropped and resized on native
+    # threads, and the tensor transforms run once per batch.
+    #
+    #     transform = MXNet::Gluon::Data::Vision::Transforms::Compose.new(
+    #       MXNet::Gluon::Data::Vision::Transforms::RandomResizedCrop.new(224),
+    #       MXNet::Gluon::Data::Vision::Transforms::ToTensor.new,
+    #       MXNet::Gluon::Data::Vision::Transforms::Normalize.new([0.485, 0.456, 0.406], [0.229, 0.224, 0.225])
+    #     )
+    #
+    module Transforms
+      # Base class for image transforms.  Subclasses define #call, which
+      # takes and returns an image.
+      class Transform
+        def call(img)
+          raise NotImplementedError
+        end
+      end
+
+      # Applies transforms in order.
+      class Compose < Transform
+        def initialize(*transforms)
+          @transforms = transforms
+        end
+
+        attr_reader :transforms
+
+        def call(img)
+          @transforms.inject(img) {|x, t| t.(x) }
+        end
+      end
+
+      # Resizes an image to the given size.
+      #
+      # ====Parameters
+      #
+      # +size+::          (integer or [width, height])
+      #                   The output size.
+      # +interpolation+:: (integer, default 1)
+      #                   The interpolation method of OpenCV; 1 is
+      #                   bilinear.
+      #
+      class Resize < Transform
+        def initialize(size, interpolation: 1)
+          @width, @height = size.is_a?(Array) ? size : [size, size]
+          @interpolation = interpolation
+        end
+
+        attr_reader :width, :height, :interpolation
+
+        def call(img)
+          MXNet::NDArray::Internal._cvimresize(img, w: @width, h: @height, interp: @interpolation)
+        end
+      end
+
+      # Crops a random area of an image and resizes it to the given size.
+      # The area covers a fraction in +scale+ of the image, with an aspect
+      # ratio in +ratio+ sampled uniformly in log space.  If the area does
+      # not fit in the image, the whole image is used.
+      #
+      # ====Parameters
+      #
+      # +size+::          (integer or [width, height])
+      #                   The output size.
+      # +scale+::         ([min, max], default [0.08, 1.0])
+      #                   The range of the area fraction.
+      # +ratio+::         ([min, max], default [3/4, 4/3])
+      #                   The range of the aspect ratio.
+      # +interpolation+:: (integer, default 1)
+      #                   The interpolation method of OpenCV.
+      #
+      class RandomResizedCrop < Resize
+        def initialize(size, scale: [0.08, 1.0], ratio: [3.0 / 4.0, 4.0 / 3.0], interpolation: 1)
+          super(size, interpolation: interpolation)
+          @scale = scale
+          @log_ratio = ratio.map {|r| Math.log(r) }
+        end
+
+        def call(img)
+          h, w = img.shape
+          y, x, ch, cw = crop_rect(random_params, h, w)
+          img = MXNet::NDArray.slice(img, begin: [y, x, 0], end: [y + ch, x + cw, img.shape[2]])
+          super(img)
+        end
+
+        # Returns random crop parameters <tt>[scale, log_ratio, rx, ry]</tt>
+        # in the form MXNet::Image._decode_batch takes.
+        def random_params
+          [rand(@scale[0]..@scale[1]), rand(@log_ratio[0]..@log_ratio[1]), rand, rand]
+        end
+
+        private def crop_rect(params, h, w)
+          area = params[0] * h * w
+          ratio = Math.exp(params[1])
+          cw = Math.sqrt(area * ratio).round
+          ch = Math.sqrt(area / ratio).round
+          return [0, 0, h, w] if cw < 1 || ch < 1 || cw > w || ch > h
+          [(params[3] * (h - ch)).floor, (params[2] * (w - cw)).floor, ch, cw]
+        end
+      end
+
+      # Converts an HWC image with values in [0, 255] into a float32 CHW
+      # tensor with values in [0, 1).
+      class ToTensor < Transform
+        def call(img)
+          MXNet::NDArray::Internal._image_to_tensor(img)
+        end
+
+        # The equivalent transform of NHWC batches.
+        def batch_transform
+          BatchTransforms::ToTensor.new
+        end
+      end
+
+      # Normalizes a CHW tensor with per-channel mean and standard
+      # deviation.
+      class Normalize < Transform
+        def initialize(mean, std)
+          @mean = Array(mean)
+          @std = Array(std)
+        end
+
+        def call(img)
+          MXNet::NDArray::Internal._image_normalize(img, mean: @mean, std: @std)
+        end
+
+        # The equivalent transform of NCHW batches.
+        def batch_transform
+          BatchTransforms::Normalize.new(@mean, @std, axis: 1)
+        end
+      end
+    end
+  end
+end
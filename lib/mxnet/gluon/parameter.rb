@@ -325,7 +325,7 @@ module MXNet
         end
 
         @_deferred_init = [init, ctx, default_init, nil]
-        _finish_deferred_init
+        MXNet::Engine.bulk(MXNet::Engine::DEFAULT_BULK_SIZE) { _finish_deferred_init }
       end
 
       # Re-assign Parameter to other contexts.
@@ -627,8 +627,10 @@ module MXNet
       def init(init: nil, ctx: nil, verbose: false, force_reinit: false)
         init ||= MXNet::Init::Uniform.new
         init.set_verbosity(verbose) if verbose
-        each do |_, v|
-          v.init(init: nil, ctx: ctx, default_init: init, force_reinit: force_reinit)
+        MXNet::Engine.bulk(MXNet::Engine::DEFAULT_BULK_SIZE) do
+          each do |_, v|
+            v.init(init: nil, ctx: ctx, default_init: init, force_reinit: force_reinit)
+          end
         end
       end
 
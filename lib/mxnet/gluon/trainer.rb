@@ -19,7 +19,21 @@ module MXNet
       #                      additional supported arguments.
       # +kvstore+::          ...
       # +compression_params+:: ...
-      def initialize(params, optimizer, optimizer_params: nil, kvstore: :device, compression_params: nil)
+      # +bulk_size+::        (integer, default Engine::DEFAULT_BULK_SIZE)
+      #                      The number of the update operations
+      #                      executed in a bulk segment by #step.  0
+      #                      disables bulk execution.
+      # +trim_pool+::        (boolean, default false)
+      #                      Whether #step releases the memory cached
+      #                      in the storage pools of the contexts of
+      #                      the parameters when the batch size changes.
+      #                      The pools are trimmed when two consecutive
+      #                      steps have the same batch size, which
+      #                      differs from the one before, so that a
+      #                      single smaller last batch of an epoch does
+      #                      not trigger it.  See Memory.release_cached.
+      def initialize(params, optimizer, optimizer_params: nil, kvstore: :device, compression_params: nil,
+                     bulk_size: MXNet::Engine::DEFAULT_BULK_SIZE, trim_pool: false)
         case params
         when Hash, ParameterDict
           params = params.values
@@ -46,6 +60,10 @@ module MXNet
         @kvstore = kvstore
         @update_on_kvstore = nil
         @distributed = nil # TODO:
+        @bulk_size = bulk_size
+        @trim_pool = trim_pool
+        @pool_batch_size = nil
+        @next_batch_size = nil
       end
 
       private def check_contexts
@@ -127,9 +145,36 @@ module MXNet
         init_kvstore unless @kv_initialized
 
         @optimizer.rescale_grad = @scale / batch_size
+        track_batch_size(batch_size) if @trim_pool
 
-        _all_reduce_grads
-        _update(ignore_stale_grad)
+        MXNet::Stats.time(:trainer_step) do
+          MXNet::Stats.time(:trainer_sync) { _all_reduce_grads }
+          MXNet::Stats.time(:trainer_update) do
+            MXNet::Engine.bulk(@bulk_size) { _update(ignore_stale_grad) }
+          end
+        end
+      end
+
+      # Trims the pools when a new batch size is used by two steps in a
+      # row.  A one-step change, such as the last batch of an epoch, is
+      # ignored.
+      private def track_batch_size(batch_size)
+        if @pool_batch_size.nil? || batch_size == @pool_batch_size
+          @pool_batch_size = batch_size
+          @next_batch_size = nil
+        elsif batch_size == @next_batch_size
+          trim_pool
+          @pool_batch_size = batch_size
+          @next_batch_size = nil
+        else
+          @next_batch_size = batch_size
+        end
+      end
+
+      # Releases the memory cached for the previous batch size, which
+      # buffers of the new size cannot reuse.
+      private def trim_pool
+        @contexts.each {|ctx| MXNet::Memory.release_cached(ctx, gc: true) }
       end
 
       private def _all_reduce_grads
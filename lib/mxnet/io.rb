@@ -32,6 +32,17 @@ module MXNet
       end
 
       attr_reader :data, :label, :pad, :index
+      attr_reader :bucket_key, :provide_data, :provide_label
+
+      # Rebinds the contents of this batch in place.  Used by iterators
+      # created with +reuse_batch: true+ to yield the same batch object.
+      def rebind(data, label: nil, pad: nil, index: nil)
+        @data = data
+        @label = label
+        @pad = pad
+        @index = index
+        self
+      end
 
       private def check_data(data)
         return unless data
@@ -59,16 +70,24 @@ module MXNet
       include Enumerable
 
       # @param batch_size: [Integer] The batch size, namely the number of items in the batch.
-      def initialize(batch_size: 0)
+      # @param reuse_batch: [true, false] Whether to yield the same DataBatch
+      #   object for every batch.  A reused batch is only valid until the next
+      #   call of #next_batch.
+      def initialize(batch_size: 0, reuse_batch: false)
         @batch_size = batch_size
+        @reuse_batch = reuse_batch
       end
 
       attr_reader :batch_size
 
+      def reuse_batch?
+        @reuse_batch
+      end
+
       def each
         return enum_for unless block_given?
 
-        while batch = self.next_batch
+        while batch = MXNet::Stats.time(:batch_wait) { self.next_batch }
           yield batch
         end
       ensure
@@ -81,7 +100,7 @@ module MXNet
       #   If the end of the data is reached, return `nil`.
       def next_batch
         if iter_next
-          DataBatch.new(current_data, label: current_label, pad: current_pad, index: current_index)
+          make_batch(current_data, label: current_label, pad: current_pad, index: current_index)
         end
       end
 
@@ -125,6 +144,17 @@ module MXNet
       def current_pad
         nil
       end
+
+      private def make_batch(data, label: nil, pad: nil, index: nil)
+        if @reuse_batch && @reused_batch
+          @reused_batch.rebind(data, label: label, pad: pad, index: index)
+        else
+          batch = DataBatch.new(data, label: label, pad: pad, index: index,
+                                provide_data: @provide_data, provide_label: @provide_label)
+          @reused_batch = batch if @reuse_batch
+          batch
+        end
+      end
     end
   end
 end
@@ -1,9 +1,25 @@
 module MXNet
   module IO
     # A ruby wrapper of a C++ data iterator.
+    #
+    # With +prefetch: n+, a native thread advances the underlying iterator
+    # ahead into +n+ reusable slots.  In this mode #next_batch returns the
+    # NDArrays of a slot, which stay valid until the following call of
+    # #next_batch, and DataBatch#index is a binary String of native uint64
+    # values (use <tt>unpack('Q*')</tt> to decode it).
+    #
+    # With +reuse_batch: true+, the same DataBatch is yielded for every batch,
+    # and the NDArray wrappers in it are rebound to the new handles instead of
+    # being allocated again.
     class MXDataIter < DataIter
-      def initialize(data_name: 'data', label_name: 'softmax_label', **)
+      def initialize(data_name: 'data', label_name: 'softmax_label', prefetch: nil, reuse_batch: false, **)
         @debug_skip_load = false
+        @prefetch = prefetch
+        @reuse_batch = reuse_batch
+        @data_list = nil
+        @label_list = nil
+        @current_batch = nil
+        _start_prefetch(prefetch) if prefetch
 
         # load the first batch to get shape information
         @first_batch = next_batch
@@ -14,7 +30,7 @@ module MXNet
         @provide_data = [DataDesc.new(data_name, data.shape, dtype: data.dtype)]
         @provide_label = [DataDesc.new(label_name, label.shape, dtype: label.dtype)]
 
-        super(batch_size: data.shape[0])
+        super(batch_size: data.shape[0], reuse_batch: reuse_batch)
       end
 
       def debug_skip_load
@@ -28,9 +44,12 @@ module MXNet
       def reset
         @debug_at_begin = true
         @first_batch = nil
+        @current_batch = nil
         _reset
       end
 
+      attr_reader :prefetch
+
       def next_batch
         if @debug_skip_load && !@debug_at_begin
           return DataBatch.new([current_data], label: [current_label], pad: current_pad, index: current_index)
@@ -41,26 +60,56 @@ module MXNet
           return batch
         end
         @debug_at_begin = false
+        if @prefetch
+          MXNet::Stats.gauge(:prefetch_occupancy, _prefetch_occupancy) if MXNet::Stats.enabled?
+          return unless (@current_batch = _prefetch_next)
+          data, label, pad, index = @current_batch
+          return DataBatch.new([data], label: [label], pad: pad, index: index) unless @reuse_batch
+          (@data_list ||= [nil])[0] = data
+          (@label_list ||= [nil])[0] = label
+          return make_batch(@data_list, label: @label_list, pad: pad, index: index)
+        end
         if _iter_next > 0
-          DataBatch.new([current_data], label: [current_label], pad: current_pad, index: current_index)
+          return DataBatch.new([current_data], label: [current_label], pad: current_pad, index: current_index) unless @reuse_batch
+          if @data_list
+            _current_data(@data_list[0])
+            _current_label(@label_list[0])
+          else
+            @data_list = [_current_data]
+            @label_list = [_current_label]
+          end
+          make_batch(@data_list, label: @label_list, pad: current_pad, index: current_index)
         end
       end
 
       def iter_next
         return true if @first_batch
+        if @prefetch
+          MXNet::Stats.gauge(:prefetch_occupancy, _prefetch_occupancy) if MXNet::Stats.enabled?
+          @current_batch = _prefetch_next
+          return !@current_batch.nil?
+        end
         _iter_next
       end
 
       def current_data
+        return @current_batch&.[](0) if @prefetch
         _current_data
       end
 
       def current_label
+        return @current_batch&.[](1) if @prefetch
         _current_label
       end
 
       def current_pad
-        _current_label
+        return @current_batch&.[](2) if @prefetch
+        _current_pad
+      end
+
+      def current_index
+        return @current_batch&.[](3) if @prefetch
+        super
       end
     end
   end
@@ -11,5 +11,9 @@ module MXNet
     def self.handle
       @handle ||= load_lib
     end
+
+    def self.loaded?
+      !@handle.nil?
+    end
   end
 end
@@ -0,0 +1,192 @@
+require 'etc'
+
+module MXNet
+  # Inspection of the memory held by NDArrays.
+  #
+  # While tracking is enabled, every NDArray created is recorded with its
+  # size, context, dtype and the location in the Ruby code that created
+  # it, until the NDArray is garbage-collected.  The census groups the
+  # live bytes by these, and the difference of two snapshots shows what
+  # has been kept alive in between.
+  #
+  #     MXNet::Memory.start_tracking
+  #     before = MXNet::Memory.snapshot
+  #     1000.times { worker.handle(request) }
+  #     GC.start
+  #     puts MXNet::Memory.snapshot.diff(before).first(10)
+  #     # ["app/worker.rb:42", {count: 1000, bytes: 4096000}]
+  #     # ...
+  #
+  # The allocation site is the first caller location outside of this
+  # library.  NDArrays created before tracking started are not recorded.
+  #
+  # libmxnet keeps the buffers of freed NDArrays in a pool per device to
+  # reuse them, and never returns them to the system by itself.
+  # Memory.release_cached does, for example after a job with large
+  # batches.  libmxnet does not report the size of the pool, but
+  # Memory.stats shows the memory used on the device and by NDArrays.
+  module Memory
+    LIB_DIR = (File.expand_path('..', __dir__) + File::SEPARATOR).freeze
+
+    PAGE_SIZE = (Etc.sysconf(Etc::SC_PAGESIZE) rescue 4096)
+    private_constant :PAGE_SIZE
+
+    # A live NDArray recorded by the census.  +bytes+ is the size of the
+    # array, which does not count the storage shared with other arrays.
+    Record = Struct.new(:site, :context, :dtype, :bytes)
+
+    # The live NDArrays at a point in time.
+    class Snapshot
+      GROUP_KEYS = %i[site context dtype].freeze
+
+      def initialize(records)
+        @records = records
+      end
+
+      attr_reader :records
+
+      # Returns the total size of the live NDArrays.
+      def total_bytes
+        @records.sum(&:bytes)
+      end
+
+      # Returns the number and the total size of the live NDArrays grouped
+      # by +group_by+, as a Hash sorted by the size in descending order.
+      #
+      # @param group_by [Symbol, Array<Symbol>] One or more of +:site+,
+      #   +:context+ and +:dtype+.  With an Array, the keys of the result
+      #   are Arrays.
+      def census(group_by: :site)
+        key = group_key(group_by)
+        result = Hash.new {|h, k| h[k] = {count: 0, bytes: 0} }
+        @records.each do |rec|
+          entry = result[key.(rec)]
+          entry[:count] += 1
+          entry[:bytes] += rec.bytes
+        end
+        result.sort_by {|_, v| -v[:bytes] }.to_h
+      end
+
+      # Returns the census of this snapshot minus that of +other+, with
+      # only the groups that changed, sorted by the change of the size in
+      # descending order.
+      #
+      # @param other [Snapshot] The earlier snapshot.
+      # @param group_by [Symbol, Array<Symbol>] The same as #census.
+      def diff(other, group_by: :site)
+        after = census(group_by: group_by)
+        before = other.census(group_by: group_by)
+        result = {}
+        (after.keys | before.keys).each do |k|
+          a = after.fetch(k, {count: 0, bytes: 0})
+          b = before.fetch(k, {count: 0, bytes: 0})
+          next if a == b
+          result[k] = {count: a[:count] - b[:count], bytes: a[:bytes] - b[:bytes]}
+        end
+        result.sort_by {|_, v| -v[:bytes] }.to_h
+      end
+
+      alias_method :-, :diff
+
+      private def group_key(group_by)
+        keys = Array(group_by)
+        unknown = keys - GROUP_KEYS
+        unless unknown.empty?
+          raise ArgumentError, "invalid key to group by: #{unknown.join(', ')}"
+        end
+        if group_by.is_a?(Array)
+          ->(rec) { keys.map {|k| rec[k] } }
+        else
+          ->(rec) { rec[group_by] }
+        end
+      end
+    end
+
+    class << self
+      # Starts recording the NDArrays created from now on.
+      def start_tracking
+        _start_tracking(LIB_DIR)
+        self
+      end
+
+      # Stops recording and discards the records.
+      def stop_tracking
+        _stop_tracking
+        self
+      end
+
+      # Returns the live NDArrays recorded.
+      def snapshot
+        records = _census_records.map do |site, dev_type, dev_id, dtype_id, bytes|
+          context = dev_type < 0 ? nil : Context.new(dev_type, dev_id)
+          Record.new(site, context, DType.id2name(dtype_id), bytes)
+        end
+        Snapshot.new(records)
+      end
+
+      # Returns the census of the live NDArrays.  See Snapshot#census.
+      def census(group_by: :site)
+        snapshot.census(group_by: group_by)
+      end
+
+      # Waits for the pending operations, and returns the free buffers kept
+      # in the storage pool of +ctx+ to the system.  Requires MXNet 1.5 or
+      # later.
+      #
+      # @param ctx [Context] The device whose pool is released.
+      # @param gc [Boolean] Runs GC.start first, so that the buffers of the
+      #   NDArrays which are garbage but not yet collected are released too.
+      def release_cached(ctx = MXNet.cpu, gc: false)
+        GC.start if gc
+        _release_cached(ctx.device_type_id, ctx.device_id)
+        self
+      end
+
+      # Returns the memory used on the device of +ctx+ and the memory in
+      # use by NDArrays, as far as they are known, in a Hash of
+      #
+      # +:used+::   For CPU, the resident set size of the whole process
+      #             (Linux only), which includes the Ruby heap and the
+      #             other libraries besides the pool of libmxnet.  For GPU,
+      #             the used memory of the device, including that of the
+      #             other processes.
+      # +:total+::  The total bytes of the GPU.
+      # +:in_use+:: The bytes of the live NDArrays on the device, which
+      #             are known only while tracking is enabled.
+      #
+      # Unknown values are nil.  libmxnet does not report the bytes kept in
+      # its pool, so compare +:used+ before and after #release_cached to
+      # see how much it returned.
+      #
+      # @param ctx [Context] The device.
+      def stats(ctx = MXNet.cpu)
+        used = total = nil
+        if ctx.device_type == :gpu
+          free_mem, total = _gpu_memory_info(ctx.device_id)
+          used = total - free_mem
+        else
+          used = resident_set_size
+        end
+        in_use = tracking? ? snapshot.census(group_by: :context).fetch(ctx, {bytes: 0})[:bytes] : nil
+        {used: used, total: total, in_use: in_use}
+      end
+
+      # Returns the census of the live NDArrays as a printable table.
+      #
+      # @param limit [Integer] The number of groups to print.
+      # @param group_by [Symbol, Array<Symbol>] See Snapshot#census.
+      def report(limit: 20, group_by: :site)
+        lines = ['MXNet::Memory']
+        census(group_by: group_by).first(limit).each do |key, v|
+          lines << format('  %12.3f MiB %8d arrays  %s', v[:bytes] / 1048576.0, v[:count], Array(key).join(' '))
+        end
+        lines.join("\n")
+      end
+
+      private def resident_set_size
+        statm = File.read('/proc/self/statm') rescue nil
+        statm && Integer(statm.split[1]) * PAGE_SIZE
+      end
+    end
+  end
+end
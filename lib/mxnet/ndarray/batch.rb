@@ -0,0 +1,58 @@
+module MXNet
+  class NDArray
+    # Records the operators called in the block, and executes them when
+    # the block exits, in one native loop which releases the GVL once.
+    # This removes the Ruby and GVL overhead between the operations of
+    # code which issues many small operations:
+    #
+    #     y = MXNet::NDArray.batch do
+    #       params.zip(grads) {|p, g| MXNet::NDArray.sgd_update(p, g, lr: 0.1, out: p) }
+    #       x * 2 + 1
+    #     end
+    #     y.wait_to_read
+    #
+    # The operator methods are called as usual in the block, but return
+    # arrays which hold no data until the batch is submitted.  They can be
+    # passed to the later operators in the block without submitting it.
+    # Reading such an array, or an +out+ array of an operator recorded in
+    # the batch, with the methods which access the data without operators,
+    # such as #shape, #to_a and #reshape, submits the operations recorded
+    # so far first, and so do CachedOp#call, Executor#forward,
+    # Executor#backward and the autograd backward, which do not record
+    # their operations.  Call Batch#submit to execute the operations
+    # recorded so far explicitly.
+    #
+    # An operator with more than one output has to be given the output
+    # arrays with +out+.
+    #
+    # The operations recorded before an exception raised in the block are
+    # still executed.  A batch called in the block of another batch joins
+    # the outer one.
+    #
+    # @yieldparam batch [Batch] The batch recording the operations.
+    # @return The value of the block.
+    # @raise [MXNet::Error] when an operation fails.
+    def self.batch
+      raise ArgumentError, 'no block given' unless block_given?
+      current = Batch.current
+      return yield current if current
+
+      batch = Batch.new
+      batch.send(:_activate)
+      begin
+        result = yield batch
+      rescue Exception
+        batch.send(:_deactivate)
+        begin
+          batch.submit
+        rescue MXNet::Error
+          # The exception of the block takes precedence.
+        end
+        raise
+      end
+      batch.send(:_deactivate)
+      batch.submit
+      result
+    end
+  end
+end
@@ -0,0 +1,93 @@
+module MXNet
+  class NDArray
+    # Runs the callbacks registered by NDArray#on_ready.
+    #
+    # The engine queues the ID of each completed callback natively and
+    # wakes up a dispatcher thread through a pipe, which takes the IDs
+    # and calls the callbacks.  With a libmxnet older than 1.5, which
+    # cannot push the notifications, a thread waits for each array
+    # instead.
+    module Notifier
+      @mutex = Mutex.new
+      @callbacks = {}
+      @next_id = 0
+      @pid = nil
+
+      class << self
+        # Calls +callback+ with +array+ on the dispatcher thread when the
+        # pending writes to +array+ complete.
+        def register(array, callback)
+          id = @mutex.synchronize do
+            start_dispatcher
+            @next_id += 1
+            @callbacks[@next_id] = [array, callback]
+            @next_id
+          end
+          begin
+            array.send(:_push_notification, id)
+          rescue NotImplementedError
+            @mutex.synchronize { @callbacks.delete(id) }
+            Thread.new do
+              array.send(:_wait_to_read_blocking)
+              callback.(array)
+            end
+          rescue Exception
+            @mutex.synchronize { @callbacks.delete(id) }
+            raise
+          end
+        end
+
+        private def start_dispatcher
+          return if @pid == Process.pid
+          # The pipe and the thread do not survive fork, and the callbacks
+          # registered in the parent are never called in the child.
+          @callbacks.clear
+          reader, @writer = IO.pipe
+          NDArray._set_notification_fd(@writer.fileno)
+          @pid = Process.pid
+          Thread.new { dispatch(reader) }.name = 'mxnet-notifier'
+        end
+
+        private def dispatch(reader)
+          loop do
+            # The bytes only wake up this thread; the IDs are in the queue.
+            reader.readpartial(4096)
+            NDArray._take_notifications.each do |id|
+              array, callback = @mutex.synchronize { @callbacks.delete(id) }
+              next unless callback
+              begin
+                callback.(array)
+              rescue Exception => e
+                warn "#{e.class}: #{e.message} in a callback of MXNet::NDArray#on_ready"
+              end
+            end
+          end
+        rescue EOFError, IOError
+        end
+      end
+    end
+    private_constant :Notifier
+
+    # Calls the block with this array when the pending writes to it
+    # complete.  The block runs on a thread dedicated to the callbacks, so
+    # it should only hand the array off, e.g. to a Queue.  Exceptions
+    # raised in it are reported with #warn.
+    #
+    # @return [NDArray] self
+    def on_ready(&block)
+      raise ArgumentError, 'no block given' unless block
+      Notifier.register(self, block)
+      self
+    end
+
+    # Called by #wait_to_read under a Fiber scheduler, so that the other
+    # fibers run while the calling fiber waits.
+    private def _wait_with_scheduler
+      queue = Thread::Queue.new
+      on_ready { queue << true }
+      queue.pop
+      # Raises the error of the operations, if any.
+      _wait_to_read_blocking
+    end
+  end
+end
@@ -0,0 +1,394 @@
+require 'json'
+
+module MXNet
+  # Binding of the profiler built into libmxnet, which records the time of
+  # each operator, including those run inside CachedOp and Executor, and
+  # writes them in the Chrome trace format (open the file in
+  # chrome://tracing or https://ui.perfetto.dev).
+  #
+  #     MXNet::Profiler.profile(filename: 'profile.json', aggregate_stats: true) do
+  #       loader.each do |data, label|
+  #         ...
+  #       end
+  #     end
+  #     MXNet::Profiler.aggregate_stats['operator']['FullyConnected']
+  #     # => {count: 600, total_ms: 123.4, min_ms: 0.15, max_ms: 1.2, avg_ms: 0.2}
+  #
+  # While the profiler is running, the Ruby-level spans recorded by
+  # MXNet::Profiler.span, such as Gluon::Block#call and the batches of
+  # Gluon::Data::DataLoader, are collected as well, and MXNet::Profiler.profile
+  # merges them into the trace file written by libmxnet.
+  #
+  # The profiler API is available in MXNet 1.2 or later.
+  module Profiler
+    STATS_ROW = /\A(.+?)\s+(\d+)\s+(-?[\d.]+)\s+(-?[\d.]+)\s+(-?[\d.]+)\s+(-?[\d.]+)\s*\z/
+    private_constant :STATS_ROW
+
+    @running = false
+    @paused = false
+    @config = {}
+    @mutex = Mutex.new
+    @spans = []
+    @thread_ids = {}
+
+    class << self
+      # Returns true while the profiler is running, between #start and
+      # #stop, even if it is paused.  Ruby-level spans are recorded only
+      # while it is running and not paused.
+      def running?
+        @running
+      end
+
+      # Returns true after #pause until #resume.
+      def paused?
+        @paused
+      end
+
+      # Sets the profiler configuration.
+      #
+      # @param filename [String] The output trace file.
+      # @param profile_all [Boolean] Profiles all of the below.
+      # @param profile_symbolic [Boolean] Profiles symbolic operators.
+      # @param profile_imperative [Boolean] Profiles imperative operators.
+      # @param profile_memory [Boolean] Profiles memory usage.
+      # @param profile_api [Boolean] Profiles the C API.
+      # @param continuous_dump [Boolean] Dumps periodically while running.
+      # @param aggregate_stats [Boolean] Maintains the statistics returned
+      #   by #aggregate_stats.
+      # @param kwargs [Hash] The other parameters understood by libmxnet.
+      def set_config(**kwargs)
+        keys = []
+        vals = []
+        kwargs.each do |key, val|
+          keys << key.to_s
+          vals << case val
+                  when true then 'True'
+                  when false then 'False'
+                  else val.to_s
+                  end
+        end
+        _set_config(keys, vals)
+        @config.update(kwargs)
+        self
+      end
+
+      # Starts the profiler.
+      def start
+        set_state(:run)
+      end
+
+      # Waits for the pending operations, so that they are recorded, and
+      # stops the profiler.
+      def stop
+        NDArray.wait_all
+        set_state(:stop)
+      end
+
+      # Sets the profiler state.
+      #
+      # @param state [:run, :stop] The new state.
+      def set_state(state)
+        case state
+        when :run
+          _set_state(1)
+          @running = true
+        when :stop
+          _set_state(0)
+          @running = false
+        else
+          raise ArgumentError, "invalid profiler state: #{state.inspect}"
+        end
+        self
+      end
+
+      # Pauses recording without stopping the profiler.
+      def pause
+        _pause(true)
+        @paused = true
+        self
+      end
+
+      # Resumes recording after #pause.  This does not start the profiler.
+      def resume
+        _pause(false)
+        @paused = false
+        self
+      end
+
+      # Writes the recorded events to the trace file.
+      #
+      # @param finished [Boolean] If true, the file is closed and the
+      #   profiler does not write to it anymore.
+      def dump(finished: true)
+        _dump(finished)
+        self
+      end
+
+      # Returns the aggregate statistics printed as a table.  The profiler
+      # must be configured with <tt>aggregate_stats: true</tt>.
+      #
+      # @param reset [Boolean] Clears the statistics after printing.
+      def dumps(reset: false)
+        _aggregate_stats(reset)
+      end
+
+      # Returns the aggregate statistics as a Hash of sections, such as
+      # +'operator'+ and +'MXNET_C_API'+, each of which maps the names of
+      # the items to their counts and times in milliseconds.
+      #
+      # @param reset [Boolean] Clears the statistics after reading.
+      def aggregate_stats(reset: false)
+        parse_aggregate_stats(dumps(reset: reset))
+      end
+
+      # Profiles the block, writes the trace file, and merges the Ruby-level
+      # spans into it.  Returns the value of the block.
+      #
+      # @param filename [String] The output trace file.
+      # @param profile_all [Boolean] Profiles everything by default.
+      # @param config [Hash] The other parameters of #set_config.
+      def profile(filename: 'profile.json', profile_all: true, **config)
+        set_config(filename: filename, profile_all: profile_all, **config)
+        clear_spans
+        start
+        begin
+          yield
+        ensure
+          stop
+          dump(finished: true)
+          merge_trace(filename)
+        end
+      end
+
+      # Records the block as a span of the trace while the profiler is
+      # running.  Returns the value of the block.
+      #
+      # @param name [String] The name of the span.
+      # @param category [String] The category shown in the trace viewer.
+      def span(name, category: 'ruby')
+        return yield unless @running && !@paused
+        start = now_us
+        begin
+          yield
+        ensure
+          finish = now_us
+          tid = Thread.current
+          @mutex.synchronize do
+            @spans << [name.to_s, category, start, finish - start, thread_id(tid)]
+          end
+        end
+      end
+
+      # Returns the recorded spans as Chrome trace events.  They are put in
+      # a process of their own, whose +pid+ is that of the Ruby process.
+      def trace_events
+        pid = Process.pid
+        @mutex.synchronize do
+          events = @spans.map do |name, cat, ts, dur, tid|
+            {'name' => name, 'cat' => cat, 'ph' => 'X', 'ts' => ts, 'dur' => dur,
+             'pid' => pid, 'tid' => tid}
+          end
+          unless events.empty?
+            events.unshift('name' => 'process_name', 'ph' => 'M', 'pid' => pid,
+                           'args' => {'name' => "Ruby (pid #{pid})"})
+          end
+          events
+        end
+      end
+
+      # Discards the recorded spans.
+      def clear_spans
+        @mutex.synchronize do
+          @spans.clear
+          @thread_ids.clear
+        end
+        self
+      end
+
+      # Appends the recorded spans to a trace file written by libmxnet.
+      #
+      # @param path [String] The trace file.
+      def merge_trace(path = @config[:filename])
+        events = trace_events
+        return path if events.empty? || path.nil? || !File.exist?(path)
+        trace = JSON.parse(File.read(path))
+        if trace.is_a?(Array)
+          trace.concat(events)
+        else
+          (trace['traceEvents'] ||= []).concat(events)
+        end
+        File.write(path, JSON.generate(trace))
+        path
+      end
+
+      private def thread_id(thread)
+        @thread_ids[thread] ||= @thread_ids.length
+      end
+
+      # MXNet time-stamps events with the microseconds since the epoch.
+      private def now_us
+        Process.clock_gettime(Process::CLOCK_REALTIME, :microsecond)
+      end
+
+      private def parse_aggregate_stats(str)
+        stats = {}
+        section = nil
+        lines = str.lines.map(&:rstrip)
+        lines.each_with_index do |line, i|
+          if lines[i + 1] =~ /\A=+\z/
+            section = stats[line.strip] = {}
+          elsif section && (m = STATS_ROW.match(line))
+            section[m[1]] = {
+              count: m[2].to_i,
+              total_ms: m[3].to_f,
+              min_ms: m[4].to_f,
+              max_ms: m[5].to_f,
+              avg_ms: m[6].to_f,
+            }
+          end
+        end
+        stats
+      end
+    end
+
+    # A named group of tasks, frames, counters and markers.
+    class Domain
+      def initialize(name)
+        @name = name
+        @handle = Handle.domain(name)
+      end
+
+      attr_reader :name, :handle
+
+      def new_task(name)
+        Task.new(self, name)
+      end
+
+      def new_frame(name)
+        Frame.new(self, name)
+      end
+
+      def new_counter(name, value = nil)
+        Counter.new(self, name, value)
+      end
+
+      def new_marker(name)
+        Marker.new(self, name)
+      end
+
+      def to_s
+        @name
+      end
+    end
+
+    # A duration recorded between #start and #stop.
+    module Duration
+      attr_reader :name
+
+      def start
+        @handle.start
+        self
+      end
+
+      def stop
+        @handle.stop
+        self
+      end
+
+      # Records the duration of the block.  Returns the value of the block.
+      def time
+        start
+        begin
+          yield
+        ensure
+          stop
+        end
+      end
+    end
+
+    # A duration of a logical unit of work in a domain.
+    class Task
+      include Duration
+
+      def initialize(domain, name)
+        @domain = domain
+        @name = name
+        @handle = Handle.create(:task, domain.handle, name)
+      end
+
+      attr_reader :domain
+    end
+
+    # A duration of a frame, such as an iteration, in a domain.
+    class Frame
+      include Duration
+
+      def initialize(domain, name)
+        @domain = domain
+        @name = name
+        @handle = Handle.create(:frame, domain.handle, name)
+      end
+
+      attr_reader :domain
+    end
+
+    # A duration which does not belong to a domain.
+    class Event
+      include Duration
+
+      def initialize(name)
+        @name = name
+        @handle = Handle.event(name)
+      end
+    end
+
+    # A counter shown as a graph in the trace.
+    class Counter
+      def initialize(domain, name, value = nil)
+        @domain = domain
+        @name = name
+        @handle = Handle.create(:counter, domain.handle, name)
+        set_value(value) if value
+      end
+
+      attr_reader :domain, :name
+
+      def set_value(value)
+        @handle.set_counter(value)
+        self
+      end
+
+      def increment(delta = 1)
+        @handle.adjust_counter(delta)
+        self
+      end
+
+      def decrement(delta = 1)
+        @handle.adjust_counter(-delta)
+        self
+      end
+
+      alias_method :+, :increment
+      alias_method :-, :decrement
+    end
+
+    # An instant event in a domain.
+    class Marker
+      def initialize(domain, name)
+        @domain = domain
+        @name = name
+      end
+
+      attr_reader :domain, :name
+
+      # Marks the current time.
+      #
+      # @param scope ['global', 'process', 'thread', 'task', 'marker']
+      #   The scope of the marker.
+      def mark(scope = 'process')
+        @domain.handle.set_marker(@name, scope.to_s)
+        self
+      end
+    end
+  end
+end
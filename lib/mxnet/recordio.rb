@@ -0,0 +1,190 @@
+module MXNet
+  # Sequential reader and writer of RecordIO files, the record container
+  # format used by MXNet's image iterators and tools such as im2rec.
+  #
+  #     MXNet::RecordIO.open('data.rec', 'w') do |rec|
+  #       rec.write('record 1')
+  #     end
+  #     MXNet::RecordIO.open('data.rec', 'r') do |rec|
+  #       while (buf = rec.read)
+  #         ...
+  #       end
+  #     end
+  #
+  # An instance must not be used from multiple threads at the same time.
+  # Open one reader per thread instead; reads release the GVL, so the
+  # readers proceed in parallel.
+  class RecordIO
+    # The header of an image record, as packed by MXNet::RecordIO.pack.
+    #
+    # +label+ is a Float, or an Array of Floats when +flag+ is positive.
+    IRHeader = Struct.new(:flag, :label, :id, :id2)
+
+    IR_FORMAT = 'L<eQ<Q<'.freeze
+    IR_SIZE = 24
+
+    # Opens a RecordIO file.
+    #
+    # @param uri [String] The path of the file.
+    # @param flag ['r', 'w'] Opens for reading with 'r' and writing with 'w'.
+    def self.open(uri, flag)
+      rec = new(uri, flag)
+      return rec unless block_given?
+      begin
+        yield rec
+      ensure
+        rec.close
+      end
+    end
+
+    def initialize(uri, flag)
+      @uri = uri.to_s
+      @flag = flag.to_s
+      unless %w[r w].include?(@flag)
+        raise ArgumentError, "invalid flag: #{flag.inspect}"
+      end
+      open
+    end
+
+    attr_reader :uri, :flag
+
+    def writable?
+      @flag == 'w'
+    end
+
+    # Reopens the file.  A reader goes back to the first record.
+    def open
+      _open(@uri, writable?)
+      self
+    end
+
+    alias reset open
+
+    # Packs a header and a payload into a record.
+    #
+    # @param header [IRHeader] The header.  When +label+ is an Array, its
+    #   length is stored as +flag+ and the labels are put in front of the
+    #   payload.
+    # @param s [String] The payload.
+    # @return [String] The record.
+    def self.pack(header, s)
+      label = header.label
+      if label.is_a?(Array) || label.is_a?(MXNet::NDArray)
+        label = label.to_a.flatten
+        buf = [label.length, 0.0, header.id, header.id2].pack(IR_FORMAT)
+        buf << label.pack('e*')
+      else
+        buf = [header.flag || 0, label.to_f, header.id, header.id2].pack(IR_FORMAT)
+      end
+      buf << s.b
+    end
+
+    # Unpacks a record into a header and a payload.
+    #
+    # @param s [String] The record.
+    # @return [Array] A pair of an IRHeader and the payload.
+    def self.unpack(s)
+      flag, label, id, id2 = s.unpack(IR_FORMAT)
+      offset = IR_SIZE
+      if flag > 0
+        label = s.byteslice(offset, 4 * flag).unpack('e*')
+        offset += 4 * flag
+      end
+      [IRHeader.new(flag, label, id, id2), s.byteslice(offset..-1)]
+    end
+  end
+
+  # RecordIO with an index file for random access by key.
+  #
+  # The index file lists one record per line as "key\tposition", which is
+  # the format written by MXNet's im2rec.
+  #
+  #     MXNet::IndexedRecordIO.open('data.idx', 'data.rec', 'r') do |rec|
+  #       buf = rec.read_idx(rec.keys.sample)
+  #     end
+  class IndexedRecordIO < RecordIO
+    # Opens a RecordIO file with its index.
+    #
+    # @param idx_path [String] The path of the index file.
+    # @param uri [String] The path of the RecordIO file.
+    # @param flag ['r', 'w'] Opens for reading with 'r' and writing with 'w'.
+    # @param key_type [Proc] Converts keys read from the index file.
+    def self.open(idx_path, uri, flag, key_type: :to_i.to_proc)
+      rec = new(idx_path, uri, flag, key_type: key_type)
+      return rec unless block_given?
+      begin
+        yield rec
+      ensure
+        rec.close
+      end
+    end
+
+    def initialize(idx_path, uri, flag, key_type: :to_i.to_proc)
+      @idx_path = idx_path.to_s
+      @key_type = key_type
+      @idx = {}
+      @keys = []
+      super(uri, flag)
+    end
+
+    attr_reader :idx_path, :keys
+
+    def open
+      if @fidx
+        @fidx.close
+        @fidx = nil
+      end
+      super
+      @idx.clear
+      @keys.clear
+      if writable?
+        @fidx = File.open(@idx_path, 'w')
+      else
+        File.foreach(@idx_path) do |line|
+          key, pos = line.chomp.split("\t")
+          next unless pos
+          key = @key_type.(key)
+          @idx[key] = Integer(pos)
+          @keys << key
+        end
+      end
+      self
+    end
+
+    def close
+      super
+      if @fidx
+        @fidx.close
+        @fidx = nil
+      end
+    end
+
+    # Returns the position of the record with the given key.
+    def position(key)
+      @idx.fetch(key) { raise KeyError, "key not found: #{key.inspect}" }
+    end
+
+    # Moves the reader to the record with the given key.
+    def seek_idx(key)
+      seek(position(key))
+    end
+
+    # Reads the record with the given key.
+    #
+    # @param key [Object] The key.
+    # @param out [String, nil] A String to be overwritten by the record.
+    def read_idx(key, out=nil)
+      seek_idx(key)
+      read(out)
+    end
+
+    # Writes a record with the given key.
+    def write_idx(key, buf)
+      pos = tell
+      write(buf)
+      @fidx.write("#{key}\t#{pos}\n")
+      @idx[key] = pos
+      @keys << key
+    end
+  end
+end
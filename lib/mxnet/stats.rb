@@ -0,0 +1,244 @@
+module MXNet
+  # Counters of where a training loop spends its time, to tell whether it
+  # is bound by the input pipeline or by computation.
+  #
+  # The counters are collected only while enabled.  When disabled, each
+  # instrumented point costs a single check of MXNet::Stats.enabled?.
+  #
+  #     MXNet::Stats.enable(log_interval: 30)
+  #     loader.each do |data, label|
+  #       ...
+  #       trainer.step(batch_size)
+  #     end
+  #     MXNet::Stats.snapshot[:batch_wait]  # => {count: 600, total: 12.3, mean: 0.0205, max: 0.4}
+  #
+  # The timers are
+  #
+  # +:batch_wait+::     Time blocked in DataLoader#each and DataIter#each
+  #                     until the next batch is available.
+  # +:batchify+::       Time in DataLoader collating samples into a batch,
+  #                     including batch_transform.
+  # +:trainer_step+::   Time in Gluon::Trainer#step, split into
+  #                     +:trainer_sync+ (gradient reduction) and
+  #                     +:trainer_update+ (optimizer updates).
+  #
+  # Operators run asynchronously, so the Trainer timers measure the time
+  # to issue the operations, while the wait for them shows up wherever the
+  # results are read next.
+  #
+  # The gauge +:prefetch_occupancy+ samples the number of batches ready in
+  # the prefetch queue of MXDataIter each time a batch is taken; a mean
+  # near zero means the consumer outruns the prefetcher.
+  #
+  # Separately, MXNet::Stats.enable_ops records every imperative operator
+  # and CachedOp dispatch in native per-thread counters, which are read by
+  # MXNet::Stats.ops.
+  #
+  #     MXNet::Stats.enable_ops
+  #     net.(data)
+  #     MXNet::Stats.ops['FullyConnected']
+  #     # => {calls: 3, total_ns: 41250, mean_ns: 13750.0, max_ns: 20480,
+  #     #     p50_ns: 16384, p99_ns: 32768, input_bytes: 331776,
+  #     #     histogram: [0, 0, ..., 1, 2, 0, ...]}
+  module Stats
+    Timer = Struct.new(:count, :total, :max)
+    Gauge = Struct.new(:count, :sum, :max, :last)
+
+    @enabled = false
+    @mutex = Mutex.new
+    @timers = {}
+    @gauges = {}
+    @log_interval = nil
+    @log_io = nil
+    @last_log = nil
+
+    class << self
+      def enabled?
+        @enabled
+      end
+
+      # Starts collecting the counters.
+      #
+      # @param log_interval [Numeric, nil] If given, writes #report to +io+
+      #   at most once per +log_interval+ seconds.
+      # @param io [IO] The destination of the periodic log.
+      def enable(log_interval: nil, io: $stderr)
+        @log_interval = log_interval
+        @log_io = io
+        @last_log = clock
+        @enabled = true
+        self
+      end
+
+      # Stops collecting the counters.  The values are kept.
+      def disable
+        @enabled = false
+        self
+      end
+
+      # Clears the counters.
+      def reset
+        @mutex.synchronize do
+          @timers.clear
+          @gauges.clear
+        end
+        self
+      end
+
+      # Runs the block, adding its duration to the timer +name+ when
+      # enabled.  Returns the value of the block.
+      def time(name)
+        return yield unless @enabled
+        start = clock
+        begin
+          yield
+        ensure
+          record(name, clock - start)
+        end
+      end
+
+      # Adds +seconds+ to the timer +name+.
+      def record(name, seconds)
+        @mutex.synchronize do
+          timer = (@timers[name] ||= Timer.new(0, 0.0, 0.0))
+          timer.count += 1
+          timer.total += seconds
+          timer.max = seconds if seconds > timer.max
+        end
+        maybe_log if @log_interval
+      end
+
+      # Adds a sample +value+ to the gauge +name+.
+      def gauge(name, value)
+        @mutex.synchronize do
+          g = (@gauges[name] ||= Gauge.new(0, 0, value, value))
+          g.count += 1
+          g.sum += value
+          g.max = value if value > g.max
+          g.last = value
+        end
+      end
+
+      # Returns the current values as a Hash from the names to Hashes.
+      # Timers have +:count+, +:total+, +:mean+ and +:max+ in seconds, and
+      # gauges have +:count+, +:mean+, +:max+ and +:last+.
+      def snapshot
+        @mutex.synchronize do
+          result = {}
+          @timers.each do |name, t|
+            result[name] = {count: t.count, total: t.total, mean: t.total / t.count, max: t.max}
+          end
+          @gauges.each do |name, g|
+            result[name] = {count: g.count, mean: g.sum.fdiv(g.count), max: g.max, last: g.last}
+          end
+          result
+        end
+      end
+
+      # Returns #snapshot as a printable table.
+      def report
+        lines = ['MXNet::Stats']
+        snapshot.each do |name, v|
+          if v.key?(:total)
+            lines << format('  %-20s %8d calls %10.3f s total %9.3f ms mean %9.3f ms max',
+                            name, v[:count], v[:total], 1000 * v[:mean], 1000 * v[:max])
+          else
+            lines << format('  %-20s %8d samples %8.2f mean %6d max', name, v[:count], v[:mean], v[:max])
+          end
+        end
+        lines.join("\n")
+      end
+
+      # Starts recording per-operator dispatch statistics.  When disabled,
+      # a dispatch costs a single check of a native flag.
+      def enable_ops
+        _set_ops_enabled(true)
+        self
+      end
+
+      # Stops recording per-operator dispatch statistics.  The values are
+      # kept.
+      def disable_ops
+        _set_ops_enabled(false)
+        self
+      end
+
+      # Clears the per-operator dispatch statistics.
+      def reset_ops
+        _reset_ops
+        self
+      end
+
+      # Returns the per-operator dispatch statistics as a Hash from the
+      # operator names to Hashes.  CachedOp invocations are counted under
+      # +'CachedOp'+.
+      #
+      # +:calls+::         The number of dispatches.
+      # +:total_ns+::      The total time in the dispatching API calls,
+      #                    which includes shape inference and pushing the
+      #                    operation to the engine, but not the computation.
+      # +:mean_ns+::       The mean of the time.
+      # +:max_ns+::        The maximum of the time.
+      # +:p50_ns+::        The median, rounded up to a power of 2.
+      # +:p99_ns+::        The 99th percentile, rounded up to a power of 2.
+      # +:input_bytes+::   The total size of the input arrays.
+      # +:histogram+::     The number of dispatches whose time is in
+      #                    [2**i, 2**(i+1)) nanoseconds at index i.
+      #
+      # @param reset [Boolean] Clears the statistics after reading.
+      def ops(reset: false)
+        result = {}
+        _ops_entries.each do |name, calls, total_ns, max_ns, input_bytes, buckets|
+          op = (result[name] ||= {calls: 0, total_ns: 0, max_ns: 0, input_bytes: 0,
+                                  histogram: Array.new(OPS_HISTOGRAM_BUCKETS, 0)})
+          op[:calls] += calls
+          op[:total_ns] += total_ns
+          op[:max_ns] = max_ns if max_ns > op[:max_ns]
+          op[:input_bytes] += input_bytes
+          buckets.each_with_index {|n, i| op[:histogram][i] += n }
+        end
+        _reset_ops if reset
+        result.each_value do |op|
+          op[:mean_ns] = op[:total_ns].fdiv(op[:calls])
+          op[:p50_ns] = histogram_percentile(op[:histogram], op[:calls], 0.5)
+          op[:p99_ns] = histogram_percentile(op[:histogram], op[:calls], 0.99)
+        end
+        result
+      end
+
+      # Returns #ops as a printable table, sorted by the total time.
+      #
+      # @param limit [Integer] The number of operators to print.
+      def ops_report(limit: 20)
+        lines = ['MXNet::Stats.ops']
+        ops.sort_by {|_, op| -op[:total_ns] }.first(limit).each do |name, op|
+          lines << format('  %-32s %8d calls %10.3f ms total %8.1f us mean %8.1f us p99 %10.1f MiB in',
+                          name, op[:calls], op[:total_ns] / 1e6, op[:mean_ns] / 1e3,
+                          op[:p99_ns] / 1e3, op[:input_bytes] / 1048576.0)
+        end
+        lines.join("\n")
+      end
+
+      def clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      end
+
+      private def histogram_percentile(histogram, count, q)
+        rank = (q * count).ceil
+        seen = 0
+        histogram.each_with_index do |n, i|
+          seen += n
+          return 2**(i + 1) if seen >= rank
+        end
+        2**histogram.length
+      end
+
+      private def maybe_log
+        now = clock
+        return if now - @last_log < @log_interval
+        @last_log = now
+        @log_io.puts(report)
+      end
+    end
+  end
+end
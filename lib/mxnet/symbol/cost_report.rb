@@ -0,0 +1,267 @@
+require 'json'
+
+module MXNet
+  class Symbol
+    # Estimated cost of evaluating a symbol, computed by Symbol#cost_report
+    # from the graph and the inferred shapes.
+    #
+    # FLOPs and MACs are counted for a forward pass over the whole batch
+    # of the input shapes.  A multiply-accumulate counts as 2 FLOPs.
+    #
+    # +FullyConnected+, +Convolution+, +Deconvolution+::
+    #   MACs of the matrix products, plus a FLOP per output for the bias.
+    # +Pooling+::
+    #   A FLOP per element of each pooling window.
+    # +BatchNorm+, +InstanceNorm+, +LayerNorm+::
+    #   2 FLOPs per element, as the normalization folds into a scale and
+    #   a shift at inference.
+    # +softmax+, +log_softmax+, +SoftmaxOutput+, +SoftmaxActivation+::
+    #   3 FLOPs per element.
+    # Elementwise operators::
+    #   A FLOP per output element.
+    #
+    # Other operators have +nil+ FLOPs and are listed in #uncounted_ops.
+    #
+    # The parameter bytes of a node are those of the variables it takes
+    # other than the inputs, which include its auxiliary states.  The activation bytes are
+    # those of its outputs.  The peak activation bytes are the maximum of
+    # the outputs alive at once when the nodes run in order and each
+    # output is released after its last consumer.
+    class CostReport
+      Node = Struct.new(:name, :op, :output_shapes, :flops, :macs, :param_bytes, :activation_bytes)
+
+      ELEMENTWISE_OPS = %w[
+        Activation LeakyReLU relu sigmoid tanh softsign softrelu abs sign
+        exp log sqrt rsqrt square reciprocal negative clip Dropout Cast
+        elemwise_add elemwise_sub elemwise_mul elemwise_div add_n ElementWiseSum
+        _plus _minus _mul _div _Plus _Minus _Mul _Div _power _maximum _minimum
+        _plus_scalar _minus_scalar _rminus_scalar _mul_scalar _div_scalar
+        _rdiv_scalar _power_scalar _maximum_scalar _minimum_scalar
+        broadcast_add broadcast_sub broadcast_mul broadcast_div broadcast_plus
+        broadcast_minus broadcast_maximum broadcast_minimum broadcast_power
+      ].freeze
+
+      # Operators which only move or view data.
+      ZERO_COST_OPS = %w[
+        Flatten flatten Reshape reshape transpose expand_dims squeeze
+        Concat concat stack slice slice_axis SliceChannel split identity
+        _copy BlockGrad stop_gradient zeros_like ones_like _zeros _ones
+      ].freeze
+
+      SOFTMAX_OPS = %w[softmax log_softmax SoftmaxOutput SoftmaxActivation].freeze
+
+      NORM_OPS = %w[BatchNorm InstanceNorm LayerNorm].freeze
+
+      def initialize(nodes, peak_activation_bytes)
+        @nodes = nodes
+        @peak_activation_bytes = peak_activation_bytes
+      end
+
+      # The operator nodes in topological order.
+      attr_reader :nodes
+
+      attr_reader :peak_activation_bytes
+
+      def total_flops
+        @nodes.sum {|n| n.flops || 0 }
+      end
+
+      def total_macs
+        @nodes.sum {|n| n.macs || 0 }
+      end
+
+      def total_param_bytes
+        @nodes.sum(&:param_bytes)
+      end
+
+      def total_activation_bytes
+        @nodes.sum(&:activation_bytes)
+      end
+
+      # Returns the names of the operators whose FLOPs are not counted.
+      def uncounted_ops
+        @nodes.select {|n| n.flops.nil? }.map(&:op).uniq
+      end
+
+      # Returns the totals as a Hash.
+      def totals
+        {
+          flops: total_flops,
+          macs: total_macs,
+          param_bytes: total_param_bytes,
+          activation_bytes: total_activation_bytes,
+          peak_activation_bytes: peak_activation_bytes,
+        }
+      end
+
+      # Returns the nodes and the totals as a Hash.
+      def to_h
+        {nodes: @nodes.map(&:to_h), total: totals, uncounted_ops: uncounted_ops}
+      end
+
+      # Returns the report as a printable table.
+      def to_s
+        width = [@nodes.map {|n| n.name.length }.max || 0, 4].max
+        lines = [format("%-#{width}s %-18s %-20s %12s %12s %12s %12s",
+                        'node', 'op', 'output', 'MFLOPs', 'MMACs', 'param KiB', 'act KiB')]
+        @nodes.each do |n|
+          lines << format("%-#{width}s %-18s %-20s %12s %12s %12.1f %12.1f",
+                          n.name, n.op, n.output_shapes.first.inspect,
+                          n.flops ? format('%.3f', n.flops / 1e6) : '-',
+                          n.macs ? format('%.3f', n.macs / 1e6) : '-',
+                          n.param_bytes / 1024.0, n.activation_bytes / 1024.0)
+        end
+        lines << format('total: %.3f MFLOPs, %.3f MMACs, %.1f KiB params, %.1f KiB activations (%.1f KiB peak)',
+                        total_flops / 1e6, total_macs / 1e6, total_param_bytes / 1024.0,
+                        total_activation_bytes / 1024.0, peak_activation_bytes / 1024.0)
+        lines.join("\n")
+      end
+
+      # Analyzes +symbol+ with the given input shapes.
+      def self.analyze(symbol, input_shapes, dtype: :float32)
+        elsize = dtype_size(dtype)
+        internals = symbol.get_internals
+        _, out_shapes, _ = internals.infer_shape(**input_shapes.transform_keys(&:to_sym))
+        input_shapes = input_shapes.transform_keys(&:to_s)
+        if out_shapes.nil?
+          raise ArgumentError, "unable to infer the shapes from #{input_shapes.keys.join(', ')}"
+        end
+        shapes = internals.list_outputs.map(&:to_s).zip(out_shapes).to_h
+
+        graph = JSON.parse(symbol.to_json)
+        graph_nodes = graph['nodes']
+        output_shape = lambda do |(node_id, index)|
+          node = graph_nodes[node_id]
+          if node['op'] == 'null'
+            shapes[node['name']]
+          elsif index == 0 && shapes.key?("#{node['name']}_output")
+            shapes["#{node['name']}_output"]
+          else
+            shapes["#{node['name']}_output#{index}"]
+          end
+        end
+
+        # Computes the last consumer of each output for the liveness.
+        last_use = {}
+        graph_nodes.each_with_index do |node, i|
+          node['inputs'].each {|entry| last_use[entry[0, 2]] = i }
+        end
+        graph['heads'].each {|entry| last_use[entry[0, 2]] = graph_nodes.length }
+
+        live = {}
+        live_bytes = peak = 0
+        nodes = []
+        graph_nodes.each_with_index do |node, i|
+          next if node['op'] == 'null'
+          attrs = node['attrs'] || node['param'] || node['attr'] || {}
+          in_shapes = node['inputs'].map(&output_shape)
+          outputs = node_outputs(node, shapes)
+          param_bytes = node['inputs'].sum do |entry|
+            input = graph_nodes[entry[0]]
+            next 0 unless input['op'] == 'null' && !input_shapes.key?(input['name'])
+            shape = output_shape.(entry)
+            shape ? shape.inject(1, :*) * elsize : 0
+          end
+          activation_bytes = outputs.sum {|shape| shape.inject(1, :*) * elsize }
+          flops, macs = count_flops(node['op'], attrs, in_shapes, outputs)
+          nodes << Node.new(node['name'], node['op'], outputs, flops, macs, param_bytes, activation_bytes)
+
+          outputs.each_with_index do |shape, j|
+            next unless last_use.key?([i, j])
+            live[[i, j]] = shape.inject(1, :*) * elsize
+            live_bytes += live[[i, j]]
+          end
+          peak = live_bytes if live_bytes > peak
+          node['inputs'].each do |entry|
+            key = entry[0, 2]
+            live_bytes -= live.delete(key) if last_use[key] == i && live.key?(key)
+          end
+        end
+
+        new(nodes, peak)
+      end
+
+      def self.node_outputs(node, shapes)
+        name = node['name']
+        if shapes.key?("#{name}_output")
+          [shapes["#{name}_output"]]
+        else
+          outputs = []
+          outputs << shapes["#{name}_output#{outputs.length}"] while shapes.key?("#{name}_output#{outputs.length}")
+          outputs
+        end
+      end
+      private_class_method :node_outputs
+
+      def self.count_flops(op, attrs, in_shapes, out_shapes)
+        out = out_shapes.first
+        return [nil, nil] unless out && in_shapes.all?
+        out_size = out.inject(1, :*)
+        no_bias = attrs['no_bias'].to_s =~ /\A(true|1)\z/i
+        case op
+        when 'FullyConnected'
+          weight = in_shapes[1]
+          macs = out_size * weight[1]
+          [2 * macs + (no_bias ? 0 : out_size), macs]
+        when 'Convolution'
+          weight = in_shapes[1]
+          macs = out_size * weight[1..-1].inject(1, :*)
+          [2 * macs + (no_bias ? 0 : out_size), macs]
+        when 'Deconvolution'
+          data, weight = in_shapes
+          macs = data.inject(1, :*) * weight[1..-1].inject(1, :*)
+          [2 * macs + (no_bias ? 0 : out_size), macs]
+        when 'Pooling'
+          window =
+            if attrs['global_pool'].to_s =~ /\A(true|1)\z/i
+              in_shapes[0][2..-1].inject(1, :*)
+            else
+              attrs['kernel'].to_s.scan(/\d+/).map(&:to_i).inject(1, :*)
+            end
+          [out_size * window, 0]
+        when *NORM_OPS
+          [2 * in_shapes[0].inject(1, :*), 0]
+        when *SOFTMAX_OPS
+          [3 * out_size, 0]
+        when *ELEMENTWISE_OPS
+          [out_size, 0]
+        when *ZERO_COST_OPS
+          [0, 0]
+        else
+          [nil, nil]
+        end
+      end
+      private_class_method :count_flops
+
+      def self.dtype_size(dtype)
+        case dtype.to_sym
+        when :float64, :int64 then 8
+        when :float32, :int32 then 4
+        when :float16 then 2
+        when :uint8, :int8 then 1
+        else raise ArgumentError, "invalid dtype: #{dtype}"
+        end
+      end
+      private_class_method :dtype_size
+    end
+
+    # Estimates the FLOPs, the MACs, the parameter bytes and the activation
+    # bytes of each node for a forward pass with the given input shapes.
+    # See CostReport for what is counted.
+    #
+    #     > data = MXNet::Symbol.var(:data)
+    #     > net = MXNet::Symbol.FullyConnected(data: data, name: :fc1, num_hidden: 128)
+    #     > report = net.cost_report(data: [32, 784])
+    #     > report.total_macs
+    #     3211264
+    #     > puts report
+    #
+    # @param dtype [Symbol] The dtype used for the byte sizes.
+    # @param input_shapes [Hash{Symbol => Array<Integer>}] The shapes of
+    #   the inputs.  The other arguments are counted as parameters.
+    # @return [CostReport]
+    def cost_report(dtype: :float32, **input_shapes)
+      CostReport.analyze(self, input_shapes, dtype: dtype)
+    end
+  end
+end
@@ -33,6 +33,23 @@ module MXNet
       return actual_hash == sha1_hash
     end
 
+    # Check the sha1 hash like check_sha1, but remember a successful check in
+    # a sidecar file "<filename>.sha1" with the size and mtime of the file.
+    # While the file is untouched, later checks read only the sidecar.
+    def check_sha1_with_sidecar(filename, sha1_hash)
+      sidecar = "#{filename}.sha1"
+      stat = File.stat(filename)
+      stamp = "#{sha1_hash} #{stat.size} #{stat.mtime.to_i}.#{stat.mtime.nsec}"
+      return true if File.file?(sidecar) && ::IO.read(sidecar).chomp == stamp
+      return false unless check_sha1(filename, sha1_hash)
+      begin
+        ::IO.write(sidecar, stamp)
+      rescue SystemCallError
+        # The check has passed anyway; only the sidecar is lost.
+      end
+      true
+    end
+
     # Download an given URL
     def download(url, path: nil, overwrite: false, sha1_hash: nil)
       if path.nil?
@@ -46,13 +63,13 @@ module MXNet
         end
       end
 
-      if overwrite || !File.exist?(fname) || (sha1_hash && !check_sha1(fname, sha1_hash))
+      if overwrite || !File.exist?(fname) || (sha1_hash && !check_sha1_with_sidecar(fname, sha1_hash))
         dirname = File.dirname(fname)
         FileUtils.mkdir_p(dirname)
 
         puts "Downloading #{fname} from #{url}..."
         open(url, 'rb') {|src| ::IO.copy_stream(src, fname) }
-        if sha1_hash && !check_sha1(fname, sha1_hash)
+        if sha1_hash && !check_sha1_with_sidecar(fname, sha1_hash)
           raise "File #{fname} is downloaded but the content hash does not match. " +
                 "The repo may be outdated or download may be incomplete. " +
                 "If the `repo_url` is overridden, consider switching to " +
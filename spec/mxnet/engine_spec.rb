@@ -0,0 +1,54 @@
+require 'spec_helper'
+
+RSpec.describe MXNet::Engine do
+  describe '.configure' do
+    it 'rejects the engine options after libmxnet is loaded' do
+      expect { described_class.configure(cpu_worker_threads: 2) }.to raise_error(RuntimeError, /before libmxnet is loaded/)
+    end
+
+    it 'rejects an unknown engine type' do
+      expect { described_class.configure(type: 'FooEngine') }.to raise_error(ArgumentError)
+    end
+
+    it 'sets the number of OpenMP threads at runtime' do
+      described_class.configure(omp_threads: 2)
+      expect(described_class.num_omp_threads).to eq(2)
+    end
+  end
+
+  describe '.bulk' do
+    it 'returns the value of the block computed in bulk' do
+      x = MXNet::NDArray.ones([3])
+      y = described_class.bulk(4) do
+        5.times.inject(x) {|a, _| a * 2 }
+      end
+      expect(y.to_a).to eq([32, 32, 32])
+    end
+
+    it 'restores the previous bulk size' do
+      skip 'bulk execution is unavailable' unless described_class.bulk_available?
+      prev = described_class._set_bulk_size(3)
+      described_class.bulk(8) { }
+      expect(described_class._set_bulk_size(prev)).to eq(3)
+    end
+  end
+
+  describe '.features' do
+    before do
+      begin
+        described_class.features
+      rescue NotImplementedError
+        skip 'MXLibInfoFeatures is unavailable'
+      end
+    end
+
+    it 'returns whether each feature is enabled' do
+      expect(described_class.features).to include('CPU_SSE' => be(true).or(be(false)))
+      expect(described_class.feature_enabled?(:cpu_sse)).to eq(described_class.features['CPU_SSE'])
+    end
+
+    it 'rejects an unknown feature' do
+      expect { described_class.feature_enabled?(:foo) }.to raise_error(ArgumentError)
+    end
+  end
+end
@@ -0,0 +1,43 @@
+require 'spec_helper'
+
+RSpec.describe MXNet::Executor do
+  let(:x) { MXNet::Symbol.var(:x) }
+  let(:y) { MXNet::Symbol.relu(data: x * 2, name: 'act') }
+  let(:executor) { y.bind(MXNet.cpu, { x: MXNet::NDArray.array([-3, 4]) }) }
+
+  describe '#set_monitor' do
+    it 'samples the statistic of the matching outputs' do
+      executor.set_monitor(/act/, stat: :max_abs)
+      executor.forward
+      results = executor.monitor_results
+      expect(results.map(&:name)).to eq(['act_output'])
+      expect(results[0].step).to eq(0)
+      expect(results[0].value).to eq(8)
+    end
+
+    it 'computes the norm divided by the square root of the size' do
+      executor.set_monitor('act')
+      executor.forward
+      expect(executor.monitor_results[0].value).to be_within(1e-5).of(8 / Math.sqrt(2))
+    end
+
+    it 'samples every interval forward passes' do
+      executor.set_monitor(/act/, interval: 2, stat: :mean_abs)
+      5.times { executor.forward }
+      results = executor.monitor_results
+      expect(results.map(&:step)).to eq([0, 2, 4])
+      expect(results.map(&:value)).to all(eq(4))
+    end
+
+    it 'drains the buffered results' do
+      executor.set_monitor(/act/)
+      executor.forward
+      executor.monitor_results
+      expect(executor.monitor_results).to be_empty
+    end
+
+    it 'rejects an unknown statistic' do
+      expect { executor.set_monitor(/act/, stat: :foo) }.to raise_error(ArgumentError)
+    end
+  end
+end
@@ -209,6 +209,77 @@ RSpec.describe MXNet::Gluon::Block do
       expect { block.forward(data) }.to raise_error(NotImplementedError)
     end
   end
+
+  describe 'forward hooks' do
+    let(:block) do
+      MXNet::Gluon::NN::Dense.new(2, in_units: 3).tap(&:init)
+    end
+
+    let(:data) do
+      MXNet::NDArray.ones([1, 3])
+    end
+
+    it 'calls the hooks around #forward' do
+      calls = []
+      block.register_forward_pre_hook {|b, args| calls << [:pre, b, args] }
+      block.register_forward_hook {|b, args, out| calls << [:post, b, args, out] }
+      out = block.(data)
+      expect(calls).to eq([[:pre, block, [data]], [:post, block, [data], out]])
+    end
+
+    it 'removes a hook with the handle' do
+      calls = 0
+      handle = block.register_forward_hook { calls += 1 }
+      block.(data)
+      handle.detach
+      block.(data)
+      expect(calls).to eq(1)
+    end
+
+    it 'keeps each registration of the same hook' do
+      calls = 0
+      hook = proc { calls += 1 }
+      handle = block.register_forward_hook(hook)
+      block.register_forward_hook(hook)
+      block.(data)
+      expect(calls).to eq(2)
+      handle.detach
+      block.(data)
+      expect(calls).to eq(3)
+    end
+  end
+
+  describe '#profile' do
+    let(:net) do
+      MXNet::Gluon::NN::Sequential.new.tap do |net|
+        net.with_name_scope do
+          net << MXNet::Gluon::NN::Dense.new(4, in_units: 3)
+          net << MXNet::Gluon::NN::Dense.new(2, in_units: 4)
+        end
+        net.init
+      end
+    end
+
+    it 'measures each block' do
+      profile = net.profile(MXNet::NDArray.ones([2, 3]), iterations: 3)
+      stats = profile.to_h
+      expect(stats.keys).to contain_exactly(net.name, net.at(0).name, net.at(1).name)
+      expect(stats.values.map {|v| v[:calls] }).to all(eq(3))
+      expect(stats[net.name][:total]).to be >= stats[net.name][:self]
+    end
+
+    it 'prints a sorted table' do
+      table = net.profile(MXNet::NDArray.ones([2, 3]), iterations: 1).table(sort: :name)
+      expect(table.lines.length).to eq(4)
+      expect(table.lines[1..-1].map {|l| l.split.first }).to eq([net.name, net.at(0).name, net.at(1).name].sort)
+    end
+
+    it 'removes the hooks afterwards' do
+      net.profile(MXNet::NDArray.ones([2, 3]), iterations: 1)
+      expect(net).not_to receive(:wait_outputs)
+      net.(MXNet::NDArray.ones([2, 3]))
+    end
+  end
 end
 
 RSpec.describe MXNet::Gluon::HybridBlock do
@@ -235,6 +306,16 @@ RSpec.describe MXNet::Gluon::HybridBlock do
     end
   end
 
+  describe '#cost_report' do
+    it 'reports the cost of the cached graph' do
+      net = MXNet::Gluon::NN::Dense.new(3, in_units: 5, prefix: 'dense_')
+      net.init
+      report = net.cost_report(MXNet::NDArray.ones([4, 5]))
+      expect(report.total_macs).to eq(4 * 5 * 3)
+      expect(report.total_param_bytes).to eq((3 * 5 + 3) * 4)
+    end
+  end
+
   context 'given a simple model' do
     before do
       stub_const 'Foo', Class.new(MXNet::Gluon::HybridBlock)
@@ -0,0 +1,56 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::BatchTransforms do
+  let(:batch) do
+    MXNet::NDArray.arange(0, 16, dtype: :uint8).reshape([2, 2, 2, 2])
+  end
+
+  describe MXNet::Gluon::Data::BatchTransforms::Cast do
+    it 'casts a batch' do
+      expect(described_class.new(:float32).(batch).dtype).to eq(:float32)
+    end
+
+    it 'applies to the first element of an array' do
+      label = MXNet::NDArray.array([1, 2])
+      data, l = described_class.new(:float32).([batch, label])
+      expect(data.dtype).to eq(:float32)
+      expect(l).to equal(label)
+    end
+  end
+
+  describe MXNet::Gluon::Data::BatchTransforms::ToTensor do
+    it 'converts NHWC into NCHW in [0, 1)' do
+      out = described_class.new.(batch)
+      expect(out.shape).to eq([2, 2, 2, 2])
+      expect(out[0, 1, 0, 0].as_scalar).to be_within(1e-6).of(1 / 255.0)
+    end
+  end
+
+  describe MXNet::Gluon::Data::BatchTransforms::Normalize do
+    it 'normalizes each channel' do
+      out = described_class.new([1.0, 2.0], [1.0, 4.0]).(batch)
+      expect(out[0, 0, 0, 0].as_scalar).to eq(-1.0)
+      expect(out[0, 1, 0, 0].as_scalar).to eq(0.5)
+    end
+  end
+
+  describe MXNet::Gluon::Data::BatchTransforms::RandomFlip do
+    it 'flips every sample with p = 1' do
+      out = described_class.new(axis: 3, p: 1.0).(batch)
+      expect(out.to_narray.to_a).to eq(MXNet::NDArray.reverse(batch, axis: 3).to_narray.to_a)
+    end
+
+    it 'keeps every sample with p = 0' do
+      out = described_class.new(axis: 3, p: 0.0).(batch)
+      expect(out.to_narray.to_a).to eq(batch.to_narray.to_a)
+    end
+  end
+
+  describe MXNet::Gluon::Data::BatchTransforms::RandomCrop do
+    it 'crops a window' do
+      out = described_class.new(1).(batch)
+      expect(out.shape).to eq([2, 2, 1, 1])
+    end
+  end
+end
@@ -0,0 +1,33 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::Batchify::Pad do
+  it 'pads Array samples to the longest one' do
+    out = described_class.new(pad_val: -1).([[1, 2], [3], [4, 5, 6]])
+    expect(out.to_narray.to_a).to eq([[1, 2, -1], [3, -1, -1], [4, 5, 6]])
+  end
+
+  it 'pads NDArray samples along the first axis' do
+    a = MXNet::NDArray.ones([1, 2])
+    b = MXNet::NDArray.ones([2, 2]) * 2
+    out, lengths = described_class.new(ret_length: true).([a, b])
+    expect(out.shape).to eq([2, 2, 2])
+    expect(out.to_narray.to_a).to eq([[[1, 1], [0, 0]], [[2, 2], [2, 2]]])
+    expect(lengths.to_a).to eq([1, 2])
+  end
+
+  it 'rejects a pad value out of the range of the dtype' do
+    pad = described_class.new(pad_val: -1, dtype: :uint8)
+    expect { pad.([[1, 2], [3]]) }.to raise_error(RangeError)
+    expect { described_class.new(dtype: :uint8).([[256]]) }.to raise_error(RangeError)
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::Batchify::Tuple do
+  it 'applies a function to each field' do
+    fn = described_class.new(MXNet::Gluon::Data::Batchify::Pad.new, MXNet::Gluon::Data::Batchify::Stack.new)
+    data, label = fn.([[[1, 2], 0], [[3], 1]])
+    expect(data.to_narray.to_a).to eq([[1, 2], [3, 0]])
+    expect(label.to_a).to eq([0, 1])
+  end
+end
@@ -0,0 +1,105 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::CachedDataset do
+  let(:calls) { [] }
+
+  let(:source_class) do
+    Class.new(MXNet::Gluon::Data::Dataset) do
+      def initialize(calls)
+        @data = MXNet::NDArray.arange(0, 12).reshape([6, 2])
+        @calls = calls
+      end
+
+      def length
+        6
+      end
+
+      def [](idx)
+        @calls << idx
+        [@data[idx] * 2, idx]
+      end
+    end
+  end
+
+  let(:source) { source_class.new(calls) }
+
+  context 'with :memory storage' do
+    let(:dataset) { source.cache }
+
+    it 'computes each sample once' do
+      2.times { dataset.length.times {|i| dataset[i] } }
+      expect(calls).to eq((0..5).to_a)
+      expect(dataset).to be_complete
+    end
+
+    it 'gathers batches from the store' do
+      dataset.materialize
+      data, label = dataset.get_batch([4, 1])
+      expect(data.to_narray.to_a).to eq([[16.0, 18.0], [4.0, 6.0]])
+      expect(label.to_a).to eq([4, 1])
+      expect(calls.length).to eq(6)
+    end
+
+    it 'keeps the dtype of a field regardless of the order of reads' do
+      _, label = dataset.get_batch([3, 5])
+      expect(label.dtype).to eq(:int32)
+      expect(label.to_a).to eq([3, 5])
+      _, label = dataset.get_batch([0, 3])
+      expect(label.dtype).to eq(:int32)
+      expect(label.to_a).to eq([0, 3])
+      expect(dataset[5][1]).to eq(5)
+    end
+
+    it 'works with DataLoader' do
+      loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 4)
+      2.times { loader.to_a }
+      expect(calls.length).to eq(6)
+    end
+
+    it 'stores every sample when read from threads' do
+      4.times.map {|t| Thread.new { 6.times {|i| dataset[(i + t) % 6] } } }.each(&:join)
+      expect(dataset).to be_complete
+      expect(calls.uniq.sort).to eq((0..5).to_a)
+      _, label = dataset.get_batch((0..5).to_a)
+      expect(label.to_a).to eq((0..5).to_a)
+    end
+  end
+
+  context 'with :mmap storage', :within_tmpdir do
+    let(:dataset) { source.cache(storage: :mmap, path: 'cache.raw') }
+
+    it 'writes the store to the file after the first pass' do
+      dataset.materialize
+      expect(dataset).to be_complete
+      expect(File).to be_file('cache.raw')
+      data, label = dataset.get_batch([5])
+      expect(data.to_narray.to_a).to eq([[20.0, 22.0]])
+      expect(label.to_a).to eq([5])
+    end
+
+    it 'computes each sample once' do
+      2.times { dataset.length.times {|i| dataset[i] } }
+      expect(calls).to eq((0..5).to_a)
+      expect(dataset).to be_complete
+    end
+
+    it 'reads stored samples back before the file is complete' do
+      loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 4, last_batch: :discard)
+      labels = 2.times.map { loader.map {|_, label| label.to_a } }
+      expect(labels).to eq([[[0, 1, 2, 3]], [[0, 1, 2, 3]]])
+      expect(calls).to eq((0..3).to_a)
+      expect(dataset).not_to be_complete
+      expect(dataset[2][0].to_a).to eq([8.0, 10.0])
+    end
+
+    it 'reuses an existing file' do
+      dataset.materialize
+      calls.clear
+      other = source.cache(storage: :mmap, path: 'cache.raw')
+      expect(other).to be_complete
+      other[3]
+      expect(calls).to be_empty
+    end
+  end
+end
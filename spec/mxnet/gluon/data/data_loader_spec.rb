@@ -110,6 +110,16 @@ RSpec.describe MXNet::Gluon::Data::DataLoader do
     end
   end
 
+  context 'with `batch_transform:`' do
+    let(:loader) do
+      described_class.new(dataset, batch_size: batch_size, batch_transform: ->(batch) { batch * 2 })
+    end
+
+    it 'transforms each batch' do
+      expect(loader.first.to_a).to eq([0, 2, 4])
+    end
+  end
+
   context 'with the MNIST dataset' do
     let(:dataset) do
       MXNet::Gluon::Data::Vision::MNIST.new
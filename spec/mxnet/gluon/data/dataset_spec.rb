@@ -57,3 +57,45 @@ RSpec.describe MXNet::Gluon::Data::SimpleDataset do
     end
   end
 end
+
+RSpec.describe MXNet::Gluon::Data::DownloadedDataset, :within_tmpdir do
+  let(:dataset_class) do
+    Class.new(MXNet::Gluon::Data::DownloadedDataset) do
+      class << self
+        attr_accessor :decoded
+      end
+
+      def self.name
+        'MXNet::Gluon::Data::SourceDataset'
+      end
+
+      private def _get_data
+        self.class.decoded += 1
+        values = ::IO.read(File.join(root, 'source.txt')).split.map(&:to_f)
+        @data = MXNet::NDArray.array(values)
+        @label = MXNet::NDArray.array(values.map {|v| v * 2 })
+      end
+    end
+  end
+
+  before do
+    dataset_class.decoded = 0
+    ::IO.write('source.txt', "1 2 3\n")
+  end
+
+  it 'caches the decoded data keyed by the source files' do
+    dataset_class.new(root: '.', transform: nil)
+    cached = dataset_class.new(root: '.', transform: nil)
+    expect(dataset_class.decoded).to eq(1)
+    expect(cached.length).to eq(3)
+    expect(cached[2][1].as_scalar).to eq(6.0)
+  end
+
+  it 'decodes again when a source file changes' do
+    dataset_class.new(root: '.', transform: nil)
+    ::IO.write('source.txt', "1 2 3 4\n")
+    File.utime(Time.now + 10, Time.now + 10, 'source.txt')
+    expect(dataset_class.new(root: '.', transform: nil).length).to eq(4)
+    expect(dataset_class.decoded).to eq(2)
+  end
+end
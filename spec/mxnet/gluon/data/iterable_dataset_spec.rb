@@ -0,0 +1,73 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::ShuffledDataset do
+  let(:dataset) { described_class.new(1..100, 10, seed: 1) }
+
+  it 'yields every sample once' do
+    expect(dataset.to_a.sort).to eq((1..100).to_a)
+  end
+
+  it 'shuffles the samples' do
+    expect(dataset.to_a).not_to eq((1..100).to_a)
+  end
+
+  it 'is reproducible with a seed' do
+    expect(dataset.to_a).to eq(dataset.to_a)
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::InterleavedDataset do
+  it 'yields the samples of all sources' do
+    dataset = described_class.new([1..5, 10..15, 100..103], num_threads: 2, prefetch: 2)
+    expect(dataset.to_a.sort).to eq([*1..5, *10..15, *100..103])
+  end
+
+  it 'keeps the order within a source' do
+    dataset = described_class.new([1..50, 101..150])
+    samples = dataset.to_a
+    expect(samples.select {|x| x <= 50 }).to eq((1..50).to_a)
+  end
+
+  it 're-raises an exception from a source' do
+    source = Enumerator.new {|y| y << 1; raise 'broken source' }
+    dataset = described_class.new([[1, 2], source])
+    expect { dataset.to_a }.to raise_error(RuntimeError, 'broken source')
+  end
+
+  it 'stops the threads when the consumer stops early' do
+    threads = Thread.list.length
+    dataset = described_class.new([1..Float::INFINITY, 1..Float::INFINITY])
+    expect(dataset.first(3).length).to eq(3)
+    expect(Thread.list.length).to eq(threads)
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::DataLoader do
+  context 'with an IterableDataset' do
+    let(:dataset) { MXNet::Gluon::Data::IterableDataset.from(0...10) }
+
+    it 'batches samples in order' do
+      loader = described_class.new(dataset, batch_size: 4)
+      expect(loader.map(&:to_a)).to eq([[0, 1, 2, 3], [4, 5, 6, 7], [8, 9]])
+    end
+
+    it 'discards the last batch' do
+      loader = described_class.new(dataset, batch_size: 4, last_batch: :discard)
+      expect(loader.to_a.length).to eq(2)
+    end
+
+    it 'shuffles through a buffer' do
+      loader = described_class.new(dataset, batch_size: 5, shuffle: true, shuffle_buffer: 4)
+      expect(loader.flat_map(&:to_a).sort).to eq((0...10).to_a)
+    end
+
+    it 'requires shuffle_buffer to shuffle' do
+      expect { described_class.new(dataset, batch_size: 5, shuffle: true) }.to raise_error(ArgumentError)
+    end
+
+    it 'has no length' do
+      expect { described_class.new(dataset, batch_size: 5).length }.to raise_error(TypeError)
+    end
+  end
+end
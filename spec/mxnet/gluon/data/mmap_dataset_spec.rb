@@ -0,0 +1,79 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::MmapDataset, :within_tmpdir do
+  let(:source) do
+    data = MXNet::NDArray.arange(0, 24).reshape([6, 2, 2])
+    MXNet::Gluon::Data::SimpleDataset.new(6.times.map {|i| [data[i], i * 10] })
+  end
+
+  let(:dataset) do
+    described_class.write('source.raw', source)
+    described_class.new('source.raw')
+  end
+
+  describe '.write' do
+    it 'records the dtype and shape of each field' do
+      expect(dataset.fields.map(&:dtype)).to eq([:float32, :int32])
+      expect(dataset.fields.map(&:shape)).to eq([[2, 2], []])
+    end
+
+    it 'does not leave a temporary file' do
+      dataset
+      expect(Dir.glob('*')).to eq(['source.raw'])
+    end
+
+    it 'rejects an empty dataset' do
+      empty = MXNet::Gluon::Data::SimpleDataset.new([])
+      expect { described_class.write('empty.raw', empty) }.to raise_error(ArgumentError)
+      expect(Dir.glob('*')).to eq([])
+    end
+  end
+
+  describe '#length' do
+    it 'is the length of the source' do
+      expect(dataset.length).to eq(6)
+    end
+  end
+
+  describe '#[]' do
+    specify do
+      data, label = dataset[2]
+      expect(data.reshape([4]).to_a).to eq([8.0, 9.0, 10.0, 11.0])
+      expect(label).to eq(20)
+      expect(dataset[-1][1]).to eq(50)
+    end
+  end
+
+  describe '#get_batch' do
+    it 'gathers records into one NDArray per field' do
+      data, label = dataset.get_batch([5, 0, 3])
+      expect(data.shape).to eq([3, 2, 2])
+      expect(data[1].reshape([4]).to_a).to eq([0.0, 1.0, 2.0, 3.0])
+      expect(label.to_a).to eq([50, 0, 30])
+    end
+
+    it 'reads a run of consecutive records' do
+      _, label = dataset.get_batch([1, 2, 3])
+      expect(label.to_a).to eq([10, 20, 30])
+    end
+
+    it 'counts negative indices from the end' do
+      _, label = dataset.get_batch([-1, 0])
+      expect(label.to_a).to eq([50, 0])
+    end
+
+    it 'raises IndexError for an index out of range' do
+      expect { dataset.get_batch([0, 6]) }.to raise_error(IndexError)
+      expect { dataset.get_batch([-7]) }.to raise_error(IndexError)
+    end
+  end
+
+  context 'with DataLoader' do
+    specify do
+      loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 4)
+      labels = loader.map {|_, label| label.to_a }
+      expect(labels).to eq([[0, 10, 20, 30], [40, 50]])
+    end
+  end
+end
@@ -97,3 +97,76 @@ RSpec.describe MXNet::Gluon::Data::BatchSampler do
     end
   end
 end
+
+RSpec.describe MXNet::Gluon::Data::ShardedRandomSampler do
+  let(:shards) do
+    3.times.map {|i| described_class.new(100, num_shards: 3, shard_id: i, seed: 42) }
+  end
+
+  describe '#length' do
+    it 'splits the samples among shards' do
+      expect(shards.map(&:length)).to eq([34, 33, 33])
+    end
+  end
+
+  describe '#each' do
+    it 'results in disjoint shards covering all samples' do
+      expect(shards.flat_map(&:to_a).sort).to eq((0..99).to_a)
+    end
+
+    it 'is a permutation different from the sequence' do
+      expect(shards[0].to_a).not_to eq((0..99).step(3).to_a)
+    end
+
+    it 'is reproducible for the same seed and epoch' do
+      other = described_class.new(100, num_shards: 3, shard_id: 0, seed: 42)
+      expect(other.to_a).to eq(shards[0].to_a)
+    end
+
+    it 'changes the order every epoch' do
+      sampler = shards[0]
+      first = sampler.to_a
+      expect(sampler.epoch).to eq(1)
+      expect(sampler.to_a).not_to eq(first)
+      sampler.epoch = 0
+      expect(sampler.to_a).to eq(first)
+    end
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::FixedBucketSampler do
+  let(:lengths) do
+    [1, 2, 3, 10, 11, 12, 20, 5, 5, 5]
+  end
+
+  let(:sampler) do
+    described_class.new(lengths, 2, bucket_keys: [5, 12, 20], shuffle: true)
+  end
+
+  describe '#length' do
+    it 'is the number of batches of all buckets' do
+      expect(sampler.length).to eq(6)
+    end
+  end
+
+  describe '#each' do
+    it 'yields batches within a bucket' do
+      batches = sampler.each.to_a
+      expect(batches.flatten.sort).to eq((0..9).to_a)
+      batches.each do |batch|
+        keys = batch.map {|i| sampler.bucket_keys.find {|k| k >= lengths[i] } }
+        expect(keys.uniq.length).to eq(1)
+      end
+    end
+  end
+
+  describe '#stats' do
+    it 'reports padding efficiency' do
+      stats = sampler.stats
+      expect(stats[:bucket_sizes]).to eq([6, 3, 1])
+      expect(stats[:padding_efficiency]).to be_within(1e-9).of(74.0 / 86)
+      expect(stats.to_s).to include('padding efficiency')
+      expect(stats.to_h[:bucket_keys]).to eq(sampler.bucket_keys)
+    end
+  end
+end
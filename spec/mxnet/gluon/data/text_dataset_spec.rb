@@ -0,0 +1,89 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::TextLineDataset, :within_tmpdir do
+  before do
+    File.write('lines.txt', "first line\r\n\nsecond line\nthird line")
+  end
+
+  let(:dataset) { described_class.new('lines.txt') }
+
+  it 'skips blank lines' do
+    expect(dataset.length).to eq(3)
+  end
+
+  it 'returns lines without terminators' do
+    expect(dataset[0]).to eq('first line')
+    expect(dataset[1]).to eq('second line')
+    expect(dataset[-1]).to eq('third line')
+  end
+
+  it 'saves the line index beside the file' do
+    dataset
+    expect(File).to be_file('lines.txt.lineidx')
+  end
+
+  it 'rebuilds the line index when the file changes' do
+    dataset.close
+    File.write('lines.txt', "a\nb\n")
+    File.utime(Time.now + 10, Time.now + 10, 'lines.txt')
+    expect(described_class.new('lines.txt').to_a).to eq(%w[a b])
+  end
+
+  it 'skips the header' do
+    expect(described_class.new('lines.txt', skip_header: true)[0]).to eq('second line')
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::CSVDataset, :within_tmpdir do
+  before do
+    File.write('data.csv', "label,x,y\n1,0.5,2\n0,1.5,\n1,-3,4e1\n")
+  end
+
+  let(:dataset) do
+    described_class.new('data.csv', label_columns: [0], skip_header: true, num_threads: 2)
+  end
+
+  it 'uses the remaining columns as data' do
+    expect(dataset.data_columns).to eq([1, 2])
+  end
+
+  describe '#[]' do
+    it 'returns data and label' do
+      data, label = dataset[2]
+      expect(data.to_a).to eq([-3.0, 40.0])
+      expect(label.to_a).to eq([1.0])
+    end
+
+    it 'reads empty fields as NaN' do
+      expect(dataset[1][0].to_a[1]).to be_nan
+    end
+  end
+
+  describe '#get_batch' do
+    it 'parses the rows at the indices' do
+      data, label = dataset.get_batch([2, 0])
+      expect(data.shape).to eq([2, 2])
+      expect(data.to_narray.to_a).to eq([[-3.0, 40.0], [0.5, 2.0]])
+      expect(label.to_narray.to_a).to eq([[1.0], [1.0]])
+    end
+  end
+
+  it 'raises on an invalid number' do
+    File.write('bad.csv', "1,x\n")
+    expect { described_class.new('bad.csv').get_batch([0]) }.to raise_error(ArgumentError, /invalid number/)
+  end
+
+  it 'raises on an empty field or a value out of range for an integer dtype' do
+    expect { described_class.new('data.csv', dtype: :int32, skip_header: true).get_batch([1]) }
+      .to raise_error(ArgumentError, /empty field/)
+    File.write('large.csv', "1,300\n")
+    expect { described_class.new('large.csv', dtype: :uint8).get_batch([0]) }
+      .to raise_error(ArgumentError, /out of the range of uint8/)
+  end
+
+  it 'works with DataLoader' do
+    loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 2)
+    expect(loader.map {|data, _| data.shape[0] }).to eq([2, 1])
+  end
+end
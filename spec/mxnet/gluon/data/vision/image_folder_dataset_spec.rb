@@ -0,0 +1,60 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::Vision::ImageFolderDataset, :within_tmpdir do
+  before do
+    %w[cat dog].each_with_index do |name, i|
+      Dir.mkdir(name)
+      2.times {|j| PNGWriter.write("#{name}/#{j}.png", 8 + i, 6 + j) }
+    end
+    File.write('cat/README.txt', 'not an image')
+  end
+
+  let(:transform) { nil }
+  let(:dataset) { described_class.new('.', transform: transform) }
+
+  it 'lists images by folder' do
+    expect(dataset.synsets).to eq(%w[cat dog])
+    expect(dataset.length).to eq(4)
+  end
+
+  it 'decodes an image' do
+    img, label = dataset[2]
+    expect(img.shape).to eq([6, 9, 3])
+    expect(img.dtype).to eq(:uint8)
+    expect(label).to eq(1)
+  end
+
+  context 'with a batchable transform' do
+    let(:transform) do
+      MXNet::Gluon::Data::Vision::Transforms::Compose.new(MXNet::Gluon::Data::Vision::Transforms::RandomResizedCrop.new([5, 4]), MXNet::Gluon::Data::Vision::Transforms::ToTensor.new)
+    end
+
+    it 'decodes a batch into NCHW float32' do
+      data, label = dataset.get_batch([0, 3, 1])
+      expect(data.shape).to eq([3, 3, 4, 5])
+      expect(data.dtype).to eq(:float32)
+      expect(data[0, 0, 0, 0].as_scalar).to be_within(1e-6).of(10 / 255.0)
+      expect(label.to_a).to eq([0, 1, 0])
+    end
+
+    it 'matches the per-sample transform' do
+      img, = dataset[0]
+      data, = dataset.get_batch([0])
+      expect(img.shape).to eq([3, 4, 5])
+      # The images are of one color, so any crop gives the same values.
+      expect((img.to_narray - data[0].to_narray).abs.max).to be < 1e-6
+      expect(img[0, 0, 0].as_scalar).to be_within(1e-6).of(10 / 255.0)
+      expect(img[2, 0, 0].as_scalar).to be_within(1e-6).of(30 / 255.0)
+    end
+  end
+
+  context 'with Resize' do
+    let(:transform) { MXNet::Gluon::Data::Vision::Transforms::Resize.new(4) }
+
+    it 'resizes a batch in NHWC' do
+      data, = dataset.get_batch([0, 1])
+      expect(data.shape).to eq([2, 4, 4, 3])
+    end
+  end
+end
@@ -59,4 +59,23 @@ RSpec.describe MXNet::Gluon::Data::Vision::MNIST do
       end
     end
   end
+
+  describe 'decoded cache' do
+    before do
+      dataset
+    end
+
+    it 'is saved under root with a sidecar' do
+      expect(File.file?(dataset.cache_path)).to eq(true)
+      expect(File.file?("#{dataset.cache_path}.json")).to eq(true)
+      expect(MXNet::NDArray.load(dataset.cache_path).keys).to contain_exactly('data', 'label')
+    end
+
+    it 'is loaded without touching the source files' do
+      expect(MXNet::Utils).not_to receive(:download)
+      cached = MXNet::Gluon::Data::Vision::MNIST.new(train: train)
+      expect(cached.length).to eq(60000)
+      expect(cached[0][1]).to eq(5)
+    end
+  end
 end
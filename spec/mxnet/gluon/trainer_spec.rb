@@ -23,4 +23,19 @@ RSpec.describe MXNet::Gluon::Trainer do
       trainer.update(1)
     end
   end
+
+  describe '#step with trim_pool: true' do
+    let(:parameter) do
+      MXNet::Gluon::Parameter.new('p', shape: [1]).tap(&:init)
+    end
+
+    it 'trims the pools only when a new batch size lasts' do
+      trainer = MXNet::Gluon::Trainer.new({p: parameter}, :sgd, kvstore: nil, trim_pool: true)
+      expect(MXNet::Memory).to receive(:release_cached).once
+      # The smaller last batch of each epoch does not trim the pools.
+      [32, 32, 7, 32, 32, 7].each {|size| trainer.step(size) }
+      # A new batch size used twice does.
+      [16, 16, 16].each {|size| trainer.step(size) }
+    end
+  end
 end
@@ -69,4 +69,70 @@ require 'zlib'
     label_1 = train_iter.current_label.to_narray
     expect((label_0 - label_1).sum).to eq(0)
   end
+
+  context 'with prefetch: 2' do
+    subject(:train_iter) do
+      MXNet::IO::MNISTIter.new(
+        image: fixture_dir_path.join('mnist/train-images-idx3-ubyte'),
+        label: fixture_dir_path.join('mnist/train-labels-idx1-ubyte'),
+        data_shape: [784],
+        batch_size: batch_size,
+        shuffle: 1,
+        flat: 1,
+        silent: 0,
+        seed: 10,
+        prefetch: 2
+      )
+    end
+
+    specify 'batch size' do
+      nbatch = 60000 / batch_size
+      batch_count = 0
+      train_iter.each { batch_count += 1 }
+      expect(batch_count).to eq(nbatch)
+    end
+
+    specify 'packed index' do
+      batch = train_iter.next_batch
+      expect(batch.data[0].shape).to eq([batch_size, 784])
+      expect(batch.index).to be_a(String)
+      expect(batch.index.unpack('Q*').length).to eq(batch_size)
+    end
+
+    specify do
+      train_iter.iter_next
+      label_0 = train_iter.current_label.to_narray
+      4.times { train_iter.iter_next }
+      train_iter.reset
+      train_iter.iter_next
+      label_1 = train_iter.current_label.to_narray
+      expect((label_0 - label_1).sum).to eq(0)
+    end
+  end
+
+  context 'with reuse_batch: true' do
+    subject(:train_iter) do
+      MXNet::IO::MNISTIter.new(
+        image: fixture_dir_path.join('mnist/train-images-idx3-ubyte'),
+        label: fixture_dir_path.join('mnist/train-labels-idx1-ubyte'),
+        data_shape: [784],
+        batch_size: batch_size,
+        flat: 1,
+        silent: 0,
+        reuse_batch: true
+      )
+    end
+
+    specify 'yields the same batch object' do
+      batches = train_iter.each.first(3).map(&:object_id)
+      expect(batches.uniq.length).to eq(1)
+    end
+
+    specify 'batch size' do
+      nbatch = 60000 / batch_size
+      batch_count = 0
+      train_iter.each { batch_count += 1 }
+      expect(batch_count).to eq(nbatch)
+    end
+  end
 end
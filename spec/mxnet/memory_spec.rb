@@ -0,0 +1,80 @@
+require 'spec_helper'
+
+RSpec.describe MXNet::Memory do
+  before { described_class.start_tracking }
+  after { described_class.stop_tracking }
+
+  def site_of(line)
+    "#{__FILE__}:#{line}"
+  end
+
+  describe '.census' do
+    it 'groups the live NDArrays by the allocation site' do
+      arrays = Array.new(3) { MXNet::NDArray.zeros([4, 5]) }; line = __LINE__
+      census = described_class.census
+      expect(census[site_of(line)]).to eq(count: 3, bytes: 3 * 4 * 5 * 4)
+      arrays.clear
+    end
+
+    it 'groups the live NDArrays by dtype and context' do
+      x = MXNet::NDArray.zeros([8], dtype: :float64)
+      census = described_class.census(group_by: [:dtype, :context])
+      expect(census[[:float64, MXNet.cpu]][:bytes]).to be >= 64
+      x
+    end
+
+    it 'does not record NDArrays while not tracking' do
+      described_class.stop_tracking
+      x = MXNet::NDArray.zeros([4])
+      expect(described_class.census).to be_empty
+      x
+    end
+
+    it 'rejects an unknown key' do
+      expect { described_class.census(group_by: :foo) }.to raise_error(ArgumentError)
+    end
+  end
+
+  describe '.release_cached' do
+    it 'releases the cached buffers of the CPU pool' do
+      Array.new(10) { MXNet::NDArray.ones([1024, 1024]) }.each(&:wait_to_read)
+      begin
+        expect(described_class.release_cached(MXNet.cpu, gc: true)).to eq(described_class)
+      rescue NotImplementedError
+        skip 'MXStorageEmptyCache is unavailable'
+      end
+    end
+  end
+
+  describe '.stats' do
+    it 'returns the bytes of the live NDArrays while tracking' do
+      x = MXNet::NDArray.zeros([256])
+      stats = described_class.stats(MXNet.cpu)
+      expect(stats[:in_use]).to be >= 1024
+      expect(stats[:used]).to be > 0 if File.exist?('/proc/self/statm')
+      x
+    end
+
+    it 'does not know the bytes in use while not tracking' do
+      described_class.stop_tracking
+      expect(described_class.stats[:in_use]).to be_nil
+    end
+  end
+
+  describe MXNet::Memory::Snapshot do
+    it 'returns the difference of two snapshots' do
+      before = MXNet::Memory.snapshot
+      kept = Array.new(2) { MXNet::NDArray.ones([10]) }; line = __LINE__
+      after = MXNet::Memory.snapshot
+      expect(after.diff(before)).to eq(site_of(line) => {count: 2, bytes: 80})
+      expect(after.total_bytes - before.total_bytes).to eq(80)
+      kept
+    end
+
+    it 'forgets freed NDArrays' do
+      Array.new(100) { MXNet::NDArray.ones([10]) }; line = __LINE__
+      GC.start
+      expect(MXNet::Memory.census.fetch(site_of(line), {count: 0})[:count]).to be < 100
+    end
+  end
+end
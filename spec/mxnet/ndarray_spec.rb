@@ -1,4 +1,5 @@
 require 'spec_helper'
+require 'timeout'
 
 module MXNet
   ::RSpec.describe NDArray do
@@ -1424,6 +1425,153 @@ module MXNet
       end
     end
 
+    describe '#ready?' do
+      def wait_until_ready(array)
+        Timeout.timeout(10) { sleep 0.001 until array.ready? }
+      end
+
+      it 'is true on the first call for a computed array' do
+        x = MXNet::NDArray.ones([4])
+        x.wait_to_read
+        expect(x.ready?).to eq(true)
+      rescue NotImplementedError
+        skip 'MXEnginePushSyncND is unavailable'
+      end
+
+      it 'follows a later write through a view' do
+        x = MXNet::NDArray.zeros([2, 3])
+        x.wait_to_read
+        expect(x.ready?).to eq(true)
+        x[1] = MXNet::NDArray.dot(MXNet::NDArray.ones([3, 3]), MXNet::NDArray.ones([3]))
+        wait_until_ready(x)
+        expect(x.to_a).to eq([[0, 0, 0], [3, 3, 3]])
+      rescue NotImplementedError
+        skip 'MXEnginePushSyncND is unavailable'
+      end
+
+      it 'follows a later write as an output' do
+        x = MXNet::NDArray.ones([4])
+        wait_until_ready(x)
+        MXNet::NDArray.square(x, out: x)
+        wait_until_ready(x)
+        expect(x.to_a).to eq([1, 1, 1, 1])
+      rescue NotImplementedError
+        skip 'MXEnginePushSyncND is unavailable'
+      end
+    end
+
+    describe '#on_ready' do
+      specify do
+        queue = Thread::Queue.new
+        x = MXNet::NDArray.ones([100, 100])
+        y = MXNet::NDArray.dot(x, x)
+        expect(y.on_ready {|a| queue << a }).to equal(y)
+        ready = queue.pop
+        expect(ready).to equal(y)
+        expect(ready.to_narray[0, 0]).to eq(100)
+      end
+
+      it 'calls more callbacks than the pipe of the dispatcher can hold' do
+        queue = Thread::Queue.new
+        x = MXNet::NDArray.ones([1])
+        x.wait_to_read
+        n = 20_000
+        n.times { x.on_ready { queue << true } }
+        Timeout.timeout(60) { n.times { queue.pop } }
+        expect(queue).to be_empty
+      end
+    end
+
+    describe '.wait_all' do
+      specify do
+        x = MXNet::NDArray.ones([10, 10])
+        arrays = Array.new(3) { MXNet::NDArray.dot(x, x) }
+        expect { MXNet::NDArray.wait_all(arrays) }.not_to raise_error
+        expect { MXNet::NDArray.wait_all }.not_to raise_error
+      end
+
+      it 'rejects an object other than NDArray' do
+        expect { MXNet::NDArray.wait_all([1]) }.to raise_error(TypeError)
+      end
+    end
+
+    describe '.batch' do
+      specify do
+        x = MXNet::NDArray.ones([2, 3])
+        out = MXNet::NDArray.zeros([2, 3])
+        y = MXNet::NDArray.batch do |b|
+          z = x * 2 + 1
+          MXNet::NDArray.relu(z, out: out)
+          expect(b.size).to eq(3)
+          z - 1
+        end
+        expect(y.to_narray.to_a).to eq([[2, 2, 2], [2, 2, 2]])
+        expect(out.to_narray.to_a).to eq([[3, 3, 3], [3, 3, 3]])
+        expect(MXNet::NDArray::Batch.current).to be_nil
+      end
+
+      it 'makes the results available after Batch#submit' do
+        MXNet::NDArray.batch do |b|
+          y = MXNet::NDArray.ones([2]) * 3
+          b.submit
+          expect(b.size).to eq(0)
+          expect(y.to_narray.to_a).to eq([3, 3])
+        end
+      end
+
+      it 'joins the outer batch when nested' do
+        MXNet::NDArray.batch do |outer|
+          MXNet::NDArray.batch do |inner|
+            expect(inner).to equal(outer)
+          end
+        end
+      end
+
+      it 'executes the recorded operations when the block raises' do
+        y = nil
+        expect {
+          MXNet::NDArray.batch do
+            y = MXNet::NDArray.ones([2]) + 1
+            raise 'error'
+          end
+        }.to raise_error(RuntimeError, 'error')
+        expect(y.to_narray.to_a).to eq([2, 2])
+      end
+
+      it 'reports the failed operation' do
+        x = MXNet::NDArray.ones([2, 3])
+        expect {
+          MXNet::NDArray.batch { MXNet::NDArray.dot(x, x) }
+        }.to raise_error(MXNet::Error, /operation #0 dot of the batch of 1/)
+      end
+
+      it 'submits the recorded operations when a result is read' do
+        x = MXNet::NDArray.ones([2, 3])
+        out = MXNet::NDArray.zeros([2, 3])
+        MXNet::NDArray.batch do |b|
+          y = x * 2
+          expect(y.shape).to eq([2, 3])
+          expect(b.size).to eq(0)
+          MXNet::NDArray.relu(y, out: out)
+          expect(out.to_narray.to_a).to eq([[2, 2, 2], [2, 2, 2]])
+          expect(b.size).to eq(0)
+        end
+      end
+
+      it 'submits the recorded operations before a cached op' do
+        net = MXNet::Gluon::NN::Dense.new(2, in_units: 3).tap(&:init)
+        net.hybridize
+        x = MXNet::NDArray.ones([2, 3])
+        expected = net.(x * 2).to_narray.to_a
+        y = MXNet::NDArray.batch do |b|
+          z = net.(x * 2)
+          expect(b.size).to eq(0)
+          z
+        end
+        expect(y.to_narray.to_a).to eq(expected)
+      end
+    end
+
     describe '.maximum' do
       specify do
         x = MXNet::NDArray.ones([2,3])
@@ -0,0 +1,101 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+require 'json'
+
+RSpec.describe MXNet::Profiler, :within_tmpdir do
+  before do
+    skip 'the profiler API is unavailable' unless described_class.available?
+  end
+
+  after do
+    described_class.resume if described_class.paused?
+    described_class.set_state(:stop) if described_class.running?
+    described_class.clear_spans
+  end
+
+  describe '.profile' do
+    it 'writes a Chrome trace file with operator events' do
+      x = MXNet::NDArray.ones([10, 10])
+      described_class.profile(filename: 'profile.json') do
+        (x + x).wait_to_read
+      end
+      trace = JSON.parse(File.read('profile.json'))
+      expect(trace['traceEvents']).not_to be_empty
+    end
+
+    it 'merges Ruby-level spans into the trace file' do
+      net = MXNet::Gluon::NN::Dense.new(4, in_units: 3, prefix: 'dense0_')
+      net.init
+      described_class.profile(filename: 'profile.json') do
+        net.(MXNet::NDArray.ones([2, 3])).wait_to_read
+      end
+      trace = JSON.parse(File.read('profile.json'))
+      span = trace['traceEvents'].find {|e| e['cat'] == 'block' }
+      expect(span).to include('name' => 'dense0', 'ph' => 'X', 'pid' => Process.pid)
+      expect(span['dur']).to be >= 0
+    end
+
+    it 'stops the profiler when the block raises' do
+      expect {
+        described_class.profile(filename: 'profile.json') { raise 'error' }
+      }.to raise_error('error')
+      expect(described_class).not_to be_running
+    end
+  end
+
+  describe '.aggregate_stats' do
+    it 'returns the statistics as a Hash' do
+      x = MXNet::NDArray.ones([10, 10])
+      described_class.profile(filename: 'profile.json', aggregate_stats: true) do
+        (x + x).wait_to_read
+      end
+      stats = described_class.aggregate_stats(reset: true)
+      expect(stats).to be_a(Hash)
+      row = stats.values.flat_map(&:values).first
+      expect(row.keys).to eq([:count, :total_ms, :min_ms, :max_ms, :avg_ms])
+    end
+  end
+
+  describe '.span' do
+    it 'does not record while the profiler is stopped' do
+      expect(described_class.span('foo') { 42 }).to eq(42)
+      expect(described_class.trace_events).to be_empty
+    end
+
+    it 'does not record while the profiler is paused' do
+      described_class.set_config(filename: 'profile.json')
+      described_class.start
+      described_class.pause
+      expect(described_class).to be_running
+      expect(described_class).to be_paused
+      described_class.span('foo') { 42 }
+      expect(described_class.trace_events).to be_empty
+      described_class.resume
+      described_class.span('bar') { 42 }
+      expect(described_class.trace_events.map {|e| e['name'] }).to include('bar')
+    end
+  end
+
+  describe '.resume' do
+    it 'does not start the profiler' do
+      described_class.pause
+      described_class.resume
+      expect(described_class).not_to be_running
+      expect(described_class).not_to be_paused
+    end
+  end
+
+  describe MXNet::Profiler::Domain do
+    it 'records tasks, counters and markers' do
+      domain = described_class.new('test')
+      task = domain.new_task('task')
+      counter = domain.new_counter('counter', 1)
+      MXNet::Profiler.profile(filename: 'profile.json') do
+        task.time { counter.increment(2) }
+        domain.new_marker('marker').mark
+      end
+      names = JSON.parse(File.read('profile.json'))['traceEvents'].map {|e| e['name'] }
+      expect(names).to include('task', 'marker')
+    end
+  end
+end
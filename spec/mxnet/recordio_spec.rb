@@ -0,0 +1,133 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::RecordIO, :within_tmpdir do
+  def write_records(records)
+    described_class.open('data.rec', 'w') do |rec|
+      records.each {|r| rec.write(r) }
+    end
+  end
+
+  describe '#read' do
+    it 'reads records in order' do
+      write_records(%w[foo barbaz qux])
+      described_class.open('data.rec', 'r') do |rec|
+        expect(rec.read).to eq('foo')
+        expect(rec.read).to eq('barbaz')
+        expect(rec.read).to eq('qux')
+        expect(rec.read).to be_nil
+      end
+    end
+
+    it 'overwrites the given buffer' do
+      write_records(%w[foo barbaz])
+      described_class.open('data.rec', 'r') do |rec|
+        buf = String.new
+        expect(rec.read(buf)).to equal(buf)
+        expect(buf).to eq('foo')
+        rec.read(buf)
+        expect(buf).to eq('barbaz')
+      end
+    end
+  end
+
+  describe '#reset' do
+    it 'rewinds the reader' do
+      write_records(%w[foo bar])
+      described_class.open('data.rec', 'r') do |rec|
+        rec.read
+        rec.reset
+        expect(rec.read).to eq('foo')
+      end
+    end
+  end
+
+  describe '#close' do
+    it 'closes the file' do
+      write_records(%w[foo])
+      rec = described_class.new('data.rec', 'r')
+      rec.close
+      expect(rec).to be_closed
+      expect { rec.read }.to raise_error(IOError)
+    end
+  end
+
+  describe '.pack and .unpack' do
+    it 'round-trips a scalar label' do
+      header = MXNet::RecordIO::IRHeader.new(0, 3.0, 7, 0)
+      h, s = described_class.unpack(described_class.pack(header, 'payload'))
+      expect(h.to_a).to eq([0, 3.0, 7, 0])
+      expect(s).to eq('payload')
+    end
+
+    it 'round-trips an array label' do
+      header = MXNet::RecordIO::IRHeader.new(0, [1.0, 2.0], 1, 0)
+      h, s = described_class.unpack(described_class.pack(header, 'payload'))
+      expect(h.flag).to eq(2)
+      expect(h.label).to eq([1.0, 2.0])
+      expect(s).to eq('payload')
+    end
+  end
+end
+
+RSpec.describe MXNet::IndexedRecordIO, :within_tmpdir do
+  before do
+    described_class.open('data.idx', 'data.rec', 'w') do |rec|
+      10.times {|i| rec.write_idx(i, "record #{i}") }
+    end
+  end
+
+  it 'reads records by key' do
+    described_class.open('data.idx', 'data.rec', 'r') do |rec|
+      expect(rec.keys).to eq((0...10).to_a)
+      expect(rec.read_idx(7)).to eq('record 7')
+      expect(rec.read_idx(2)).to eq('record 2')
+      expect(rec.read).to eq('record 3')
+    end
+  end
+
+  it 'closes the index file when reopened' do
+    rec = described_class.new('other.idx', 'other.rec', 'w')
+    fidx = rec.instance_variable_get(:@fidx)
+    rec.open
+    expect(fidx).to be_closed
+    rec.close
+  end
+
+  it 'raises KeyError for an unknown key' do
+    described_class.open('data.idx', 'data.rec', 'r') do |rec|
+      expect { rec.read_idx(10) }.to raise_error(KeyError)
+    end
+  end
+
+  describe MXNet::Gluon::Data::RecordFileDataset do
+    it 'reads records by index' do
+      dataset = MXNet::Gluon::Data::RecordFileDataset.new('data.rec')
+      expect(dataset.length).to eq(10)
+      expect(dataset[4]).to eq('record 4')
+    end
+
+    it 'reads from multiple threads' do
+      dataset = MXNet::Gluon::Data::RecordFileDataset.new('data.rec')
+      results = 4.times.map {|t| Thread.new { 10.times.map {|i| dataset[(i + t) % 10] } } }.map(&:value)
+      results.each_with_index do |records, t|
+        expect(records).to eq(10.times.map {|i| "record #{(i + t) % 10}" })
+      end
+    end
+
+    it 'keeps a reader per dataset in each thread' do
+      a = MXNet::Gluon::Data::RecordFileDataset.new('data.rec')
+      b = MXNet::Gluon::Data::RecordFileDataset.new('data.rec')
+      expect([a[1], b[7], a[2], b[8]]).to eq(['record 1', 'record 7', 'record 2', 'record 8'])
+    end
+
+    it 'closes the readers of all threads' do
+      dataset = MXNet::Gluon::Data::RecordFileDataset.new('data.rec')
+      readers = 2.times.map {|i| Thread.new { dataset[i]; dataset.send(:reader) } }.map(&:value)
+      dataset.close
+      expect(dataset).to be_closed
+      expect(readers).to all(be_closed)
+      expect { dataset[0] }.to raise_error(IOError)
+    end
+  end
+end
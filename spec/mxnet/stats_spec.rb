@@ -0,0 +1,93 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+require 'stringio'
+
+RSpec.describe MXNet::Stats do
+  before { described_class.reset }
+  after { described_class.disable.reset }
+
+  describe '.time' do
+    it 'does not record when disabled' do
+      expect(described_class.time(:foo) { 42 }).to eq(42)
+      expect(described_class.snapshot).to be_empty
+    end
+
+    it 'records durations when enabled' do
+      described_class.enable
+      2.times { described_class.time(:foo) { sleep 0.01 } }
+      foo = described_class.snapshot[:foo]
+      expect(foo[:count]).to eq(2)
+      expect(foo[:total]).to be >= 0.02
+      expect(foo[:max]).to be >= 0.01
+    end
+  end
+
+  describe '.gauge' do
+    it 'records samples' do
+      described_class.enable
+      [1, 3, 2].each {|v| described_class.gauge(:queue, v) }
+      expect(described_class.snapshot[:queue]).to eq(count: 3, mean: 2.0, max: 3, last: 2)
+    end
+  end
+
+  describe '.enable with log_interval' do
+    it 'writes reports periodically' do
+      io = StringIO.new
+      described_class.enable(log_interval: 0, io: io)
+      described_class.record(:foo, 0.5)
+      expect(io.string).to include('foo')
+    end
+  end
+
+  context 'with DataLoader' do
+    it 'records batch wait and batchify' do
+      described_class.enable
+      MXNet::Gluon::Data::DataLoader.new((0...10).to_a, batch_size: 5).to_a
+      expect(described_class.snapshot[:batch_wait][:count]).to eq(2)
+      expect(described_class.snapshot[:batchify][:count]).to eq(2)
+    end
+  end
+
+  describe '.ops' do
+    before { described_class.reset_ops }
+    after { described_class.disable_ops.reset_ops }
+
+    it 'does not record when disabled' do
+      MXNet::NDArray.ones([2, 2]) + 1
+      expect(described_class.ops).to be_empty
+    end
+
+    it 'records imperative operator dispatches' do
+      described_class.enable_ops
+      x = MXNet::NDArray.ones([4, 4])
+      3.times { MXNet::NDArray.square(x) }
+      square = described_class.ops['square']
+      expect(square[:calls]).to eq(3)
+      expect(square[:input_bytes]).to eq(3 * 4 * 4 * 4)
+      expect(square[:histogram].sum).to eq(3)
+      expect(square[:max_ns]).to be <= square[:total_ns]
+      expect(square[:p50_ns]).to be <= square[:p99_ns]
+    end
+
+    it 'does not record failed dispatches' do
+      described_class.enable_ops
+      x = MXNet::NDArray.ones([2, 3])
+      expect { MXNet::NDArray.dot(x, x) }.to raise_error(MXNet::Error)
+      expect(described_class.ops).not_to have_key('dot')
+    end
+
+    it 'records CachedOp invocations' do
+      described_class.enable_ops
+      op = MXNet::CachedOp.new(MXNet::Symbol.var('x') * 2)
+      op.(MXNet::NDArray.ones([2]))
+      expect(described_class.ops['CachedOp'][:calls]).to eq(1)
+    end
+
+    it 'clears the values with reset: true' do
+      described_class.enable_ops
+      MXNet::NDArray.square(MXNet::NDArray.ones([2]))
+      expect(described_class.ops(reset: true)).not_to be_empty
+      expect(described_class.ops).to be_empty
+    end
+  end
+end
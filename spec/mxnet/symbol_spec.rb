@@ -183,6 +183,41 @@ module MXNet
       end
     end
 
+    describe '#get_internals' do
+      specify do
+        x = MXNet::Symbol.var(:x)
+        y = MXNet::Symbol.var(:y)
+        z = x + y
+        outputs = z.get_internals.list_outputs
+        expect(outputs[0, 2]).to eq([:x, :y])
+        expect(outputs[2]).to eq(z.list_outputs[0])
+      end
+    end
+
+    describe '#cost_report' do
+      let(:data) { MXNet::Symbol.var(:data) }
+      let(:fc) { MXNet::Symbol.FullyConnected(data: data, num_hidden: 10, name: 'fc') }
+      let(:net) { MXNet::Symbol.Activation(data: fc, act_type: 'relu', name: 'act') }
+
+      it 'counts the cost of each node' do
+        report = net.cost_report(data: [2, 4])
+        expect(report.nodes.map(&:name)).to eq(%w[fc act])
+        fc_node, act_node = report.nodes
+        expect(fc_node.macs).to eq(2 * 4 * 10)
+        expect(fc_node.flops).to eq(2 * 80 + 20)
+        expect(fc_node.param_bytes).to eq((10 * 4 + 10) * 4)
+        expect(fc_node.activation_bytes).to eq(2 * 10 * 4)
+        expect(act_node.flops).to eq(20)
+        expect(report.totals).to include(flops: 200, macs: 80, param_bytes: 200, activation_bytes: 160)
+        expect(report.peak_activation_bytes).to eq(160)
+      end
+
+      it 'lists the operators not counted' do
+        report = MXNet::Symbol.topk(data: data, k: 2).cost_report(data: [2, 4])
+        expect(report.uncounted_ops).to eq(['topk'])
+      end
+    end
+
     describe '#infer_shape' do
       specify do
         x = MXNet::Symbol.var(:x)
@@ -2,6 +2,7 @@ require "bundler/setup"
 require "mxnet"
 
 require_relative 'support/tmpdir'
+require_relative 'support/png_writer'
 
 RSpec.configure do |config|
   # Enable flags like --only-failures and --next-failure
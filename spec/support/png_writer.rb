@@ -0,0 +1,22 @@
+require 'zlib'
+
+# Writes small PNG images for the specs and the benchmarks, without an
+# image library.
+module PNGWriter
+  # Writes an 8-bit RGB PNG of the given size.  The block gives the
+  # <tt>[r, g, b]</tt> of the pixel at (+x+, +y+), which is
+  # <tt>[10, 20, 30]</tt> without a block.
+  def self.write(path, width, height)
+    chunk = lambda do |type, data|
+      [data.bytesize].pack('N') + type + data + [Zlib.crc32(type + data)].pack('N')
+    end
+    rows = Array.new(height) do |y|
+      pixels = Array.new(width) {|x| block_given? ? yield(x, y) : [10, 20, 30] }
+      "\0".b + pixels.flatten.pack('C*')
+    end
+    File.binwrite(path, "\x89PNG\r\n\x1a\n".b +
+                        chunk.('IHDR', [width, height, 8, 2, 0, 0, 0].pack('NNCCCCC')) +
+                        chunk.('IDAT', Zlib::Deflate.deflate(rows.join)) +
+                        chunk.('IEND', ''))
+  end
+end